@@ -0,0 +1,86 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/BitVector.h>
+#include <mlir/IR/Threading.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/Dataflow/FlowGraph.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <type_traits>
+#include <vector>
+
+namespace vast::dataflow {
+
+    enum class direction { forward, backward };
+
+    // Facts of converging paths hold if they hold on `any` of them (may
+    // problems) or on `all` of them (must problems).
+    enum class confluence { any, all };
+
+    //
+    // Gen/kill problem over a dense lattice of `width` bits, e.g. one bit per
+    // variable slot. The transfer function of a node is `(in - kill) | gen`.
+    //
+    struct bitvector_problem
+    {
+        bitvector_problem(const flow_graph &graph, unsigned width, direction dir, confluence meet);
+
+        const flow_graph &graph;
+        direction dir;
+        confluence meet;
+
+        // Facts at the entry of a forward or at the exit of a backward problem.
+        llvm::BitVector boundary;
+        // Facts the other nodes start from, the identity of the confluence
+        // by default.
+        llvm::BitVector initial;
+
+        std::vector< llvm::BitVector > gen;
+        std::vector< llvm::BitVector > kill;
+    };
+
+    struct bitvector_solution
+    {
+        // Facts before and after each node in the direction of the problem.
+        std::vector< llvm::BitVector > in;
+        std::vector< llvm::BitVector > out;
+    };
+
+    //
+    // Iterates a worklist prioritized by the graph order until a fixpoint is
+    // reached. Only nodes whose neighbours changed are revisited. Nodes not
+    // set in `live` are neither evaluated nor do they contribute to their
+    // neighbours.
+    //
+    bitvector_solution solve(
+        const bitvector_problem &problem, const llvm::BitVector *live = nullptr
+    );
+
+    // Functions with a body nested in `root`.
+    std::vector< core::function_op_interface > functions_with_body(operation root);
+
+    //
+    // Runs `analysis` on every function with a body in parallel, unless
+    // multithreading is disabled in the context. Results are in the order
+    // of the functions in `root`.
+    //
+    template< typename analysis_t >
+    auto for_each_function(operation root, analysis_t &&analysis) {
+        using result_t = std::invoke_result_t< analysis_t &, core::function_op_interface >;
+
+        auto fns = functions_with_body(root);
+        std::vector< result_t > results(fns.size());
+        mlir::parallelFor(root->getContext(), 0, fns.size(), [&] (std::size_t idx) {
+            results[idx] = analysis(fns[idx]);
+        });
+        return results;
+    }
+
+} // namespace vast::dataflow
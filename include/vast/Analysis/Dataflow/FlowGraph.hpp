@@ -0,0 +1,71 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/Interfaces/FunctionInterface.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::dataflow {
+
+    using node_id = unsigned;
+
+    //
+    // Straight-line sequence of operations. Operations that steer control
+    // flow (`hl.if`, `hl.while`, `core.scope`, ...) precede the operations
+    // nested in their regions, variable declarations follow their
+    // initializers.
+    //
+    struct flow_node
+    {
+        llvm::SmallVector< operation, 8 > ops;
+        llvm::SmallVector< node_id, 2 > succs;
+        llvm::SmallVector< node_id, 2 > preds;
+    };
+
+    //
+    // Intraprocedural control flow graph of a function body. Understands
+    // structured high-level control flow as well as low-level scopes and
+    // branches produced by `HLToLLCF`. Edges guarded by constant conditions
+    // are omitted.
+    //
+    struct flow_graph
+    {
+        static constexpr node_id entry = 0;
+        static constexpr node_id exit  = 1;
+
+        explicit flow_graph(core::function_op_interface fn);
+
+        std::size_t size() const { return nodes.size(); }
+
+        const flow_node &node(node_id id) const { return nodes[id]; }
+        llvm::ArrayRef< flow_node > all() const { return nodes; }
+
+        // Nodes reachable from the entry in reverse post-order followed by
+        // the remaining nodes.
+        llvm::ArrayRef< node_id > order() const { return rpo; }
+
+        // Position of the node in `order`.
+        unsigned position(node_id id) const { return positions[id]; }
+
+        operation function() const { return fn; }
+
+      private:
+        void compute_order();
+
+        operation fn;
+        std::vector< flow_node > nodes;
+        std::vector< node_id > rpo;
+        std::vector< unsigned > positions;
+    };
+
+} // namespace vast::dataflow
@@ -0,0 +1,33 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/BitVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/Dataflow/FlowGraph.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::dataflow {
+
+    // Nodes reachable from the entry of the graph.
+    llvm::BitVector reachable_nodes(const flow_graph &graph);
+
+    //
+    // Code that can never be executed. Reports the outermost unreachable
+    // operation of each straight-line sequence, so that a dead statement is
+    // reported once instead of for each of its nested operations.
+    //
+    std::vector< operation > unreachable_code(const flow_graph &graph, const llvm::BitVector &reachable);
+    std::vector< operation > unreachable_code(const flow_graph &graph);
+
+    // Unreachable code of all functions in `root`, analyzed in parallel.
+    std::vector< operation > unreachable_code(operation root);
+
+} // namespace vast::dataflow
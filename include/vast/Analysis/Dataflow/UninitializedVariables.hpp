@@ -0,0 +1,40 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Analysis/Dataflow/FlowGraph.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::dataflow {
+
+    struct uninitialized_use
+    {
+        // Operation reading the value of the variable.
+        operation use;
+        hl::VarDeclOp var;
+        // The variable is uninitialized on every path to the use, not only
+        // on some of them.
+        bool on_all_paths;
+    };
+
+    //
+    // Reads of local variables with automatic storage before a value is
+    // assigned to them. Each variable is reported at its first such read
+    // in reachable code. Variables whose address escapes, or that are
+    // accessed through members or subscripts, count as initialized at that
+    // point.
+    //
+    // Solves a may and a must problem over one bit per variable slot, set
+    // while the variable is uninitialized.
+    //
+    std::vector< uninitialized_use > uninitialized_uses(const flow_graph &graph);
+
+    // Uninitialized uses in all functions in `root`, analyzed in parallel.
+    std::vector< uninitialized_use > uninitialized_uses(operation root);
+
+} // namespace vast::dataflow
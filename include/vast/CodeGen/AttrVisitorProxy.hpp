@@ -6,17 +6,26 @@
 
 namespace vast::cg {
 
+    using excluded_decl_attr_list = util::type_list<
+          clang::WeakAttr
+        , clang::SelectAnyAttr
+        , clang::CUDAGlobalAttr
+    >;
+
+    // Attaches attributes of `decl` visited by `head` to `op`.
+    operation visit_decl_attrs(
+        visitor_view head, operation op, const clang_decl *decl, scope_context &scope
+    );
+
     struct attr_visitor_proxy : fallthrough_list_node {
 
         explicit attr_visitor_proxy(visitor_base &head) : head(head) {}
 
-        using excluded_attr_list = util::type_list<
-              clang::WeakAttr
-            , clang::SelectAnyAttr
-            , clang::CUDAGlobalAttr
-        >;
+        using excluded_attr_list = excluded_decl_attr_list;
 
-        operation visit_decl_attrs(operation op, const clang_decl *decl, scope_context &scope);
+        operation visit_decl_attrs(operation op, const clang_decl *decl, scope_context &scope) {
+            return ::vast::cg::visit_decl_attrs(head, op, decl, scope);
+        }
 
         operation visit(const clang_decl *decl, scope_context &scope) override;
 
@@ -24,4 +33,30 @@ namespace vast::cg {
         visitor_view head;
     };
 
+    //
+    // Counterpart of `attr_visitor_proxy` for statically composed visitor
+    // stacks (see CodeGenVisitorStack.hpp).
+    //
+    template< typename next_t >
+    struct attr_visitor_layer : next_t {
+
+        template< typename... args_t >
+        explicit attr_visitor_layer(visitor_base &head, args_t &&...args)
+            : next_t(head, std::forward< args_t >(args)...), head(head)
+        {}
+
+        using next_t::visit;
+
+        operation visit(const clang_decl *decl, scope_context &scope) {
+            if (auto op = next_t::visit(decl, scope)) {
+                return visit_decl_attrs(head, op, decl, scope);
+            }
+
+            return {};
+        }
+
+      protected:
+        visitor_view head;
+    };
+
 } // namespace vast::cg
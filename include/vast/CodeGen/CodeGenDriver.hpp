@@ -15,6 +15,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
 #include "vast/CodeGen/CodeGenModule.hpp"
+#include "vast/CodeGen/LazyDeclVisitor.hpp"
 #include "vast/CodeGen/ScopeContext.hpp"
 
 #include "vast/Frontend/Options.hpp"
@@ -67,6 +68,12 @@ namespace vast::cg {
 
         bool enable_verifier(bool set = true) { return (enabled_verifier = set); }
 
+        // Postpones top-level declarations until they are referenced, the
+        // visitors are expected to record references into `decls`.
+        void enable_lazy_emission(std::shared_ptr< lazy_decls > decls) {
+            lazy = std::move(decls);
+        }
+
         virtual void emit(clang::DeclGroupRef decls);
         virtual void emit(clang::Decl *decl);
 
@@ -82,6 +89,14 @@ namespace vast::cg {
         virtual bool verify();
 
       private:
+        // Emits `decl` preceded by the postponed declarations it requires.
+        void emit_with_required(clang::Decl *decl);
+
+        // Emits postponed declarations that were referenced meanwhile in
+        // front of their users, or of `before` if they were required by the
+        // declaration being emitted. Returns false if there were none.
+        bool emit_required(operation before);
+
         //
         // driver options
         //
@@ -100,6 +115,7 @@ namespace vast::cg {
         //
         std::unique_ptr< codegen_builder > bld;
         std::shared_ptr< visitor_base > visitor;
+        std::shared_ptr< lazy_decls > lazy;
 
         //
         // module generation state
@@ -0,0 +1,264 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/CodeGen/CodeGenVisitorBase.hpp"
+
+#include <optional>
+
+namespace vast::cg {
+
+    //
+    // Statically composed alternative to `visitor_list`. A stack is a chain of
+    // layers, each derived from the layer below it, so passing a request down
+    // the stack is a direct call instead of a virtual call through a shared
+    // node pointer:
+    //
+    //   visitor_stack< attr_visitor_layer< type_caching_layer<
+    //      try_or_through_layer< default_visitor,
+    //      bottom_layer< unreach_visitor > > > > >
+    //
+    // Every layer is constructed from the head of the stack followed by
+    // arguments of the layers below. Layers wrapping a visitor consume a
+    // factory `visitor_base &head -> visitor`.
+    //
+    // The dynamic `visitor_list` remains the extension point for visitors
+    // composed at runtime (e.g., by plugins).
+    //
+
+    //
+    // The last layer of a stack, answers all requests by its visitor.
+    //
+    template< typename visitor >
+    struct bottom_layer
+    {
+        template< typename make_t >
+        bottom_layer(visitor_base &head, make_t &&make) : layer(make(head)) {}
+
+        operation visit(const clang_decl *decl, scope_context &scope) { return layer.visitor::visit(decl, scope); }
+        operation visit(const clang_stmt *stmt, scope_context &scope) { return layer.visitor::visit(stmt, scope); }
+        mlir_type visit(const clang_type *type, scope_context &scope) { return layer.visitor::visit(type, scope); }
+        mlir_type visit(clang_qual_type type, scope_context &scope)   { return layer.visitor::visit(type, scope); }
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope) {
+            return layer.visitor::visit(attr, scope);
+        }
+
+        operation visit_prototype(const clang_function *decl, scope_context &scope) {
+            return layer.visitor::visit_prototype(decl, scope);
+        }
+
+        std::optional< loc_t > location(const clang_decl *decl) { return layer.visitor::location(decl); }
+        std::optional< loc_t > location(const clang_stmt *stmt) { return layer.visitor::location(stmt); }
+        std::optional< loc_t > location(const clang_expr *expr) { return layer.visitor::location(expr); }
+
+        std::optional< symbol_name > symbol(clang_global decl) { return layer.visitor::symbol(decl); }
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *decl) { return layer.visitor::symbol(decl); }
+
+      protected:
+        visitor layer;
+    };
+
+    //
+    // Tries its visitor first and passes the request down the stack if the
+    // visitor does not produce a result. Static counterpart of
+    // `try_or_through_list_node`.
+    //
+    template< typename visitor, typename next_t >
+    struct try_or_through_layer : next_t
+    {
+        template< typename make_t, typename... args_t >
+        try_or_through_layer(visitor_base &head, make_t &&make, args_t &&...args)
+            : next_t(head, std::forward< args_t >(args)...), layer(make(head))
+        {}
+
+        operation visit(const clang_decl *decl, scope_context &scope) {
+            if (auto result = layer.visitor::visit(decl, scope)) {
+                return result;
+            }
+            return next_t::visit(decl, scope);
+        }
+
+        operation visit(const clang_stmt *stmt, scope_context &scope) {
+            if (auto result = layer.visitor::visit(stmt, scope)) {
+                return result;
+            }
+            return next_t::visit(stmt, scope);
+        }
+
+        mlir_type visit(const clang_type *type, scope_context &scope) {
+            if (auto result = layer.visitor::visit(type, scope)) {
+                return result;
+            }
+            return next_t::visit(type, scope);
+        }
+
+        mlir_type visit(clang_qual_type type, scope_context &scope) {
+            if (auto result = layer.visitor::visit(type, scope)) {
+                return result;
+            }
+            return next_t::visit(type, scope);
+        }
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope) {
+            if (auto result = layer.visitor::visit(attr, scope)) {
+                return result;
+            }
+            return next_t::visit(attr, scope);
+        }
+
+        operation visit_prototype(const clang_function *decl, scope_context &scope) {
+            if (auto result = layer.visitor::visit_prototype(decl, scope)) {
+                return result;
+            }
+            return next_t::visit_prototype(decl, scope);
+        }
+
+        std::optional< loc_t > location(const clang_decl *decl) {
+            if (auto result = layer.visitor::location(decl)) {
+                return result;
+            }
+            return next_t::location(decl);
+        }
+
+        std::optional< loc_t > location(const clang_stmt *stmt) {
+            if (auto result = layer.visitor::location(stmt)) {
+                return result;
+            }
+            return next_t::location(stmt);
+        }
+
+        std::optional< loc_t > location(const clang_expr *expr) {
+            if (auto result = layer.visitor::location(expr)) {
+                return result;
+            }
+            return next_t::location(expr);
+        }
+
+        std::optional< symbol_name > symbol(clang_global decl) {
+            if (auto result = layer.visitor::symbol(decl)) {
+                return result;
+            }
+            return next_t::symbol(decl);
+        }
+
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *decl) {
+            if (auto result = layer.visitor::symbol(decl)) {
+                return result;
+            }
+            return next_t::symbol(decl);
+        }
+
+      protected:
+        visitor layer;
+    };
+
+    //
+    // Layer that can be disabled when the stack is constructed, then it passes
+    // all requests down the stack. Consumes an optional factory.
+    //
+    template< typename visitor, typename next_t >
+    struct optional_layer : next_t
+    {
+        template< typename make_t, typename... args_t >
+        optional_layer(visitor_base &head, std::optional< make_t > make, args_t &&...args)
+            : next_t(head, std::forward< args_t >(args)...)
+        {
+            if (make) {
+                layer.emplace((*make)(head));
+            }
+        }
+
+        template< typename... args_t >
+        auto try_visit_or_pass(args_t &&...args) {
+            if (layer) {
+                if (auto result = layer->visitor::visit(args...)) {
+                    return result;
+                }
+            }
+            return next_t::visit(std::forward< args_t >(args)...);
+        }
+
+        operation visit(const clang_decl *decl, scope_context &scope) { return try_visit_or_pass(decl, scope); }
+        operation visit(const clang_stmt *stmt, scope_context &scope) { return try_visit_or_pass(stmt, scope); }
+        mlir_type visit(const clang_type *type, scope_context &scope) { return try_visit_or_pass(type, scope); }
+        mlir_type visit(clang_qual_type type, scope_context &scope)   { return try_visit_or_pass(type, scope); }
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope) {
+            return try_visit_or_pass(attr, scope);
+        }
+
+        operation visit_prototype(const clang_function *decl, scope_context &scope) {
+            if (layer) {
+                if (auto result = layer->visitor::visit_prototype(decl, scope)) {
+                    return result;
+                }
+            }
+            return next_t::visit_prototype(decl, scope);
+        }
+
+        template< typename... args_t >
+        auto try_location_or_pass(args_t &&...args) {
+            if (layer) {
+                if (auto result = layer->visitor::location(args...)) {
+                    return result;
+                }
+            }
+            return next_t::location(std::forward< args_t >(args)...);
+        }
+
+        std::optional< loc_t > location(const clang_decl *decl) { return try_location_or_pass(decl); }
+        std::optional< loc_t > location(const clang_stmt *stmt) { return try_location_or_pass(stmt); }
+        std::optional< loc_t > location(const clang_expr *expr) { return try_location_or_pass(expr); }
+
+        template< typename... args_t >
+        auto try_symbol_or_pass(args_t &&...args) {
+            if (layer) {
+                if (auto result = layer->visitor::symbol(args...)) {
+                    return result;
+                }
+            }
+            return next_t::symbol(std::forward< args_t >(args)...);
+        }
+
+        std::optional< symbol_name > symbol(clang_global decl) { return try_symbol_or_pass(decl); }
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *decl) { return try_symbol_or_pass(decl); }
+
+      protected:
+        std::optional< visitor > layer;
+    };
+
+    //
+    // Exposes a composed stack as a single visitor, it is the head the layers
+    // are constructed with.
+    //
+    template< typename stack_t >
+    struct visitor_stack final : visitor_base, stack_t
+    {
+        template< typename... args_t >
+        explicit visitor_stack(args_t &&...args)
+            : visitor_base(), stack_t(static_cast< visitor_base & >(*this), std::forward< args_t >(args)...)
+        {}
+
+        operation visit(const clang_decl *decl, scope_context &scope) final { return stack_t::visit(decl, scope); }
+        operation visit(const clang_stmt *stmt, scope_context &scope) final { return stack_t::visit(stmt, scope); }
+        mlir_type visit(const clang_type *type, scope_context &scope) final { return stack_t::visit(type, scope); }
+        mlir_type visit(clang_qual_type type, scope_context &scope)   final { return stack_t::visit(type, scope); }
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope) final {
+            return stack_t::visit(attr, scope);
+        }
+
+        operation visit_prototype(const clang_function *decl, scope_context &scope) final {
+            return stack_t::visit_prototype(decl, scope);
+        }
+
+        std::optional< loc_t > location(const clang_decl *decl) final { return stack_t::location(decl); }
+        std::optional< loc_t > location(const clang_stmt *stmt) final { return stack_t::location(stmt); }
+        std::optional< loc_t > location(const clang_expr *expr) final { return stack_t::location(expr); }
+
+        std::optional< symbol_name > symbol(clang_global decl) final { return stack_t::symbol(decl); }
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *decl) final { return stack_t::symbol(decl); }
+    };
+
+} // namespace vast::cg
@@ -8,6 +8,8 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/TypeLoc.h>
 #include <clang/Basic/FileEntry.h>
+#include <clang/Basic/SourceLocation.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/Common.hpp"
@@ -34,21 +36,34 @@ namespace vast::cg
 
       private:
 
-        loc_t location(const clang::FullSourceLoc &loc) const {
-            auto file = loc.getFileEntryRef() ? loc.getFileEntryRef()->getName() : "unknown";
-            auto line = loc.getLineNumber();
-            auto col  = loc.getColumnNumber();
-            return { mlir::FileLineColLoc::get(mctx, file, line, col) };
-        }
+        loc_t location(clang::SourceLocation loc) const;
 
-        loc_t location(const clang::SourceLocation &loc) const {
-            if (loc.isValid())
-                return location(clang::FullSourceLoc(loc, actx->getSourceManager()));
-            return mlir::UnknownLoc::get(mctx);
-        }
+        file_loc_t file_location(clang::FileID fid, unsigned offset) const;
+
+        mlir::StringAttr file_name(clang::FileID fid) const;
 
         acontext_t *actx;
         mcontext_t *mctx;
+
+        // Locations are requested repeatedly for the same source locations,
+        // e.g., by all expressions expanded from a single macro.
+        mutable llvm::DenseMap< clang::SourceLocation, mlir::LocationAttr > locations;
+
+        mutable llvm::DenseMap< clang::FileID, mlir::StringAttr > file_names;
+
+        // The last resolved line, consecutive locations mostly fall into it
+        // and their columns are computed from the line start offset.
+        struct line_range
+        {
+            clang::FileID fid;
+            // File offsets of the line start and of its end of line character.
+            unsigned begin = 0;
+            unsigned end   = 0;
+            unsigned line  = 0;
+            mlir::StringAttr file;
+        };
+
+        mutable line_range last_line;
     };
 
 } // namespace vast::cg
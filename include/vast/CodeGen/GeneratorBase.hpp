@@ -15,8 +15,9 @@ namespace vast::cg {
 
         scope_context &scope() { return visitor.scope; }
 
-        void defer(scope_context::deferred_task &&task) {
-            visitor.scope.defer(std::move(task));
+        template< typename task_t >
+        void defer(task_t &&task) {
+            visitor.scope.defer(std::forward< task_t >(task));
         }
 
         codegen_builder &bld;
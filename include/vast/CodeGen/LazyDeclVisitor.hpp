@@ -0,0 +1,135 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Expr.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenBuilder.hpp"
+#include "vast/CodeGen/CodeGenVisitorBase.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace vast::cg
+{
+    //
+    // Top-level declarations postponed until they are referenced, similarly
+    // to deferred declarations of clang codegen. Definitions that have to be
+    // emitted (e.g., externally visible functions and variables) are emitted
+    // right away, other declarations (prototypes, types, inline or static
+    // definitions) are emitted only if an emitted declaration refers to them.
+    //
+    // Required declarations remember the top-level operation that referenced
+    // them first, so that they can be emitted in front of it.
+    //
+    struct lazy_decls
+    {
+        struct required_decl
+        {
+            clang_decl *decl;
+            // Top-level operation referencing the declaration, if the
+            // reference does not come from the declaration being emitted.
+            operation user;
+        };
+
+        // Records `decl` if its emission can be postponed, returns false if
+        // it is to be emitted right away.
+        bool postpone(clang_decl *decl);
+
+        // Requests emission of all redeclarations of `decl`.
+        void require(const clang_decl *decl, operation user = nullptr);
+
+        // Requests emission of the declaration referenced by an expression.
+        void require_referenced(const clang_named_decl *decl, operation user);
+
+        // Requests emission of the declaration naming `type`.
+        void require_named(const clang_type *type, operation user);
+
+        // Takes postponed declarations that were required since the last
+        // call, in the order they were encountered.
+        std::vector< required_decl > take_required();
+
+      private:
+        static bool must_emit(const clang_decl *decl);
+
+        // Postponed redeclarations keyed by their canonical declaration.
+        llvm::DenseMap< const clang_decl *, std::vector< clang_decl * > > postponed;
+
+        // Canonical declarations, whose redeclarations are emitted eagerly.
+        llvm::DenseSet< const clang_decl * > required;
+
+        std::vector< required_decl > ready;
+    };
+
+    //
+    // Records references to top-level declarations into `lazy_decls`. Never
+    // produces any result, hence it is meant to be followed by visitors that
+    // do the actual work.
+    //
+    struct lazy_decl_visitor : visitor_base
+    {
+        lazy_decl_visitor(std::shared_ptr< lazy_decls > decls, codegen_builder &bld)
+            : decls(std::move(decls)), bld(bld)
+        {}
+
+        operation visit(const clang_decl *, scope_context &) override { return {}; }
+
+        operation visit(const clang_stmt *stmt, scope_context &) override {
+            if (auto ref = clang::dyn_cast< clang::DeclRefExpr >(stmt)) {
+                decls->require_referenced(ref->getDecl(), user());
+            }
+
+            return {};
+        }
+
+        mlir_type visit(const clang_type *type, scope_context &) override {
+            decls->require_named(type, user());
+            return {};
+        }
+
+        mlir_type visit(clang_qual_type type, scope_context &) override {
+            if (!type.isNull()) {
+                decls->require_named(type.getTypePtr(), user());
+            }
+
+            return {};
+        }
+
+        std::optional< named_attr > visit(const clang_attr *, scope_context &) override {
+            return std::nullopt;
+        }
+
+        operation visit_prototype(const clang_function *, scope_context &) override { return {}; }
+
+        std::optional< loc_t > location(const clang_decl *) override { return std::nullopt; }
+        std::optional< loc_t > location(const clang_stmt *) override { return std::nullopt; }
+        std::optional< loc_t > location(const clang_expr *) override { return std::nullopt; }
+
+        std::optional< symbol_name > symbol(clang_global) override { return std::nullopt; }
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *) override { return std::nullopt; }
+
+      private:
+        // Top-level operation the builder emits into, none when a new
+        // top-level operation is being built.
+        operation user() const {
+            auto block = bld.getInsertionBlock();
+            for (auto op = block ? block->getParentOp() : nullptr; op; op = op->getParentOp()) {
+                if (op->getParentOp() == bld.module.getOperation()) {
+                    return op;
+                }
+            }
+
+            return nullptr;
+        }
+
+        std::shared_ptr< lazy_decls > decls;
+        codegen_builder &bld;
+    };
+
+} // namespace vast::cg
@@ -6,6 +6,7 @@
 
 VAST_RELAX_WARNINGS
 #include <llvm/ADT/ScopedHashTable.h>
+#include <llvm/Support/Allocator.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/DefaultSymbolGenerator.hpp"
@@ -14,7 +15,10 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
 
 #include <functional>
+#include <new>
 #include <queue>
+#include <type_traits>
+#include <utility>
 
 namespace vast::cg
 {
@@ -120,28 +124,110 @@ namespace vast::cg
     template< typename From, typename To >
     using symbol_table_scope = llvm::ScopedHashTableScope< From, To >;
 
-    struct scope_context : symbols_view {
-        using deferred_task = std::function< void() >;
+    //
+    // Scopes of a function, including their symbol table scopes, and their
+    // deferred tasks are allocated from an arena owned by the function scope.
+    // The arena is released at once when the function scope is destroyed.
+    //
+    // Small slabs, since declarations without a body only open a prototype
+    // scope and their function scopes live until the module is finished.
+    using scope_arena = llvm::BumpPtrAllocatorImpl< llvm::MallocAllocator, 1024, 1024, 8 >;
+
+    struct scope_arena_owner {
+        scope_arena arena_storage;
+    };
+
+    //
+    // FIFO of type-erased tasks allocated in a scope arena. Only destructors
+    // of the tasks are run, their memory is reclaimed with the arena.
+    //
+    struct deferred_tasks {
+        struct task_base {
+            virtual ~task_base() = default;
+            virtual void run() = 0;
+
+            task_base *next = nullptr;
+        };
+
+        template< typename task_t >
+        struct task_node final : task_base {
+            explicit task_node(auto &&task) : task(std::forward< decltype(task) >(task)) {}
+
+            void run() override { task(); }
+
+            task_t task;
+        };
+
+        deferred_tasks() = default;
+
+        deferred_tasks(const deferred_tasks &) = delete;
+        deferred_tasks &operator=(const deferred_tasks &) = delete;
+
+        ~deferred_tasks() {
+            while (head) {
+                std::exchange(head, head->next)->~task_base();
+            }
+        }
+
+        template< typename task_t >
+        void push(scope_arena &arena, task_t &&task) {
+            using node_t = task_node< std::decay_t< task_t > >;
+            auto node = new (arena.Allocate< node_t >()) node_t(std::forward< task_t >(task));
+
+            if (tail) {
+                tail->next = node;
+            } else {
+                head = node;
+            }
+
+            tail = node;
+        }
+
+        bool empty() const { return head == nullptr; }
 
+        // Runs the first task, tasks deferred by the task are appended.
+        void run_front() {
+            auto node = std::exchange(head, head->next);
+            if (!head) {
+                tail = nullptr;
+            }
+
+            node->run();
+            node->~task_base();
+        }
+
+      private:
+        task_base *head = nullptr;
+        task_base *tail = nullptr;
+    };
+
+    struct scope_context : symbols_view {
         explicit scope_context(scope_context *parent)
-            : symbols_view(parent->symbols), parent(parent)
+            : symbols_view(parent->symbols), parent(parent), arena(parent->arena)
         {}
 
-        explicit scope_context(symbol_tables &symbols)
-            : symbols_view(symbols)
+        explicit scope_context(symbol_tables &symbols, scope_arena &arena)
+            : symbols_view(symbols), arena(&arena)
         {}
 
         virtual ~scope_context() { finalize(); }
 
         void finalize() {
             while (!deferred.empty()) {
-                deferred.front()();
-                deferred.pop_front();
+                deferred.run_front();
             }
 
-            while (!children.empty()) {
-                children.back()->finalize();
-                children.pop_back();
+            while (last_child) {
+                auto child = last_child;
+                child->finalize();
+
+                // Scopes opened by the child's tasks are finished first.
+                if (child != last_child) {
+                    continue;
+                }
+
+                last_child = child->prev_sibling;
+                child->~scope_context();
             }
         }
 
@@ -153,19 +239,27 @@ namespace vast::cg
 
         template< typename child_scope_type >
         scope_context &mk_child() {
-            children.push_back(std::make_unique< child_scope_type >(this));
-            return *children.back();
+            auto child = new (arena->Allocate< child_scope_type >()) child_scope_type(this);
+            child->prev_sibling = std::exchange(last_child, child);
+            return *child;
         }
 
-        void defer(deferred_task task) {
-            deferred.push_back(std::move(task));
+        template< typename task_t >
+        void defer(task_t &&task) {
+            deferred.push(*arena, std::forward< task_t >(task));
         }
 
-        std::deque< deferred_task > deferred;
+        deferred_tasks deferred;
 
         // links between scopes
         scope_context *parent = nullptr;
-        std::deque< std::unique_ptr< scope_context > > children;
+
+        // children are kept in an intrusive list, the latest child first
+        scope_context *last_child   = nullptr;
+        scope_context *prev_sibling = nullptr;
+
+      protected:
+        scope_arena *arena;
     };
 
 
@@ -192,12 +286,15 @@ namespace vast::cg
 
 
     // Refers to function scope §6.2.1 of C standard
-    struct function_scope : block_scope {
-        using block_scope::block_scope;
+    //
+    // Owns the arena of scopes nested in the function.
+    struct function_scope : scope_arena_owner, block_scope {
         explicit function_scope(scope_context *parent)
             : block_scope(parent)
             , labels(parent->symbols.labels)
-        {}
+        {
+            arena = &arena_storage;
+        }
 
         virtual ~function_scope() = default;
 
@@ -220,9 +317,9 @@ namespace vast::cg
     // If the declarator or type specifier that declares the identifier appears
     // outside of any block or list of parameters, the identifier has file
     // scope, which terminates at the end of the translation unit.
-    struct module_scope : scope_context {
+    struct module_scope : scope_arena_owner, scope_context {
         explicit module_scope(symbol_tables &symbols)
-            : scope_context(symbols)
+            : scope_context(symbols, arena_storage)
             , functions(symbols.funs)
             , types(symbols.types)
             , globals(symbols.vars)
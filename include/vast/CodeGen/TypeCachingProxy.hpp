@@ -6,37 +6,48 @@
 
 namespace vast::cg {
 
-    struct type_caching_proxy : fallthrough_list_node {
-
-        mlir_type visit(const clang_type *type, scope_context &scope) override {
+    //
+    // Caches types produced by the visitors below `next_t`. Used either as
+    // a node of `visitor_list` (`type_caching_proxy`) or as a layer of
+    // a statically composed visitor stack (see CodeGenVisitorStack.hpp).
+    //
+    template< typename next_t >
+    struct type_caching_layer : next_t {
+
+        using next_t::next_t;
+        using next_t::visit;
+
+        mlir_type visit(const clang_type *type, scope_context &scope) {
             return visit_type(type, cache, scope);
         }
 
-        mlir_type visit(clang_qual_type type, scope_context &scope) override {
+        mlir_type visit(clang_qual_type type, scope_context &scope) {
             // Can't lookup Empty value
             if (type.isNull()) {
-                return next->visit(type, scope);
+                return next_t::visit(type, scope);
             }
             return visit_type(type, qual_cache, scope);
         }
 
-        mlir_type visit_type(auto type, auto& cache, scope_context& scope);
+        mlir_type visit_type(auto type, auto& cache, scope_context& scope) {
+            if (auto value = cache.lookup(type)) {
+                return value;
+            }
+
+            if (auto result = next_t::visit(type, scope)) {
+                cache.try_emplace(type, result);
+                return result;
+            } else {
+                return {};
+            }
+        }
+
+        const type_caching_layer &types() const { return *this; }
 
         llvm::DenseMap< const clang_type *, mlir_type > cache;
         llvm::DenseMap< clang_qual_type, mlir_type > qual_cache;
     };
 
-    mlir_type type_caching_proxy::visit_type(auto type, auto& cache, scope_context& scope) {
-        if (auto value = cache.lookup(type)) {
-            return value;
-        }
-
-        if (auto result = next->visit(type, scope)) {
-            cache.try_emplace(type, result);
-            return result;
-        } else {
-            return {};
-        }
-    }
+    struct type_caching_proxy : type_caching_layer< fallthrough_list_node > {};
 
 } // namespace vast::cg
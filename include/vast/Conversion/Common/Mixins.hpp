@@ -12,8 +12,13 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Types.hpp"
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
 
+#include "vast/Dialect/Core/Interfaces/FunctionInterface.hpp"
+#include "vast/Dialect/Core/SymbolTable.hpp"
+
 #include "vast/Util/TypeList.hpp"
 
+#include <optional>
+
 namespace vast {
 
     template< typename self >
@@ -47,9 +52,18 @@ namespace vast {
 
         auto &underlying() { return static_cast<self &>(*this); }
 
+        // Symbol modifications of the conversion are forwarded to the symbol
+        // table cache installed by the pass, if any.
         auto apply_conversions(auto &&cfg) {
+            mlir::ConversionConfig config;
+
+            std::optional< core::symbol_table_cache::listener > listener;
+            if (auto cache = core::symbol_table_cache::active()) {
+                config.listener = &listener.emplace(*cache);
+            }
+
             return mlir::applyPartialConversion(
-                underlying().getOperation(), cfg.target, std::move(cfg.patterns)
+                underlying().getOperation(), cfg.target, std::move(cfg.patterns), config
             );
         }
 
@@ -68,6 +82,48 @@ namespace vast {
     template< typename T >
     concept has_setup = requires(T a) { a.setup_pass(); };
 
+    // Passes resolving symbols in patterns can declare
+    // `static constexpr bool cache_symbol_tables = true` to reuse materialized
+    // symbol tables during the conversion.
+    template< typename T >
+    concept caches_symbol_tables = T::cache_symbol_tables;
+
+    // Passes that neither create, erase nor rename symbols can declare
+    // `static constexpr bool preserve_symbol_tables = true` to keep the cache
+    // for subsequent passes.
+    template< typename T >
+    concept preserves_symbol_tables = T::preserve_symbol_tables;
+
+    // Passes querying symbol uses in patterns can declare
+    // `static constexpr bool index_symbol_uses = true` to answer the queries
+    // from a single index of the converted operation.
+    template< typename T >
+    concept indexes_symbol_uses = T::index_symbol_uses;
+
+    //
+    // Op-agnostic conversion passes convert the operation they run on.
+    // Pipelines run them nested on functions, so functions are converted in
+    // parallel. Conversions outside of functions are left to a module-level
+    // part of the pass scheduled before the nested one.
+    //
+    inline bool is_function(operation op) {
+        return mlir::isa< core::function_op_interface >(op);
+    }
+
+    // Operations of the module that are not converted by passes nested on
+    // functions.
+    inline std::vector< operation > ops_outside_functions(operation mod) {
+        std::vector< operation > out;
+        for (auto &region : mod->getRegions()) {
+            for (auto &op : region.getOps()) {
+                if (!is_function(&op)) {
+                    out.push_back(&op);
+                }
+            }
+        }
+        return out;
+    }
+
     using rewrite_pattern_set = mlir::RewritePatternSet;
 
     // base configuration class
@@ -140,15 +196,51 @@ namespace vast {
         }
 
 
+        void run_pass() {
+            if (mlir::succeeded(self().run_on_operation())) {
+                if constexpr (has_run_after_conversion< derived >) {
+                    self().run_after_conversion();
+                }
+
+                if constexpr (preserves_symbol_tables< derived >) {
+                    this->template markAnalysesPreserved< core::symbol_table_cache >();
+                }
+            }
+        }
+
+        // Nested passes read tables outside of their operation from a cache
+        // of an ancestor, e.g., materialized by a module-level part.
+        const core::symbol_table_cache *ancestor_symbol_tables() {
+            for (auto op = getOperation()->getParentOp(); op; op = op->getParentOp()) {
+                if (auto cache = this->template getCachedParentAnalysis< core::symbol_table_cache >(op)) {
+                    return &cache->get();
+                }
+            }
+            return nullptr;
+        }
+
+        void run_pass_with_symbol_tables() {
+            if constexpr (caches_symbol_tables< derived >) {
+                auto &cache = this->template getAnalysis< core::symbol_table_cache >();
+                cache.inherit(ancestor_symbol_tables());
+                core::symbol_table_cache::scope scope(cache);
+                run_pass();
+            } else {
+                run_pass();
+            }
+        }
+
         void runOnOperation() override {
             if constexpr (has_setup< derived >) {
                 self().setup_pass();
             }
 
-            if (mlir::succeeded(self().run_on_operation())) {
-                if constexpr (has_run_after_conversion< derived >) {
-                    self().run_after_conversion();
-                }
+            if constexpr (indexes_symbol_uses< derived >) {
+                const auto &index = this->template getAnalysis< core::symbol_use_index >();
+                core::symbol_use_index::scope scope(index);
+                run_pass_with_symbol_tables();
+            } else {
+                run_pass_with_symbol_tables();
             }
         }
     };
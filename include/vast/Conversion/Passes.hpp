@@ -44,13 +44,19 @@ namespace vast
     // ABI
     std::unique_ptr< mlir::Pass > createEmitABIPass();
 
+    std::unique_ptr< mlir::Pass > createEmitABIModulePass();
+
     std::unique_ptr< mlir::Pass > createLowerABIPass();
 
+    std::unique_ptr< mlir::Pass > createLowerABIModulePass();
+
     // FromHL
     std::unique_ptr< mlir::Pass > createHLToLLCFPass();
 
     std::unique_ptr< mlir::Pass > createHLToLLGEPsPass();
 
+    std::unique_ptr< mlir::Pass > createHLToLLGEPsModulePass();
+
     std::unique_ptr< mlir::Pass > createHLEmitLazyRegionsPass();
 
     std::unique_ptr< mlir::Pass > createHLToLLFuncPass();
@@ -59,9 +65,13 @@ namespace vast
 
     std::unique_ptr< mlir::Pass > createLowerValueCategoriesPass();
 
+    std::unique_ptr< mlir::Pass > createLowerValueCategoriesModulePass();
+
     // ToMem
     std::unique_ptr< mlir::Pass > createRefsToSSAPass();
 
+    std::unique_ptr< mlir::Pass > createRefsToSSAModulePass();
+
     std::unique_ptr< mlir::Pass > createEvictStaticLocalsPass();
 
     std::unique_ptr< mlir::Pass > createStripParamLValuesPass();
@@ -127,7 +127,7 @@ namespace vast::conv::tc {
         }
 
         llvm_type_converter(mcontext_t *mctx, const mlir::DataLayoutAnalysis &dl, lower_to_llvm_options opts, operation op)
-            : base(mctx, opts, &dl)
+            : base(mctx, opts, &dl), dla(dl), anchor(op)
         {
             addConversion([&](hl::LabelType t) { return t; });
             addConversion([&](hl::LValueType t) { return this->convert_lvalue_type(t); });
@@ -142,7 +142,7 @@ namespace vast::conv::tc {
                 return LLVM::LLVMVoidType::get(t.getContext());
             });
 
-            addConversion([op, this](hl::RecordType t, mlir::SmallVectorImpl< mlir_type > &out) {
+            addConversion([this](hl::RecordType t, mlir::SmallVectorImpl< mlir_type > &out) {
                 auto core = mlir::LLVM::LLVMStructType::getIdentified(
                     t.getContext(), t.getName()
                 );
@@ -151,7 +151,7 @@ namespace vast::conv::tc {
                 if (core.isOpaque() && !llvm::count(stack, t)) {
                     stack.push_back(t);
                     auto pop = llvm::make_scope_exit([&]{ stack.pop_back(); });
-                    if (auto body = convert_field_types(op, t)) {
+                    if (auto body = convert_field_types(anchor, t)) {
                         [[maybe_unused]] auto status = core.setBody(*body, false);
                         VAST_ASSERT(mlir::succeeded(status));
                     }
@@ -186,6 +186,10 @@ namespace vast::conv::tc {
         llvm_type_converter &operator=(const llvm_type_converter &) = delete;
         llvm_type_converter &operator=(llvm_type_converter &&)      = delete;
 
+        // Record types are resolved in the symbol table of the anchor, a
+        // converter shared by multiple operations is re-anchored before use.
+        void set_anchor(operation op) { anchor = op; }
+
 
         maybe_types_t do_conversion(mlir_type t) const {
             types_t out;
@@ -312,9 +316,8 @@ namespace vast::conv::tc {
             }
 
             if (auto union_decl = mlir::dyn_cast< hl::UnionDeclOp >(*def)) {
-                auto dla    = mlir::DataLayoutAnalysis(union_decl);
-                auto dl     = dla.getAtOrAbove(union_decl);
-                auto fields = union_lowering{ dl, union_decl }.compute_lowering().fields;
+                const auto &dl = dla.getAtOrAbove(union_decl);
+                auto fields    = union_lowering{ dl, union_decl }.compute_lowering().fields;
                 return { union_lowering::final_fields(std::move(fields)) };
             } else {
                 return { def.getFieldTypes() };
@@ -335,6 +338,10 @@ namespace vast::conv::tc {
             }
             return { std::move(out) };
         }
+
+      private:
+        const mlir::DataLayoutAnalysis &dla;
+        operation anchor;
     };
 
 } // namespace vast::conv::tc
@@ -6,7 +6,10 @@
 
 VAST_RELAX_WARNINGS
 #include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
 #include <mlir/IR/OpDefinition.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/Pass/AnalysisManager.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Core/CoreTraits.hpp"
@@ -157,6 +160,20 @@ namespace vast::core {
             try_insert< util::flatten< symbol_lists > >(op);
         }
 
+        // Inserts the symbol if the table recognizes its kind, the kind is
+        // resolved at runtime. Returns true if the symbol was inserted.
+        bool try_insert(operation op);
+
+        // Removes the symbol from the table, returns true if it was present.
+        bool erase(operation op);
+
+        // Moves the symbol under its current name if it was renamed since
+        // it was inserted.
+        void rename(operation op);
+
+        // Symbols kept in the table with names they were inserted under.
+        const llvm::DenseMap< operation, string_ref > &symbols() const { return names; }
+
         bool can_hold_symbol_kind(symbol_kind kind) const {
             return symbol_tables.contains(kind);
         }
@@ -214,11 +231,121 @@ namespace vast::core {
 
         operation symbol_table_op;
         llvm::DenseMap< symbol_kind, single_symbol_kind_table > symbol_tables;
+
+        // Reverse index, allows to remove renamed or erased symbols.
+        llvm::DenseMap< operation, string_ref > names;
+    };
+
+    //
+    // Symbol tables materialized on demand and reused between lookups.
+    //
+    // The cache is an analysis of the operation a pass runs on. Passes that
+    // modify symbols have to keep it in sync, either by attaching
+    // `symbol_table_cache::listener` to their rewriter (conversion passes
+    // do so in `populate_patterns::apply_conversions`) or by notifying the
+    // cache directly. Such a pass can then mark the cache as preserved and
+    // later passes reuse it.
+    //
+    // While a cache is installed by `symbol_table_cache::scope`, the static
+    // `symbol_table::lookup` resolves symbols through it.
+    //
+    // A cache of a nested operation (e.g., a function processed by a nested
+    // pass) can inherit a cache of its ancestor. Tables outside of the nested
+    // operation are then read from the ancestor cache, which has to hold all
+    // of them before the nested passes start (see `materialize_enclosing`),
+    // as nested passes run in parallel and must not modify it.
+    //
+    struct symbol_table_cache
+    {
+        symbol_table_cache() = default;
+        explicit symbol_table_cache(operation root) : root(root) {}
+
+        // Returns the table of `table_op`, materializes it on the first use.
+        symbol_table &get(operation table_op);
+
+        // Returns the table of `table_op` if it is already materialized.
+        const symbol_table *find(operation table_op) const;
+
+        // Materializes the tables of the root and of nested operations that
+        // are not isolated from above, i.e., all tables enclosing operations
+        // processed by nested passes.
+        void materialize_enclosing();
+
+        // Sets the cache of an ancestor of the root, `nullptr` unsets it. The
+        // ancestor cache is only read and has to outlive the lookups.
+        void inherit(const symbol_table_cache *outer_cache) { outer = outer_cache; }
+
+        template< symbol_op_interface symbol_kind >
+        [[nodiscard]] operation lookup(operation from, string_ref symbol);
+
+        void notify_inserted(operation op);
+        void notify_erased(operation op);
+        void notify_renamed(operation op);
+
+        void clear();
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) {
+            return !pa.isPreserved< symbol_table_cache >();
+        }
+
+        // Cache installed on the current thread, if any.
+        static symbol_table_cache *active();
+
+        struct scope
+        {
+            explicit scope(symbol_table_cache &cache);
+            ~scope();
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+          private:
+            symbol_table_cache *previous;
+        };
+
+        //
+        // Forwards symbol modifications done by a rewriter to the cache.
+        //
+        struct listener : mlir::RewriterBase::Listener
+        {
+            explicit listener(symbol_table_cache &cache) : cache(cache) {}
+
+            void notifyOperationInserted(
+                operation op, mlir::OpBuilder::InsertPoint previous
+            ) override;
+
+            void notifyOperationErased(operation op) override;
+            void notifyOperationModified(operation op) override;
+
+          private:
+            symbol_table_cache &cache;
+        };
+
+      private:
+        void forget(operation op);
+
+        // Table used for lookups, prefers the ancestor cache for tables
+        // outside of the root.
+        const symbol_table &resolve(operation table_op);
+
+        operation root = nullptr;
+        const symbol_table_cache *outer = nullptr;
+
+        llvm::DenseMap< operation, std::unique_ptr< symbol_table > > tables;
+
+        // Cached table keeping the symbol.
+        llvm::DenseMap< operation, symbol_table * > owners;
     };
 
 
+    operation get_effective_symbol_table_op_for(operation from, symbol_kind kind);
+
     template< symbol_op_interface symbol_kind >
     operation symbol_table::lookup(operation from, string_ref symbol) {
+        if (auto cache = symbol_table_cache::active()) {
+            return cache->template lookup< symbol_kind >(from, symbol);
+        }
+
         auto table = get_effective_symbol_table_for< symbol_kind >(from);
         VAST_CHECK(table, "No effective symbol table found.");
 
@@ -253,6 +380,22 @@ namespace vast::core {
         return symbol->second.back();
     }
 
+    template< symbol_op_interface symbol_kind >
+    operation symbol_table_cache::lookup(operation from, string_ref symbol) {
+        auto kind = get_symbol_kind< symbol_kind >;
+
+        auto table = get_effective_symbol_table_op_for(from, kind);
+        VAST_CHECK(table, "No effective symbol table found.");
+
+        while (table) {
+            if (auto result = resolve(table).template lookup< symbol_kind >(symbol))
+                return result;
+            table = get_effective_symbol_table_op_for(table->getParentOp(), kind);
+        }
+
+        return {};
+    }
+
     std::optional< symbol_table > get_effective_symbol_table_for(operation from, symbol_kind kind);
 
     template< symbol_op_interface symbol_kind >
@@ -265,6 +408,71 @@ namespace vast::core {
         return get_effective_symbol_table_for< symbol_kind >(from->getParentOp());
     }
 
+    // FIXME: This is not nice. Can this be inferred from the symbol reference directly?
+    enum class reference_kind { var, type, func, label, member, enum_constant, elaborated_type };
+
+    //
+    // Index of all symbol references nested in the root operation, built in
+    // a single walk. References are grouped by the referenced name and the
+    // kind of reference, so symbol use queries visit only the uses of the
+    // queried symbol instead of the whole scope.
+    //
+    // The index is an analysis of the root operation. While it is installed
+    // by `symbol_use_index::scope`, static `symbol_table` use queries within
+    // the root are answered by the index.
+    //
+    struct symbol_use_index
+    {
+        using symbol_use = mlir::SymbolTable::SymbolUse;
+
+        explicit symbol_use_index(operation root);
+
+        symbol_use_range get_direct_symbol_uses(operation symbol, operation scope) const;
+        symbol_use_range get_direct_symbol_uses(operation symbol, region_ptr scope) const;
+
+        symbol_use_range get_symbol_uses(operation symbol, operation scope) const;
+        symbol_use_range get_symbol_uses(operation symbol, region_ptr scope) const;
+
+        // Returns true if the index holds all references nested in `scope`.
+        bool covers(operation scope) const;
+        bool covers(region_ptr scope) const;
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) {
+            return !pa.isPreserved< symbol_use_index >();
+        }
+
+        // Index installed on the current thread, if any.
+        static const symbol_use_index *active();
+
+        struct scope
+        {
+            explicit scope(const symbol_use_index &index);
+            ~scope();
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+          private:
+            const symbol_use_index *previous;
+        };
+
+      private:
+        using use_key = std::pair< string_attr, unsigned >;
+
+        void index_references(operation op);
+
+        // Uses of `symbol` by users accepted by `in_scope`, uses preceding
+        // the definition of a symbol other than a function are dropped.
+        symbol_use_range collect(
+            operation symbol, llvm::function_ref< bool(operation) > in_scope
+        ) const;
+
+        operation root;
+
+        // Uses in the walk order of users.
+        llvm::DenseMap< use_key, std::vector< symbol_use > > uses;
+    };
+
     //
     // Name of the symbol attribute to be used in operations declaring symbols.
     //
@@ -6,6 +6,7 @@
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/TypeUseIndex.hpp"
 
 #include "vast/Dialect/Core/CoreOps.hpp"
 #include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
@@ -101,6 +102,30 @@ namespace vast::hl {
         }, scope, std::forward< decltype(yield) >(yield));
     }
 
+    namespace detail {
+        walk_result indexed_users(llvm::ArrayRef< operation > users, auto &&yield) {
+            for (auto user : users) {
+                if (yield(user).wasInterrupted()) {
+                    return walk_result::interrupt();
+                }
+            }
+            return walk_result::advance();
+        }
+    } // namespace detail
+
+    // Users of named types answered by a prebuilt index of the scope.
+    walk_result users(hl::TypeDefOp op, const type_use_index &index, auto &&yield) {
+        return detail::indexed_users(index.users(op), std::forward< decltype(yield) >(yield));
+    }
+
+    walk_result users(hl::TypeDeclOp op, const type_use_index &index, auto &&yield) {
+        return detail::indexed_users(index.users(op), std::forward< decltype(yield) >(yield));
+    }
+
+    walk_result users(core::aggregate_interface op, const type_use_index &index, auto &&yield) {
+        return detail::indexed_users(index.users(op), std::forward< decltype(yield) >(yield));
+    }
+
     walk_result users(hl::VarDeclOp var, auto scope, auto &&yield) {
         VAST_CHECK(var.hasGlobalStorage(), "Only global variables are supported");
         return scope.walk([&](DeclRefOp op) {
@@ -32,6 +32,10 @@ namespace vast::hl {
 
     std::unique_ptr< mlir::Pass > createLowerEnumDeclsPass();
 
+    std::unique_ptr< mlir::Pass > createUnreachableCodePass();
+
+    std::unique_ptr< mlir::Pass > createUninitializedVariablesPass();
+
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
 #include "vast/Dialect/HighLevel/Passes.h.inc"
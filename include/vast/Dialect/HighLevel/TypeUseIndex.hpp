@@ -0,0 +1,82 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <mlir/Pass/AnalysisManager.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "vast/Dialect/Core/Interfaces/TypeDefinitionInterface.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::hl {
+
+    //
+    // Index of operations mentioning named high-level types (typedefs,
+    // records, enums and their elaborations), computed in a single walk of
+    // the root. An operation mentions a type if the type is nested anywhere
+    // in its result, operand, attribute or function types.
+    //
+    // Named types nested in a type or an attribute are memoized. As types and
+    // attributes are uniqued and immutable, the memo stays valid while the IR
+    // changes. Hence `mentions` can be used to decide legality of operations
+    // rewritten during a conversion. Users of names reflect the IR at the
+    // time the index was built.
+    //
+    // Queries of mentioned types extend the memo and are not thread-safe.
+    //
+    struct type_use_index
+    {
+        explicit type_use_index(operation root);
+
+        // Users in the walk order of `root`.
+        llvm::ArrayRef< operation > typedef_users(string_ref name) const;
+        llvm::ArrayRef< operation > record_users(string_ref name) const;
+
+        llvm::ArrayRef< operation > users(hl::TypeDefOp op) const;
+        llvm::ArrayRef< operation > users(hl::TypeDeclOp op) const;
+        llvm::ArrayRef< operation > users(core::aggregate_interface op) const;
+
+        // Named types mentioned by `op`, may contain duplicates.
+        llvm::SmallVector< mlir_type, 4 > mentioned_types(operation op);
+
+        template< typename... types_t >
+        bool mentions(operation op) {
+            return !for_each_mentioned_type(op, [] (mlir_type type) {
+                return !mlir::isa< types_t... >(type);
+            });
+        }
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) {
+            return !pa.isPreserved< type_use_index >();
+        }
+
+      private:
+        using named_types_t = llvm::SmallVector< mlir_type, 2 >;
+
+        // Calls `yield` for every named type mentioned by `op` until it
+        // returns false. Returns false if the iteration was interrupted.
+        bool for_each_mentioned_type(
+            operation op, llvm::function_ref< bool(mlir_type) > yield
+        );
+
+        const named_types_t &named_types(mlir_type type);
+        const named_types_t &named_types(mlir_attr attr);
+
+        llvm::DenseMap< const void *, named_types_t > nested;
+
+        llvm::StringMap< std::vector< operation > > typedefs;
+        llvm::StringMap< std::vector< operation > > records;
+    };
+
+} // namespace vast::hl
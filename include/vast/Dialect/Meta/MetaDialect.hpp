@@ -18,14 +18,26 @@ VAST_RELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 
+#include <optional>
+
 namespace vast::meta
 {
     using identifier_t = std::uint64_t;
 
+    // Identifiers of operations indexed by `identifier_index` have to be
+    // changed through the index, these do not update it.
     void add_identifier(operation op, identifier_t id);
 
     void remove_identifier(operation op);
 
+    std::optional< identifier_t > get_identifier(operation op);
+
+    // Identifier attached as metadata of the fused location. Opaque locations
+    // are looked through to their fallback location.
+    std::optional< identifier_t > get_location_identifier(loc_t loc);
+
+    // Lookups walk the whole scope, use `identifier_index` for repeated queries.
+    // Any operation in the scope can have an identifier, not only symbols.
     std::vector< operation  > get_with_identifier(operation scope, identifier_t id);
 
     std::vector< operation  > get_with_meta_location(operation scope, identifier_t id);
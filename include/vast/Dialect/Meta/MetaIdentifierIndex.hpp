@@ -0,0 +1,61 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/Pass/AnalysisManager.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::meta {
+
+    //
+    // Index of operations by meta identifiers, computed in a single walk of
+    // the root. Operations are indexed both by their `meta_identifier`
+    // attribute and by identifiers attached as metadata of their fused
+    // location, e.g., by `-vast-locs-as-meta-ids`.
+    //
+    // Identifiers added or removed through the index keep it up to date,
+    // otherwise the index reflects the IR at the time it was built.
+    //
+    struct identifier_index
+    {
+        explicit identifier_index(operation root);
+
+        // Operations in the walk order of the root, followed by operations
+        // whose identifier was added through the index.
+        llvm::ArrayRef< operation > with_identifier(identifier_t id) const;
+        llvm::ArrayRef< operation > with_meta_location(identifier_t id) const;
+
+        // Operations located by each of `ids`, in the order of `ids`.
+        std::vector< llvm::ArrayRef< operation > >
+        with_meta_locations(llvm::ArrayRef< identifier_t > ids) const;
+
+        void add_identifier(operation op, identifier_t id);
+        void remove_identifier(operation op);
+
+        operation root() const { return indexed_root; }
+
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) {
+            return !pa.isPreserved< identifier_index >();
+        }
+
+      private:
+        using operations_t = llvm::SmallVector< operation, 1 >;
+
+        operation indexed_root;
+
+        llvm::DenseMap< identifier_t, operations_t > identifiers;
+        llvm::DenseMap< identifier_t, operations_t > locations;
+    };
+
+} // namespace vast::meta
@@ -9,6 +9,7 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
+#include "vast/Frontend/Cache.hpp"
 #include "vast/Frontend/CompilerInstance.hpp"
 #include "vast/Frontend/FrontendAction.hpp"
 #include "vast/Frontend/Options.hpp"
@@ -31,6 +32,7 @@ namespace vast::cc {
     std::unique_ptr< mcontext_t > mk_mcontext();
 
     struct vast_stream_consumer;
+    struct pipeline_cache;
 
     //
     // Stream action produces the desired output
@@ -39,12 +41,15 @@ namespace vast::cc {
     struct vast_stream_action : frontend_action {
         virtual ~vast_stream_action() = default;
 
-        vast_stream_consumer *consumer;
+        vast_stream_consumer *consumer = nullptr;
         output_type action;
 
     protected:
 
-        vast_stream_action(output_type action, const vast_args &vargs, mcontext_t &mctx);
+        vast_stream_action(
+            output_type action, const vast_args &vargs, mcontext_t &mctx,
+            pipeline_cache *pipelines = nullptr
+        );
 
         std::unique_ptr< clang::ASTConsumer >
         CreateASTConsumer(compiler_instance &ci, string_ref input) override;
@@ -58,6 +63,9 @@ namespace vast::cc {
 
         const vast_args &vargs;
         mcontext_t &mctx;
+        pipeline_cache *pipelines;
+
+        std::optional< module_cache > cache;
     };
 
     struct vast_consumer;
@@ -98,7 +106,9 @@ namespace vast::cc {
     // Emit assembly
     //
     struct emit_assembly_action : vast_stream_action {
-        explicit emit_assembly_action(const vast_args &vargs, mcontext_t &mctx);
+        explicit emit_assembly_action(
+            const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines = nullptr
+        );
     private:
         virtual void anchor();
     };
@@ -107,7 +117,9 @@ namespace vast::cc {
     // Emit LLVM
     //
     struct emit_llvm_action : vast_stream_action {
-        explicit emit_llvm_action(const vast_args &vargs, mcontext_t &mctx);
+        explicit emit_llvm_action(
+            const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines = nullptr
+        );
     private:
         virtual void anchor();
     };
@@ -116,7 +128,9 @@ namespace vast::cc {
     // Emit MLIR
     //
     struct emit_mlir_action : vast_stream_action {
-        explicit emit_mlir_action(const vast_args &vargs, mcontext_t &mctx);
+        explicit emit_mlir_action(
+            const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines = nullptr
+        );
     private:
         virtual void anchor();
     };
@@ -125,7 +139,9 @@ namespace vast::cc {
     // Emit obj
     //
     struct emit_obj_action : vast_stream_action {
-        explicit emit_obj_action(const vast_args &vargs, mcontext_t &mctx);
+        explicit emit_obj_action(
+            const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines = nullptr
+        );
     private:
         virtual void anchor();
     };
@@ -0,0 +1,107 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc {
+
+    //
+    // Content-addressed on-disk cache of modules produced by vast pipelines.
+    //
+    // A unit is identified by its preprocessed tokens, the compiler invocation
+    // and the vast options that affect the produced module. Its modules are
+    // stored after codegen and after every top-level pipeline step, keyed by
+    // the unit and the passes applied so far. Hence a later compilation with a
+    // longer pipeline can resume from the last stored stage.
+    //
+    // Entries are written atomically, so concurrent compilations can share the
+    // cache directory. The directory is pruned to the configured size.
+    //
+    struct module_cache
+    {
+        // Returns the cache if it is enabled by `vargs` and the requested
+        // compilation does not depend on actually running the pipeline (e.g.,
+        // snapshots or diagnostics verification).
+        static std::optional< module_cache > open(const vast_args &vargs);
+
+        // Key of the translation unit processed by `ci`, the unit is
+        // preprocessed in a separate compiler instance. Returns `std::nullopt`
+        // if the unit cannot be preprocessed.
+        static std::optional< std::string > unit_key(
+            compiler_instance &ci, const vast_args &vargs
+        );
+
+        struct stage
+        {
+            // Number of pipeline passes applied to the module.
+            std::size_t applied;
+            std::string key;
+        };
+
+        using stages_t = std::vector< stage >;
+
+        // Keys of modules between stages of the pipeline, the first stage is
+        // the module right after codegen.
+        static stages_t stages(string_ref unit, const pipeline_t &ppl);
+
+        // Returns the index of the latest stage present in the cache.
+        std::optional< std::size_t > lookup(const stages_t &stages) const;
+
+        owning_mlir_module_ref load(string_ref key, mcontext_t &mctx) const;
+
+        void store(string_ref key, mlir_module mod) const;
+
+      private:
+        module_cache(std::string directory, std::uint64_t size_limit)
+            : directory(std::move(directory)), size_limit(size_limit)
+        {}
+
+        std::string path(string_ref key) const;
+
+        std::string directory;
+        std::uint64_t size_limit;
+    };
+
+    //
+    // Stores the module into the cache whenever the pipeline reaches the end
+    // of one of the stages.
+    //
+    struct with_module_cache : mlir::PassInstrumentation
+    {
+        with_module_cache(
+            const module_cache &cache, const module_cache::stages_t &stages,
+            const pipeline_t &ppl
+        );
+
+        void runAfterPass(pass_ptr pass, operation op) override;
+
+      private:
+        void store(string_ref key, operation op) const;
+
+        const module_cache &cache;
+
+        // Keys of stages indexed by the last pass of the stage.
+        llvm::DenseMap< mlir::TypeID, std::string > stage_ends;
+
+        // Stage finished by a nested pass, waiting for the whole module.
+        std::mutex mutex;
+        std::optional< std::string > pending;
+    };
+
+} // namespace vast::cc
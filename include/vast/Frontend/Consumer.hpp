@@ -9,6 +9,8 @@ VAST_RELAX_WARNINGS
 #include <clang/CodeGen/BackendUtil.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Frontend/Cache.hpp"
+#include "vast/Frontend/CompilerInstance.hpp"
 #include "vast/Frontend/Diagnostics.hpp"
 #include "vast/Frontend/FrontendAction.hpp"
 #include "vast/Frontend/Options.hpp"
@@ -18,6 +20,8 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Core/CoreOps.hpp"
 
+#include "vast/Util/Profiler.hpp"
+
 namespace vast::cc {
 
     using output_stream_ptr = std::unique_ptr< llvm::raw_pwrite_stream >;
@@ -26,6 +30,9 @@ namespace vast::cc {
 
     using backend = clang::BackendAction;
 
+    struct pipeline_cache;
+    struct vast_pipeline;
+
     struct vast_consumer : clang_ast_consumer
     {
         vast_consumer(action_options opts, const vast_args &vargs, mcontext_t &mctx)
@@ -59,6 +66,8 @@ namespace vast::cc {
         owning_mlir_module_ref result();
 
       protected:
+        // Records clang parse and codegen of the produced module `mod`.
+        void record_frontend_profile(util::pipeline_profile &profile, mlir_module mod) const;
 
         virtual void anchor() {}
 
@@ -78,6 +87,18 @@ namespace vast::cc {
         // vast driver
         //
         std::unique_ptr< cg::driver > driver = nullptr;
+
+        //
+        // Clang parses and calls into codegen interleaved, time spent outside
+        // of the driver is accounted to the parse. Finalization of the driver
+        // follows the parse and is measured separately.
+        //
+        using clock = util::profile_sample::clock;
+
+        util::profile_sample frontend_start;
+        clock::time_point parse_end;
+        clock::duration codegen_time  = {};
+        clock::duration finalize_time = {};
     };
 
     struct vast_stream_consumer : vast_consumer {
@@ -86,14 +107,24 @@ namespace vast::cc {
         vast_stream_consumer(
             output_type act, action_options opts,
             const vast_args &vargs, mcontext_t &mctx,
-            output_stream_ptr os
-        )
-            : base(std::move(opts), vargs, mctx), action(act), output_stream(std::move(os))
-        {}
+            output_stream_ptr os, compiler_instance &ci,
+            pipeline_cache *pipelines = nullptr
+        );
+
+        ~vast_stream_consumer();
 
         void HandleTranslationUnit(acontext_t &acontext) override;
 
+        // Produces the output from the module cache, without clang parse and
+        // codegen. Returns `false` on a cache miss, the following compilation
+        // then stores its modules into the cache.
+        bool compile_from_cache(const module_cache &cache);
+
       private:
+        std::optional< target_dialect > pipeline_target() const;
+
+        void emit_output(owning_mlir_module_ref mod);
+
         void emit_backend_output(backend backend_action, owning_mlir_module_ref mod);
 
         void emit_mlir_output(target_dialect target, owning_mlir_module_ref mod);
@@ -103,8 +134,34 @@ namespace vast::cc {
         void print_mlir_bytecode(owning_mlir_module_ref mod);
         void print_mlir_string_format(owning_mlir_module_ref mod);
 
+        vast_pipeline *cached_pipeline(
+            target_dialect target, mlir_module mod,
+            std::unique_ptr< vast_pipeline > &owned, string_ref snapshot_prefix
+        );
+
         output_type action;
         output_stream_ptr output_stream;
+
+        // compiler instance that owns the consumer, used to emit outputs of
+        // units restored from the module cache
+        compiler_instance &ci;
+
+        // optional cache of pipelines shared by consumers running on the same context
+        pipeline_cache *pipelines;
+
+        struct cached_compilation
+        {
+            const module_cache &cache;
+            module_cache::stages_t stages;
+
+            // Full pipeline the stages were computed from.
+            std::unique_ptr< vast_pipeline > pipeline;
+
+            // Stage of the module restored from the cache.
+            std::optional< std::size_t > restored;
+        };
+
+        std::optional< cached_compilation > cached;
     };
 
 } // namespace vast::cc
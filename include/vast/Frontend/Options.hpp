@@ -79,6 +79,7 @@ namespace vast::cc
         constexpr option_t emit_mlir_bytecode = "emit-mlir-bytecode";
 
         constexpr option_t print_pipeline = "print-pipeline";
+        constexpr option_t profile_pipeline = "profile-pipeline";
         constexpr option_t emit_crash_reproducer = "emit-crash-reproducer";
 
         constexpr option_t disable_multithreading = "disable-multithreading";
@@ -88,6 +89,7 @@ namespace vast::cc
         constexpr option_t canonicalize = "canonicalize";
 
         constexpr option_t snapshot_at = "snapshot-at";
+        constexpr option_t snapshot_format = "snapshot-format";
 
         llvm::Twine disable(string_ref pipeline_name);
 
@@ -97,12 +99,22 @@ namespace vast::cc
 
         constexpr option_t disable_unsupported = "disable-unsupported";
 
+        constexpr option_t lazy_decls = "lazy-decls";
+
         constexpr option_t disable_vast_verifier = "disable-verifier";
         constexpr option_t vast_verify_diags = "verify-diags";
         constexpr option_t disable_emit_cxx_default = "disable-emit-cxx-default";
 
         constexpr option_t output_sarif = "output-sarif";
 
+        constexpr option_t compile_commands = "compile-commands";
+        constexpr option_t batch_jobs       = "batch-jobs";
+        constexpr option_t batch_output_dir = "batch-output-dir";
+
+        constexpr option_t module_cache_dir  = "module-cache-dir";
+        constexpr option_t module_cache_size = "module-cache-size";
+        constexpr option_t module_cache_remarks = "module-cache-remarks";
+
         bool emit_only_mlir(const vast_args &vargs);
         bool emit_only_llvm(const vast_args &vargs);
     } // namespace opt
@@ -8,6 +8,8 @@ VAST_RELAX_WARNINGS
 #include <llvm/ADT/StringMap.h>
 VAST_UNRELAX_WARNINGS
 
+#include <map>
+
 #include "vast/Util/Pipeline.hpp"
 #include "vast/Frontend/Options.hpp"
 #include "vast/Frontend/Targets.hpp"
@@ -46,11 +48,38 @@ namespace vast::cc {
     // If the target is LLVM IR or other downstream target, the pipeline will
     // proceed into LLVM dialect.
     //
+    // Passes in `applied` are considered to be already applied on the module
+    // and are not scheduled, which allows to resume an interrupted pipeline.
+    //
     std::unique_ptr< vast_pipeline > setup_pipeline(
         pipeline_source src, target_dialect trg,
         mcontext_t &mctx,
         const vast_args &vargs,
-        string_ref snapshot_prefix = "snapshot"
+        string_ref snapshot_prefix = "snapshot",
+        llvm::ArrayRef< mlir::TypeID > applied = {}
     );
 
+    //
+    // Keeps set up pipelines alive between runs on the same MLIR context.
+    //
+    // Tools that compile many translation units in one process (e.g. the batch
+    // mode of vast-front) use the cache to pay for the pipeline setup only once
+    // per source and target. Pipelines with per-unit state (snapshots, crash
+    // reproducers, profiles) are never cached.
+    //
+    struct pipeline_cache
+    {
+        static bool is_cacheable(const vast_args &vargs);
+
+        vast_pipeline &get(
+            pipeline_source src, target_dialect trg,
+            mcontext_t &mctx,
+            const vast_args &vargs
+        );
+
+      private:
+        using key_t = std::pair< pipeline_source, target_dialect >;
+        std::map< key_t, std::unique_ptr< vast_pipeline > > pipelines;
+    };
+
 } // namespace vast::cc
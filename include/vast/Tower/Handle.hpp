@@ -9,18 +9,45 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 namespace vast::tw {
-    // These two should most likely be unified as one type.
-    using conversion_passes_t           = std::vector< pass_ptr >;
-
-    using conversion_path_t             = std::vector< std::string >;
-    using conversion_path_fingerprint_t = std::string;
+    using conversion_passes_t = std::vector< pass_ptr >;
 
     using handle_id_t = std::size_t;
 
+    struct module_storage;
+
+    // Reference to a module owned by the `module_storage`. The storage may keep
+    // the module only as a snapshot, in which case the full module is rebuilt
+    // on the first access. Referenced modules are never evicted from the storage.
+    struct module_ref
+    {
+        module_ref() = default;
+
+        module_ref(const module_storage *storage, handle_id_t id);
+
+        module_ref(const module_ref &other);
+        module_ref(module_ref &&other) noexcept;
+        module_ref &operator=(module_ref other) noexcept;
+
+        ~module_ref();
+
+        mlir_module get() const;
+
+        // Operation of the module with the provenance id `op_id`, `nullptr` if
+        // there is none.
+        operation lookup(std::uint64_t op_id) const;
+
+        mlir_module operator->() const { return get(); }
+        operator mlir_module() const { return get(); }
+
+      private:
+        const module_storage *storage = nullptr;
+        handle_id_t id = 0;
+    };
+
     struct handle_t
     {
         handle_id_t id;
-        mlir_module mod;
+        module_ref mod;
     };
 
 } // namespace vast::tw
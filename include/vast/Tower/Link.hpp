@@ -8,21 +8,54 @@
 #include "vast/Tower/LocationInfo.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace vast::tw {
 
     using operations = std::vector< operation >;
 
-    // Maybe we want to abstract this as an interface - then it can be lazy as well, for example
-    // we could pass in only some step chain and location info and it will get computed.
-    // Since if we have `A -> B` we can always construct `B -> A` it may make sense to simply only
-    // export bidirectional mapping?
+    using op_id_t = location_info_t::op_id_t;
+    using op_ids  = location_info_t::op_ids;
+
+    // Full mapping between two modules. Links compute it only on request, queries
+    // of individual operations should go through `children` and `parents`.
     using op_mapping = llvm::DenseMap< operation, operations >;
 
+    // One-to-many mapping of dense operation ids stored as compressed sparse rows:
+    // values of `key` are `values[offsets[key] .. offsets[key + 1])`.
+    struct id_mapping
+    {
+        // Inverts many-to-one mapping `from`, that maps index to a key smaller
+        // than `keys` (or `no_parent`), in two linear passes.
+        static id_mapping invert(const op_ids &from, std::size_t keys);
+
+        llvm::ArrayRef< op_id_t > operator[](op_id_t key) const;
+
+        std::size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+      private:
+        std::vector< std::size_t > offsets;
+        op_ids values;
+    };
+
+    // Memoized results of link queries by operation ids. All results share
+    // a single flat array, queried operations keep only their range in it.
+    struct id_memo
+    {
+        std::optional< op_ids > lookup(op_id_t id) const;
+        void store(op_id_t id, const op_ids &ids);
+
+      private:
+        llvm::DenseMap< op_id_t, std::pair< std::size_t, std::size_t > > ranges;
+        op_ids storage;
+    };
+
     // Generic interface to generalize the connection between any two modules.
     // There are no performance guarantees in general, but there should be implementations
     // available that try to be as performant as possible.
@@ -30,7 +63,14 @@ namespace vast::tw {
     {
         virtual ~link_interface() = default;
 
-        // These are not forced as `const` to allow runtime caching.
+        // Queries by provenance ids of operations, these do not need the modules
+        // to be materialized.
+        virtual op_ids children(op_id_t) = 0;
+        virtual op_ids parents(op_id_t)  = 0;
+
+        // These are not forced as `const` to allow runtime caching. Returned
+        // operations belong to modules of the storage, see `module_storage::module`
+        // for how long they stay valid.
         virtual operations children(operation)  = 0;
         virtual operations children(operations) = 0;
 
@@ -65,11 +105,20 @@ namespace vast::tw {
         handle_t _child;
         location_info_t &_location_info;
 
+        // Inverse of backlinks kept by `location_info`, built on the first query
+        // of children from the location info only.
+        std::optional< id_mapping > _to_children;
+
+        const id_mapping &to_children();
+
       public:
         explicit conversion_step(handle_t parent, handle_t child, location_info_t &location_info)
             : _parent(parent), _child(child), _location_info(location_info)
         {}
 
+        op_ids children(op_id_t) override;
+        op_ids parents(op_id_t) override;
+
         operations children(operation) override;
         operations children(operations) override;
 
@@ -88,20 +137,23 @@ namespace vast::tw {
 
     using conversion_steps = std::vector< conversion_step >;
 
-    // `A -> ... -> E` - each middle link is kept and there is pre-computed
-    // mapping for `A <-> E` transition to make it more performant.
+    // `A -> ... -> E` - each middle link is kept and `A <-> E` transitions are
+    // composed lazily for queried operations only. Results are memoized.
     struct fat_link : link_interface
     {
       protected:
         link_vector _links;
 
-        op_mapping _to_children;
-        op_mapping _to_parents;
+        id_memo _to_children;
+        id_memo _to_parents;
 
       public:
         explicit fat_link(link_vector links);
         fat_link() = delete;
 
+        op_ids children(op_id_t) override;
+        op_ids parents(op_id_t) override;
+
         operations children(operation) override;
         operations children(operations) override;
 
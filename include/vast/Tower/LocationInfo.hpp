@@ -5,64 +5,95 @@
 #include "vast/Util/Common.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <mlir/Pass/Pass.h>
 #include <mlir/Pass/PassManager.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Tower/Handle.hpp"
 
+#include <limits>
+#include <optional>
+#include <vector>
+
 namespace vast::tw {
 
-    // Is allowed to have state?
+    //
+    // Provenance of operations across tower levels.
+    //
+    // Each operation of a level is identified by a dense integer id, its index
+    // in the pre-order walk of the level's module. The id is carried by the
+    // operation location, so operations created by a pass inherit the id of the
+    // operation they were created from. Links between levels are kept in a side
+    // table, which maps ids of a level to the ids of the previous level.
+    //
+    // Locations carry nothing but the id, a single location is shared by all
+    // operations with the same id in any level. Locations the operations had
+    // before, i.e., their source locations and meta identifiers, are kept in
+    // the side table as well.
+    //
     struct location_info_t
     {
-      private:
-        // Encoded as `mlir::FusedLocation(original, mlir::OpaqueLocation(pointer_to_self))`
-        using raw_loc_t = mlir::FusedLoc;
+        using op_id_t = std::uint64_t;
+        using op_ids  = std::vector< op_id_t >;
+        using locs_t  = std::vector< loc_t >;
 
-        static raw_loc_t raw_loc(operation op) {
-            auto raw = mlir::dyn_cast< raw_loc_t >(op->getLoc());
-            VAST_CHECK(raw, "{0} with loc: {1}", *op, op->getLoc());
-            return raw;
-        }
+        static constexpr op_id_t no_parent = std::numeric_limits< op_id_t >::max();
 
-        template< std::size_t idx >
-            requires (idx < 2)
-        static loc_t get(raw_loc_t raw) {
-            auto locs = raw.getLocations();
-            VAST_ASSERT(locs.size() == 2);
-            return locs[idx];
-        }
+        // Ids of parents and source locations of operations of a level,
+        // indexed by the operation id.
+        struct level_locations
+        {
+            op_ids parents;
+            locs_t sources;
+        };
 
-        static auto parse(operation op) { return std::make_tuple(prev(op), self(op)); }
+        // Id of the operation within its level.
+        static op_id_t self(operation op);
 
-        // TODO: These are strictly not needed in this form, but help initial
-        //       debugging a lot.
-        std::string fingerprint(const conversion_path_t &);
-        loc_t mk_unique_loc(const conversion_path_t &, operation);
-        loc_t mk_linked_loc(loc_t self, loc_t prev);
+        // Id of the operation in the parent level, `no_parent` if the operation
+        // has no known origin.
+        op_id_t prev(handle_id_t level, operation op) const;
 
-      public:
-        // For the given operation return location to be used in this module.
-        loc_t get_as_child(const conversion_path_t &, operation op);
-        loc_t get_root(operation op);
+        bool are_tied(operation parent, handle_id_t child_level, operation child) const;
 
-        static loc_t self(raw_loc_t raw) { return get< 1 >(raw); }
+        // Ids of parents of all operations of `level` indexed by the operation
+        // id, `nullptr` if the level is not tied to a parent.
+        const op_ids *backlinks(handle_id_t level) const;
 
-        static loc_t prev(raw_loc_t raw) { return get< 0 >(raw); }
+        // Location the operation had in the root module of the tower or the
+        // one given to it by a pass, unknown for levels not recorded here.
+        loc_t source(handle_id_t level, operation op) const;
 
-        static loc_t self(operation op) { return self(raw_loc(op)); }
+        // Replaces locations of the root module by ids in a single walk.
+        // Returns the replaced locations indexed by the ids.
+        locs_t mk_root(operation root);
 
-        static loc_t prev(operation op) { return prev(raw_loc(op)); }
+        // Assigns fresh ids to all operations of a module derived from the
+        // level `parent` in a single walk.
+        level_locations transform_locations(handle_id_t parent, operation root);
 
-        static bool are_tied(operation parent, operation child);
-    };
+        void tie_root(handle_id_t level, locs_t sources);
+
+        // Records that `level` was derived from `parent` and that the operation
+        // with id `i` came from the operation `parents[i]` of the parent level.
+        void tie(handle_id_t parent, handle_id_t level, level_locations locs);
 
-    // Since we are going to tie together arbitrary modules, it makes sense to make them
-    // have locations in the same shape - therefore root shouldn't be an excuse. It will
-    // however require slightly different handling, so we are exposing a hook for that.
-    void mk_root(location_info_t &, operation);
+      private:
+        // Location that encodes `id`, created once per id.
+        loc_t id_loc(mcontext_t *mctx, op_id_t id);
+
+        struct level_t
+        {
+            std::optional< handle_id_t > parent;
+            op_ids parents;
+            locs_t sources;
+        };
 
-    void transform_locations(location_info_t &, const conversion_path_t &, operation);
+        const level_t *level(handle_id_t id) const;
+
+        llvm::DenseMap< handle_id_t, level_t > levels;
+        std::vector< mlir::LocationAttr > id_locs;
+    };
 
 } // namespace vast::tw
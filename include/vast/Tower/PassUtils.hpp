@@ -5,6 +5,7 @@
 #include "vast/Util/Common.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <mlir/Pass/PassManager.h>
 VAST_UNRELAX_WARNINGS
 
@@ -18,6 +19,38 @@ namespace vast::tw {
 
     std::string to_string(const conversion_passes_t &passes);
 
+    // Structural key of a pass instance. Two instances have the same key if they
+    // are of the same pass type and have the same options.
+    struct pass_key_t
+    {
+        mlir::TypeID type;
+        // Textual form of the pass with its options (and of nested pipelines
+        // for adaptors), compared in full to rule out hash collisions.
+        std::string pipeline;
+
+        bool operator==(const pass_key_t &) const = default;
+
+        struct hash
+        {
+            std::size_t operator()(const pass_key_t &key) const {
+                return llvm::hash_combine(key.type, key.pipeline);
+            }
+        };
+    };
+
+    pass_key_t pass_key(pass_ptr pass);
+
+    // Keys of pass instances, each instance is printed only once. Instances are
+    // identified by their address, so the memo must not outlive the pass manager
+    // that owns them.
+    struct pass_keys_t
+    {
+        const pass_key_t &operator()(pass_ptr pass);
+
+      private:
+        llvm::DenseMap< pass_ptr, pass_key_t > keys;
+    };
+
     // `mlir::PassManager` is really hard to move around, so we instead fill an existing
     // instance.
     void copy_passes(mlir::PassManager &pm, const conversion_passes_t &passes);
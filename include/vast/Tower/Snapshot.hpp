@@ -0,0 +1,93 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Hashing.h>
+VAST_UNRELAX_WARNINGS
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace vast::tw {
+
+    using fingerprint_t = llvm::hash_code;
+
+    // Structural hash of the operation and its regions. Locations are ignored,
+    // since the tower rewrites them after every pass, even for operations the
+    // pass did not touch.
+    fingerprint_t fingerprint(operation op);
+
+    // Same as above, in the same walk gathers locations of all nested operations
+    // in pre-order into `locations`.
+    fingerprint_t fingerprint(operation op, std::vector< loc_t > &locations);
+
+    // Approximate memory footprint of the operation and its regions. Uniqued
+    // types and attributes are owned by the context and not accounted.
+    std::size_t estimate_size(operation op);
+
+    // Body of a top-level module operation, detached from any module. Bodies
+    // are immutable and shared between snapshots of consecutive tower levels
+    // as long as the operation is not changed by a pass.
+    struct shared_body
+    {
+        explicit shared_body(operation op) : op(op) {}
+
+        mlir::OwningOpRef< operation > op;
+    };
+
+    using shared_body_ptr = std::shared_ptr< const shared_body >;
+
+    // Top-level operation as it looks on a given level: a possibly shared body
+    // together with the locations of all its nested operations in pre-order.
+    struct snapshot_entry
+    {
+        shared_body_ptr body;
+        std::vector< loc_t > locations;
+    };
+
+    //
+    // Snapshot of a module stored in the tower. Instead of a full clone after
+    // every pass, the snapshot keeps only bodies of the top-level operations
+    // that changed since the previous level and references the rest.
+    //
+    struct module_snapshot
+    {
+        // Takes snapshot of the live module `mod`. Bodies of the `prev`
+        // snapshot are reused for operations whose structure did not change.
+        // Returns `std::nullopt` if the module cannot be split into
+        // independent top-level operations.
+        static std::optional< module_snapshot > take(
+            mlir_module mod, const module_snapshot *prev
+        );
+
+        // Rebuilds the full module as it was when the snapshot was taken.
+        owning_mlir_module_ref materialize() const;
+
+        // Number of bodies owned by this snapshot, i.e. not shared with the
+        // previous level.
+        std::size_t owned_bodies() const { return owned; }
+
+        // Approximate memory held by the snapshot, shared bodies are accounted
+        // only to the snapshot that created them.
+        std::size_t bytes() const { return size_in_bytes; }
+
+      private:
+        module_snapshot() = default;
+
+        shared_body_ptr find(fingerprint_t fp, operation op) const;
+        void index(fingerprint_t fp, shared_body_ptr body);
+
+        mlir::OwningOpRef< mlir_module > skeleton;
+        std::vector< snapshot_entry > entries;
+
+        llvm::DenseMap< fingerprint_t, std::vector< shared_body_ptr > > bodies;
+        std::size_t owned = 0;
+        std::size_t size_in_bytes = 0;
+    };
+
+} // namespace vast::tw
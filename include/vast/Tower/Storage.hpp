@@ -5,15 +5,18 @@
 #include "vast/Util/Common.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <mlir/Pass/Pass.h>
 #include <mlir/Pass/PassManager.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Tower/Handle.hpp"
 #include "vast/Tower/PassUtils.hpp"
+#include "vast/Tower/Snapshot.hpp"
 
 #include <algorithm>
 #include <deque>
+#include <list>
 #include <numeric>
 #include <optional>
 #include <unordered_map>
@@ -46,25 +49,17 @@ namespace vast::tw {
 
         struct node
         {
-            // So `mlir::Pass` does not expose an api to query its options. However,
-            // it should print them when we ask for textual repr. So for now we do compare
-            // those strings.
-            // TODO: Some other unique key that is cheaper?
-            using pass_key_t = std::string;
-
             // The user is responsible for being able to retrive the module using this
             // piece of data..
             module_key_t module_key;
 
-            std::unordered_map< pass_key_t, node_key_t > next;
+            // Parent node and the edge that leads here, used to unlink the node.
+            maybe_node_key_t parent;
+            std::optional< pass_key_t > via;
 
-            explicit node(module_key_t key) : module_key(std::move(key)) {}
+            std::unordered_map< pass_key_t, node_key_t, pass_key_t::hash > next;
 
-            void add_edge(pass_key_t pass_name, node_key_t idx) {
-                next.emplace(std::move(pass_name), idx);
-            }
-
-            void add_edge(pass_ptr pass, node_key_t idx) { add_edge(to_string(pass), idx); }
+            explicit node(module_key_t key) : module_key(std::move(key)) {}
 
             maybe_node_key_t get_next(const pass_key_t &key) const {
                 if (auto it = next.find(key); it != next.end()) {
@@ -72,106 +67,153 @@ namespace vast::tw {
                 }
                 return std::nullopt;
             }
-
-            maybe_node_key_t get_next(pass_ptr pass) const { return get_next(to_string(pass)); }
         };
 
-        // Using a `std::vector` leads to a weird bug caught by asan even though we do not use
-        // pointers but indices instead.
-        std::deque< node > nodes;
-
       protected:
-        maybe_node_key_t lookup_node(handle_t handle) const {
-            auto it = std::ranges::find_if(nodes, [&](const node &n) {
-                return n.module_key == handle.id;
-            });
+        // Removed nodes leave an empty slot behind, so keys of the remaining
+        // nodes stay valid.
+        std::deque< std::optional< node > > nodes;
 
-            if (it != nodes.end()) {
-                return maybe_node_key_t { std::distance(nodes.begin(), it) };
+        // Index of nodes by the key of their module.
+        llvm::DenseMap< module_key_t, node_key_t > by_module;
+
+        maybe_node_key_t lookup_node(module_key_t key) const {
+            if (auto it = by_module.find(key); it != by_module.end()) {
+                return it->second;
             }
             return std::nullopt;
         }
 
-        node_key_t lookup(
-            conversion_passes_t &prefix, conversion_passes_t &suffix,
-            node_key_t root, auto on_visit
-        ) const {
-            if (suffix.empty()) {
-                return root;
-            }
+        // Follows `path` as far as possible.
+        auto lookup_prefix_(
+            conversion_passes_t path, node_key_t start_at, pass_keys_t &keys, auto on_visit
+        ) const -> std::tuple< node_key_t, conversion_passes_t > {
+            auto current = start_at;
+
+            std::size_t matched = 0;
+            for (; matched < path.size(); ++matched) {
+                auto next = nodes[current]->get_next(keys(path[matched]));
+                // There is no outgoing edge, so we stop.
+                if (!next) {
+                    break;
+                }
 
-            const auto &top = suffix.back();
+                if (matched == 0) {
+                    on_visit(nodes[current]->module_key);
+                }
 
-            auto maybe_next = nodes[root].get_next(top);
-            // There is no outgoing edge, so we stop.
-            if (!maybe_next) {
-                return root;
+                current = *next;
+                on_visit(nodes[current]->module_key);
             }
 
-            // Callback to current index
-            on_visit(root);
-
-            // We found a way forward, so we modify the paths and recurse
-            prefix.push_back(top);
-            suffix.pop_back();
-            return lookup(prefix, suffix, *maybe_next, on_visit);
-        }
-
-        auto lookup_prefix_(conversion_passes_t path, node_key_t start_at, auto on_visit) const
-            -> std::tuple< node_key_t, conversion_passes_t >
-        {
-            conversion_passes_t prefix;
-
-            // We will pop from front, so we reverse go get the cheaper `pop_back()`.
-            std::ranges::reverse(path);
-            auto last = lookup(prefix, path, start_at, on_visit);
-            std::ranges::reverse(path);
-
-            return std::make_tuple(last, std::move(path));
+            path.erase(path.begin(), path.begin() + static_cast< std::ptrdiff_t >(matched));
+            return std::make_tuple(current, std::move(path));
         }
 
         node_key_t mk_node(module_key_t key) {
-            nodes.emplace_back(std::move(key));
+            nodes.emplace_back(std::in_place, key);
+            by_module[key] = nodes.size() - 1;
             return nodes.size() - 1;
         }
 
       public:
         // Return key to the last module and the remainder of the path that needs to applied on
-        // it.
-        auto lookup_prefix(conversion_passes_t path, handle_t start_at_handle, auto on_visit)
-            const -> std::tuple< module_key_t, conversion_passes_t > {
-            auto maybe_start_idx = lookup_node(start_at_handle);
+        // it. `on_visit` is called with every module along the matched prefix, including
+        // the starting one, if at least one pass matched.
+        auto lookup_prefix(
+            conversion_passes_t path, handle_t start_at_handle, pass_keys_t &keys, auto on_visit
+        ) const -> std::tuple< module_key_t, conversion_passes_t > {
+            auto maybe_start_idx = lookup_node(start_at_handle.id);
             auto start_idx       = maybe_start_idx ? *maybe_start_idx : 0;
-            auto [idx, suffix]   = lookup_prefix_(std::move(path), start_idx, on_visit);
-            return std::make_tuple(nodes[idx].module_key, std::move(suffix));
+            auto [idx, suffix]   = lookup_prefix_(std::move(path), start_idx, keys, on_visit);
+            return std::make_tuple(nodes[idx]->module_key, std::move(suffix));
         }
 
-        auto lookup_prefix(conversion_passes_t path, handle_t start_at_handle) const {
-            return lookup_prefix(std::move(path), start_at_handle, [](auto) {});
+        auto lookup_prefix(
+            conversion_passes_t path, handle_t start_at_handle, pass_keys_t &keys
+        ) const {
+            return lookup_prefix(std::move(path), start_at_handle, keys, [](auto) {});
         }
 
         void store(const conversion_passes_t &path, module_key_t key) {
-            auto [last, suffix] = lookup_prefix_(path, 0, [](auto) {});
-
             // Root case
-            if (suffix.empty()) {
-                VAST_ASSERT(path.empty() && key == 0);
+            if (path.empty()) {
+                VAST_ASSERT(nodes.empty() && key == 0);
                 mk_node(key);
                 return;
             }
 
+            pass_keys_t keys;
+            auto [last, suffix] = lookup_prefix_(path, 0, keys, [](auto) {});
+
             // Currently each node has to have a module, so if a store is hapening, it is going
             // to create exactly one new edge.
             VAST_CHECK(
                 suffix.size() == 1,
                 "Trying to store module not exactly on edge, but: {0} away.", suffix.size()
             );
-            nodes[last].add_edge(suffix.front(), mk_node(key));
+            add_edge(last, keys(suffix.front()), key);
+        }
+
+        // Stores module `key` reached from the module `parent` by pass with `pass` key.
+        void store(module_key_t parent, const pass_key_t &pass, module_key_t key) {
+            auto from = lookup_node(parent);
+            VAST_CHECK(from, "Parent module is not present in the conversion tree.");
+            add_edge(*from, pass, key);
+        }
+
+        std::size_t size() const { return by_module.size(); }
+
+        bool present(module_key_t key) const { return lookup_node(key).has_value(); }
+
+        bool is_leaf(module_key_t key) const {
+            auto idx = lookup_node(key);
+            return idx && nodes[*idx]->next.empty();
         }
 
-        bool present(const conversion_passes_t &path) const {
-            auto [_, suffix] = lookup_prefix(path);
-            return suffix.empty();
+        bool is_root(module_key_t key) const {
+            auto idx = lookup_node(key);
+            return idx && !nodes[*idx]->parent;
+        }
+
+        // Removes the module together with all modules derived from it. Returns keys of
+        // all removed modules.
+        std::vector< module_key_t > remove(module_key_t key) {
+            auto idx = lookup_node(key);
+            if (!idx) {
+                return {};
+            }
+
+            if (auto &n = *nodes[*idx]; n.parent) {
+                nodes[*n.parent]->next.erase(*n.via);
+            }
+
+            std::vector< module_key_t > removed;
+            std::vector< node_key_t > todo = { *idx };
+            while (!todo.empty()) {
+                auto current = todo.back();
+                todo.pop_back();
+
+                for (const auto &[_, child] : nodes[current]->next) {
+                    todo.push_back(child);
+                }
+
+                removed.push_back(nodes[current]->module_key);
+                by_module.erase(nodes[current]->module_key);
+                nodes[current].reset();
+            }
+
+            return removed;
+        }
+
+      private:
+        void add_edge(node_key_t from, pass_key_t pass, module_key_t key) {
+            auto to = mk_node(key);
+            nodes[to]->parent = from;
+            nodes[to]->via    = pass;
+
+            auto [_, inserted] = nodes[from]->next.emplace(pass, to);
+            VAST_CHECK(inserted, "Conversion from the module by the pass is already stored.");
         }
     };
 
@@ -182,32 +224,44 @@ namespace vast::tw {
       protected:
         // TODO: API-wise, we probably want to accept any type that is `mlir::OwningOpRef< T >`?
         handle_t store_module(owning_mlir_module_ref mod) {
-            auto id      = next_id++;
-            auto [it, _] = storage.insert({ id, std::move(mod) });
-            return { id, it->second.get() };
+            auto id = next_id++;
+            account(id, estimate_size(mod->getOperation()));
+            modules.insert({ id, std::move(mod) });
+            return { id, module_ref(this, id) };
+        }
+
+        handle_t store_snapshot(module_snapshot snapshot) {
+            auto id = next_id++;
+            account(id, snapshot.bytes());
+            snapshots.emplace(id, std::move(snapshot));
+            return { id, module_ref(this, id) };
         }
 
         handle_t get(module_key_t module_key) const {
-            auto it = storage.find(module_key);
-            VAST_CHECK(it != storage.end(), "Required module not found in the storage!");
-            return { module_key, it->second.get() };
+            VAST_CHECK(
+                modules.count(module_key) || snapshots.count(module_key),
+                "Required module not found in the storage!"
+            );
+            touch(module_key);
+            return { module_key, module_ref(this, module_key) };
         }
 
       public:
         std::optional< handle_t > get(const conversion_passes_t &path, handle_t root) {
-            if (auto [module_key, suffix] = trie.lookup_prefix(path, root); suffix.empty()) {
+            pass_keys_t keys;
+            if (auto [module_key, suffix] = trie.lookup_prefix(path, root, keys); suffix.empty()) {
                 return { get(module_key) };
             }
             return std::nullopt;
         }
 
-        auto get_maximum_prefix_path(const conversion_passes_t &path, handle_t root) const
-            -> std::tuple< std::vector< handle_t >, conversion_passes_t >
-        {
+        auto get_maximum_prefix_path(
+            const conversion_passes_t &path, handle_t root, pass_keys_t &keys
+        ) const -> std::tuple< std::vector< handle_t >, conversion_passes_t > {
             std::vector< handle_t > handles;
             auto yield = [&](module_key_t module_key) { handles.push_back(get(module_key)); };
 
-            auto [_, suffix] = trie.lookup_prefix(path, root, yield);
+            auto [_, suffix] = trie.lookup_prefix(path, root, keys, yield);
             return std::make_tuple(std::move(handles), std::move(suffix));
         }
 
@@ -216,15 +270,106 @@ namespace vast::tw {
             auto handle = store_module(std::move(mod));
             // Now add it to the trie.
             trie.store(path, handle.id);
+            evict();
             return handle;
         }
 
-        // TODO: Does it even make sense to remove things explicitly by the user?
-        void remove(handle_t) { VAST_UNIMPLEMENTED; }
+        // Stores the state of the live module `mod` reached from `from` by
+        // `pass`. Unlike `store`, the module is not cloned as a whole, only
+        // top-level operations changed since `from` are copied.
+        handle_t snapshot(const pass_key_t &pass, mlir_module mod, handle_t from);
+
+        // Returns the stored module, rebuilds it from its snapshot if needed.
+        // Rebuilt modules are cached, but only up to the `materialized_limit`
+        // most recently used ones. The module, as well as its operations, stays
+        // valid until as many other modules are rebuilt or until a new module
+        // is stored.
+        mlir_module module(module_key_t module_key) const;
+
+        // Returns operation of the stored module by its provenance id. Operations
+        // are indexed by a single walk on the first lookup.
+        operation lookup(module_key_t module_key, std::uint64_t op_id) const;
+
+        // Removes the module and all modules derived from it. Handles and links
+        // referring to removed modules must not be used afterwards.
+        void remove(handle_t handle);
+
+        // Bounds memory held by stored modules. Once the limit is exceeded,
+        // materialized modules are dropped first, then least recently used
+        // modules without derived modules are removed. The root module and
+        // modules referenced by handles are never removed. Zero means no limit.
+        void set_memory_limit(std::size_t bytes) {
+            memory_limit = bytes;
+            evict();
+        }
+
+        void set_materialized_limit(std::size_t count) {
+            VAST_CHECK(count > 0, "At least one materialized module has to be kept.");
+            materialized_limit = count;
+            drop_materialized(materialized_limit);
+        }
+
+        std::size_t memory_usage() const { return used_bytes + materialized_bytes; }
+
+        std::size_t materialized_levels() const { return materialized.size(); }
+
+        // Number of stored modules, including the root.
+        std::size_t levels() const { return trie.size(); }
 
       private:
+        friend struct module_ref;
+
+        void pin(module_key_t module_key) const;
+        void unpin(module_key_t module_key) const;
+
+        void account(module_key_t module_key, std::size_t bytes) const;
+        void touch(module_key_t module_key) const;
+        void evict();
+
+        // Drops least recently used materialized modules, so that at most `keep`
+        // of them remain.
+        void drop_materialized(std::size_t keep) const;
+
         module_key_t next_id = 0;
-        llvm::DenseMap< handle_id_t, owning_mlir_module_ref > storage;
+
+        // Modules stored as a whole, i.e., the root and modules that cannot
+        // be snapshotted.
+        llvm::DenseMap< handle_id_t, owning_mlir_module_ref > modules;
+        std::unordered_map< handle_id_t, module_snapshot > snapshots;
+
+        // Modules rebuilt from snapshots, ordered from the most recently used.
+        // These can be dropped at any time, as they are rebuilt on the next access.
+        struct materialized_t
+        {
+            owning_mlir_module_ref mod;
+            std::list< module_key_t >::iterator position;
+            std::size_t bytes;
+        };
+
+        mutable llvm::DenseMap< handle_id_t, materialized_t > materialized;
+        mutable std::list< module_key_t > recently_materialized;
+        mutable std::size_t materialized_bytes = 0;
+        std::size_t materialized_limit = 4;
+
+        // Operations of modules indexed by their provenance ids.
+        mutable llvm::DenseMap< handle_id_t, std::vector< operation > > op_index;
+
         conversion_tree< module_key_t > trie;
+
+        // Stored modules ordered from the most recently used, together with
+        // their approximate size.
+        struct usage_t
+        {
+            std::list< module_key_t >::iterator position;
+            std::size_t bytes;
+        };
+
+        mutable std::list< module_key_t > recently_used;
+        mutable llvm::DenseMap< module_key_t, usage_t > usage;
+        mutable std::size_t used_bytes = 0;
+        std::size_t memory_limit = 0;
+
+        // Number of live references of modules.
+        mutable llvm::DenseMap< module_key_t, std::size_t > pins;
     };
 } // namespace vast::tw
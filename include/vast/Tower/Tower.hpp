@@ -27,19 +27,27 @@ namespace vast::tw {
 
       public:
         tower(mcontext_t &mctx, location_info_t &li, owning_mlir_module_ref root) : mctx(mctx) {
-            mk_root(li, root->getOperation());
+            auto sources = li.mk_root(root->getOperation());
             top_handle = storage.store(root_conversion(), std::move(root));
+            li.tie_root(top_handle.id, std::move(sources));
         }
 
       protected:
         // TODO: Move somewhere else.
         static conversion_passes_t root_conversion() { return {}; }
 
-        link_vector mk_full_path(handle_t, location_info_t &, mlir::PassManager &);
+        // `keys` may already contain keys of the passes of the pass manager.
+        link_vector
+        mk_full_path(handle_t, location_info_t &, mlir::PassManager &, pass_keys_t keys = {});
 
       public:
         handle_t top() const { return top_handle; }
 
+        const module_storage &stored() const { return storage; }
+
+        // See `module_storage::set_memory_limit`.
+        void set_memory_limit(std::size_t bytes) { storage.set_memory_limit(bytes); }
+
         link_ptr apply(handle_t, location_info_t &, mlir::PassManager &);
     };
 
@@ -5,6 +5,7 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
 #include <mlir/IR/DialectRegistry.h>
 #include <mlir/Pass/PassManager.h>
@@ -63,11 +64,17 @@ namespace vast {
             }
 
             seen.insert(id);
+            pass_steps[id] = step_scope;
+            scheduled.push_back(pass.get());
             VAST_PIPELINE_DEBUG("scheduling nested pass: {0}", pass->getArgument());
             auto &pm = this->nest< parent_t >();
             pm.addPass(std::move(pass));
         }
 
+        // Schedules the pass on each function of the module, functions are
+        // processed in parallel unless multithreading is disabled.
+        void addFunctionPass(owning_pass_ptr pass);
+
         virtual schedule_result schedule(pipeline_step_ptr step) = 0;
 
         void print_on_error(llvm::raw_ostream &os) {
@@ -81,7 +88,30 @@ namespace vast {
             );
         }
 
+        // Compound steps that are being scheduled, outermost first.
+        void enter_step(string_ref name) { step_scope.emplace_back(name); }
+        void exit_step() { step_scope.pop_back(); }
+
+        // Marks the end of a top-level step, i.e., a point of the pipeline
+        // where the module is in a consistent state between two steps.
+        void mark_stage() {
+            if (stage_ends.empty() || stage_ends.back() != scheduled.size()) {
+                stage_ends.push_back(scheduled.size());
+            }
+        }
+
         llvm::DenseSet< pass_id_t > seen;
+
+        // Compound steps that scheduled each of the passes, outermost first.
+        llvm::DenseMap< pass_id_t, std::vector< std::string > > pass_steps;
+
+        // Passes in order of scheduling and numbers of passes scheduled by
+        // the end of each of the marked stages.
+        std::vector< pass_ptr > scheduled;
+        std::vector< std::size_t > stage_ends;
+
+      private:
+        std::vector< std::string > step_scope;
     };
 
     using pipeline_step_builder = std::function< pipeline_step_ptr(void) >;
@@ -193,6 +223,21 @@ namespace vast {
         }
     };
 
+    //
+    // Pass running nested on functions of the module, the pass has to be
+    // op-agnostic and must not modify anything outside of the function.
+    //
+    struct function_pass_pipeline_step : pass_pipeline_step
+    {
+        explicit function_pass_pipeline_step(pass_builder_t builder)
+            : pass_pipeline_step(builder)
+        {}
+
+        virtual ~function_pass_pipeline_step() = default;
+
+        schedule_result schedule_on(pipeline_t &ppl) override;
+    };
+
     // compound step represents subpipeline to be run
     struct compound_pipeline_step : pipeline_step
     {
@@ -236,6 +281,13 @@ namespace vast {
         );
     }
 
+    template< typename... args_t >
+    decltype(auto) function_pass(args_t &&... args) {
+        return pipeline_step_init< function_pass_pipeline_step >(
+            std::forward< args_t >(args)...
+        );
+    }
+
     template< typename... steps_t >
     decltype(auto) compose(string_ref name, steps_t &&...steps) {
         return pipeline_step_init< compound_pipeline_step >(
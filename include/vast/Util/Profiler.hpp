@@ -0,0 +1,104 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/JSON.h>
+#include <mlir/Pass/PassInstrumentation.h>
+#include <mlir/Pass/Pass.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <chrono>
+#include <mutex>
+
+namespace vast::util {
+
+    //
+    // State of the process and of the processed IR at a single point in time.
+    //
+    struct profile_sample
+    {
+        using clock = std::chrono::steady_clock;
+
+        clock::time_point time;
+
+        std::size_t ops = 0;
+
+        // MLIR does not expose sizes of its attribute and type uniquers, the
+        // growth is approximated by distinct attributes and types used in IR.
+        std::size_t attributes = 0;
+        std::size_t types = 0;
+
+        // Peak resident set size of the process in kilobytes.
+        std::size_t peak_rss = 0;
+
+        // Samples the process and, if `op` is present, the IR nested in `op`.
+        static profile_sample take(operation op = nullptr);
+    };
+
+    struct profile_record
+    {
+        std::string name;
+        profile_sample before;
+        profile_sample after;
+
+        llvm::json::Value to_json() const;
+    };
+
+    //
+    // Profile of a single compilation: frontend phases, individual passes and
+    // compound pipeline steps. Passes may be recorded from multiple threads.
+    //
+    struct pipeline_profile
+    {
+        void record_phase(profile_record rec);
+        void record_pass(profile_record rec, const std::vector< std::string > &steps);
+
+        llvm::json::Value to_json() const;
+
+        // Writes the profile as JSON into the file at `path`.
+        void write(string_ref path) const;
+
+      private:
+        mutable std::mutex mutex;
+
+        std::vector< profile_record > phases;
+        std::vector< profile_record > passes;
+
+        // Compound steps span from the first to the last pass they scheduled.
+        std::vector< profile_record > steps;
+        llvm::StringMap< std::size_t > step_index;
+    };
+
+    //
+    // Records every pass scheduled by a pipeline into the profile. Passes are
+    // attributed to compound steps using `pass_steps` of the pipeline.
+    //
+    struct with_profile : mlir::PassInstrumentation
+    {
+        using pass_steps_t = llvm::DenseMap< mlir::TypeID, std::vector< std::string > >;
+
+        with_profile(pipeline_profile &profile, const pass_steps_t &pass_steps)
+            : profile(profile), pass_steps(pass_steps)
+        {}
+
+        void runBeforePass(pass_ptr pass, operation op) override;
+        void runAfterPass(pass_ptr pass, operation op) override;
+        void runAfterPassFailed(pass_ptr pass, operation op) override;
+
+      private:
+        pipeline_profile &profile;
+        const pass_steps_t &pass_steps;
+
+        // Nested passes may run on several operations in parallel.
+        std::mutex mutex;
+        llvm::DenseMap< std::pair< pass_ptr, operation >, profile_sample > running;
+    };
+
+} // namespace vast::util
@@ -5,30 +5,104 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/SetVector.h>
+#include <mlir/IR/OwningOpRef.h>
 #include <mlir/Pass/PassInstrumentation.h>
 #include <mlir/Pass/Pass.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 namespace vast::util {
 
+    enum class snapshot_format { text, bytecode, zstd };
+
+    std::optional< snapshot_format > parse_snapshot_format(string_ref format);
+
+    //
+    // Writes snapshots on a background thread, so the pipeline pays only for
+    // a clone of the IR. At most `capacity` snapshots wait in the queue,
+    // further snapshots block until the writer catches up, which bounds the
+    // memory held by the clones.
+    //
+    struct snapshot_writer
+    {
+        using owning_op_ref = mlir::OwningOpRef< operation >;
+
+        static constexpr std::size_t default_capacity = 4;
+
+        explicit snapshot_writer(snapshot_format format, std::size_t capacity = default_capacity);
+
+        // Waits for all queued snapshots to be written.
+        ~snapshot_writer();
+
+        void write(owning_op_ref op, std::string path);
+
+        // Writes the snapshot on the calling thread.
+        static void write_now(snapshot_format format, operation op, string_ref path);
+
+      private:
+        void run();
+
+        struct job
+        {
+            owning_op_ref op;
+            std::string path;
+        };
+
+        snapshot_format format;
+        std::size_t capacity;
+
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::deque< job > queue;
+        bool done = false;
+
+        std::thread worker;
+    };
+
     struct with_snapshots : mlir::PassInstrumentation
     {
         using output_stream_ptr = std::shared_ptr< llvm::raw_pwrite_stream >;
 
-        explicit with_snapshots(string_ref file_prefix) : file_prefix(file_prefix) {}
+        explicit with_snapshots(string_ref file_prefix, snapshot_format format = snapshot_format::text)
+            : file_prefix(file_prefix), format(format)
+        {}
 
         // We return `shared_ptr` in case we may want to keep the stream open
         // for longer in some derived class. Should not make a difference,
         // snapshoting will be expensive anyway.
         virtual output_stream_ptr make_output_stream(pass_ptr pass);
 
+        virtual std::string make_output_path(pass_ptr pass) const;
+
         virtual bool should_snapshot(pass_ptr pass) const = 0;
 
+        // Passes nested on parts of the module (e.g., functions) are
+        // snapshotted once the enclosing pass adaptor finishes, passes merged
+        // into the same adaptor hence show the module after all of them.
         void runAfterPass(pass_ptr pass, operation op) override;
 
         std::string file_prefix;
+        snapshot_format format;
+
+      private:
+        void snapshot(pass_ptr pass, operation op);
+
+        // Nested passes waiting for the whole module.
+        std::mutex mutex;
+        llvm::SetVector< pass_ptr > pending;
+
+        // Created on the first snapshot, if the context allows to access the
+        // IR from another thread.
+        std::unique_ptr< snapshot_writer > writer;
     };
 
 
@@ -13,6 +13,8 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/repl/common.hpp"
 
+#include "vast/Frontend/Options.hpp"
+
 #include <filesystem>
 
 #include "vast/Dialect/Core/CoreOps.hpp"
@@ -21,6 +23,8 @@ namespace vast::repl::codegen {
 
     std::unique_ptr< clang::ASTUnit > ast_from_source(string_ref source);
 
-    owning_mlir_module_ref emit_module(const std::filesystem::path &source, mcontext_t &ctx);
+    owning_mlir_module_ref emit_module(
+        const std::filesystem::path &source, mcontext_t &ctx, const cc::vast_args &vargs = {}
+    );
 
 } // namespace vast::repl::codegen
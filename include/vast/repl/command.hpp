@@ -65,6 +65,15 @@ namespace vast::repl
             throw_error("uknnown action kind: {0}", token.str());
         }
 
+        enum class tower_action { stats, limit };
+
+        template< typename enum_type >
+        enum_type from_string(string_ref token) requires(std::is_same_v< enum_type, tower_action >) {
+            if (token == "stats") return enum_type::stats;
+            if (token == "limit") return enum_type::limit;
+            throw_error("uknnown action kind: {0}", token.str());
+        }
+
         void analyze_reachable_code(state_t &);
         void analyze_uninitialized_variables(state_t &);
 
@@ -158,10 +167,12 @@ namespace vast::repl
         struct load : base {
             static constexpr string_ref name() { return "load"; }
 
-            static constexpr inline char source_param[] = "source";
+            static constexpr inline char source_param[]   = "source";
+            static constexpr inline char meta_ids_param[] = "locs-as-meta-ids";
 
             using command_params = util::type_list<
-                named_param< source_param, file_param >
+                named_param< source_param, file_param >,
+                named_param< meta_ids_param, flag_param >
             >;
 
             using params_storage = command_params::as_tuple;
@@ -272,6 +283,30 @@ namespace vast::repl
             params_storage params;
         };
 
+        //
+        // tower command
+        //
+        struct tower : base {
+            static constexpr string_ref name() { return "tower"; }
+
+            static constexpr inline char action_param[] = "tower_action";
+            static constexpr inline char bytes_param[]  = "bytes";
+
+            using command_params = util::type_list<
+                named_param< action_param, tower_action >,
+                named_param< bytes_param, integer_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            tower(const params_storage &params) : params(params) {}
+            tower(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
         struct sticky : base {
             static constexpr string_ref name() { return "sticky"; }
 
@@ -292,7 +327,9 @@ namespace vast::repl
 
         void add_sticky_command(string_ref cmd, state_t &state);
 
-        using command_list = util::type_list< exit, help, load, show, analyze, meta, raise, sticky >;
+        using command_list = util::type_list<
+            exit, help, load, show, analyze, meta, raise, tower, sticky
+        >;
 
     } // namespace cmd
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "vast/Dialect/Meta/MetaIdentifierIndex.hpp"
 #include "vast/Tower/Tower.hpp"
 #include "vast/repl/common.hpp"
 #include "vast/repl/command_base.hpp"
@@ -25,6 +26,11 @@ namespace vast::repl {
         //
         std::optional< std::filesystem::path > source;
 
+        //
+        // emit locations as meta identifiers
+        //
+        bool locs_as_meta_ids = false;
+
         //
         // mlir module and context
         //
@@ -53,8 +59,14 @@ namespace vast::repl {
         //
         bool verbose_pipeline = true;
 
+        //
+        // meta identifiers of the current module
+        //
+        std::optional< meta::identifier_index > meta_ids;
+
         void raise_tower(owning_mlir_module_ref mod);
         mlir_module current_module();
+        meta::identifier_index &current_meta_ids();
     };
 
 } // namespace vast::repl
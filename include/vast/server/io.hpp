@@ -2,12 +2,16 @@
 
 #pragma once
 
+#include <cerrno>
 #include <memory>
 #include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <stdio.h>
+#include <unistd.h>
 
 #include <gap/core/crtp.hpp>
 
@@ -22,6 +26,12 @@ namespace vast::server {
         connection_closed(const char *what) : std::runtime_error(what) {}
     };
 
+    class protocol_error : public std::runtime_error
+    {
+      public:
+        protocol_error(const char *what) : std::runtime_error(what) {}
+    };
+
     struct io_adapter
     {
         virtual ~io_adapter() = default;
@@ -31,6 +41,17 @@ namespace vast::server {
         virtual size_t read_some(std::span< char > dst)        = 0;
         virtual size_t write_some(std::span< const char > dst) = 0;
 
+        // Writes a prefix of the concatenation of `srcs`. Adapters able to
+        // gather buffers in a single call should override this.
+        virtual size_t writev_some(std::span< const std::span< const char > > srcs) {
+            for (auto src : srcs) {
+                if (!src.empty()) {
+                    return write_some(src);
+                }
+            }
+            return 0;
+        }
+
         // Upon completion, `dst` is filled with data.
         void read_all(std::span< char > dst) {
             while (!dst.empty()) {
@@ -47,6 +68,29 @@ namespace vast::server {
             }
         }
 
+        // Upon completion, all of the data in `srcs` is written to the client
+        // in order. Spans in `srcs` are consumed in the process.
+        void writev_all(std::span< std::span< const char > > srcs) {
+            while (true) {
+                while (!srcs.empty() && srcs.front().empty()) {
+                    srcs = srcs.subspan(1);
+                }
+
+                if (srcs.empty()) {
+                    return;
+                }
+
+                size_t nwritten = writev_some(srcs);
+                for (; nwritten >= srcs.front().size(); srcs = srcs.subspan(1)) {
+                    nwritten -= srcs.front().size();
+                    if (srcs.size() == 1) {
+                        return;
+                    }
+                }
+                srcs.front() = srcs.front().subspan(nwritten);
+            }
+        }
+
         char read() {
             char res[1];
             read_all(res);
@@ -54,6 +98,39 @@ namespace vast::server {
         }
     };
 
+    //
+    // Reads from an adapter in chunks as large as the free space of the
+    // buffer allows. Data is handed out as views into the buffer, which stay
+    // valid until the next read. Unconsumed data is moved to the front of the
+    // buffer when a request does not fit behind it, the buffer grows only for
+    // requests larger than its capacity.
+    //
+    class buffered_reader
+    {
+        io_adapter &adapter;
+        std::vector< char > buffer;
+
+        // Unconsumed data is in [head, tail).
+        size_t head = 0;
+        size_t tail = 0;
+
+        // Makes at least `size` unconsumed bytes available.
+        void fill(size_t size);
+
+      public:
+        static constexpr size_t default_capacity = 64 * 1024;
+
+        explicit buffered_reader(io_adapter &adapter, size_t capacity = default_capacity)
+            : adapter(adapter), buffer(capacity) {}
+
+        // Data up to and including the next `delim`. Throws `protocol_error`
+        // if the delimiter is not found within `max_size` bytes.
+        std::string_view read_until(char delim, size_t max_size);
+
+        // Next `size` bytes.
+        std::span< const char > read(size_t size);
+    };
+
     class file_adapter final : public io_adapter
     {
         FILE *ifd;
@@ -63,16 +140,21 @@ namespace vast::server {
         file_adapter(FILE *ifd = stdin, FILE *ofd = stdout) : ifd(ifd), ofd(ofd) {
             VAST_ASSERT(ifd != nullptr);
             VAST_ASSERT(ofd != nullptr);
-
-            setvbuf(ofd, NULL, _IONBF, 0);
         }
 
+        // Reads directly from the descriptor, as buffered `fread` blocks until
+        // the whole of `dst` is filled.
         size_t read_some(std::span< char > dst) override {
-            size_t nread = fread(dst.data(), 1, dst.size_bytes(), ifd);
-            if (nread == 0 && (feof(ifd) || ferror(ifd))) {
+            while (true) {
+                auto nread = ::read(fileno(ifd), dst.data(), dst.size_bytes());
+                if (nread > 0) {
+                    return static_cast< size_t >(nread);
+                }
+                if (nread < 0 && errno == EINTR) {
+                    continue;
+                }
                 throw connection_closed{};
             }
-            return nread;
         }
 
         size_t write_some(std::span< const char > src) override {
@@ -80,8 +162,26 @@ namespace vast::server {
             if (src.size() != 0 && nwritten == 0) {
                 throw connection_closed{};
             }
+            fflush(ofd);
             return nwritten;
         }
+
+        // Buffers are gathered by stdio and flushed at once.
+        size_t writev_some(std::span< const std::span< const char > > srcs) override {
+            size_t total = 0;
+            for (auto src : srcs) {
+                size_t nwritten = fwrite(src.data(), 1, src.size_bytes(), ofd);
+                total += nwritten;
+                if (nwritten != src.size()) {
+                    break;
+                }
+            }
+
+            if (fflush(ofd) != 0 || total == 0) {
+                throw connection_closed{};
+            }
+            return total;
+        }
     };
 
     class sock_adapter final : public io_adapter
@@ -91,6 +191,7 @@ namespace vast::server {
 
         size_t read_some(std::span< char > dst) override;
         size_t write_some(std::span< const char > src) override;
+        size_t writev_some(std::span< const std::span< const char > > srcs) override;
         ~sock_adapter();
         void close() override;
 
@@ -2,14 +2,24 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <limits>
+#include <memory>
 #include <mutex>
-#include <sstream>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "io.hpp"
 #include "sync_collections.hpp"
@@ -17,20 +27,46 @@
 #include "util.hpp"
 
 namespace vast::server {
-    class protocol_error : public std::runtime_error
+    enum JSONRPC_ERRORS {
+        JSONRPC_PARSE_ERROR       = -32700,
+        JSONRPC_INVALID_REQUEST   = -32600,
+        JSONRPC_METHOD_NOT_FOUND  = -32601,
+        JSONRPC_INVALID_PARAMS    = -32602,
+        JSONRPC_INTERNAL_ERROR    = -32603,
+        JSONRPC_REQUEST_CANCELLED = -32800,
+    };
+
+    //
+    // Cancellation state of a request received from the client, shared
+    // between the reader thread and the request thread handling it. Clients
+    // cancel requests by the `$/cancelRequest` notification. Requests
+    // cancelled before being dispatched are answered by an error, handlers
+    // taking a token can poll it to stop early.
+    //
+    class cancellation_token
     {
+        std::shared_ptr< std::atomic_bool > cancelled;
+
       public:
-        protocol_error(const char *what) : std::runtime_error(what) {}
-    };
+        cancellation_token() = default;
 
-    enum JSONRPC_ERRORS {
-        JSONRPC_PARSE_ERROR      = -32700,
-        JSONRPC_INVALID_REQUEST  = -32600,
-        JSONRPC_METHOD_NOT_FOUND = -32601,
-        JSONRPC_INVALID_PARAMS   = -32602,
-        JSONRPC_INTERNAL_ERROR   = -32603,
+        static cancellation_token create() {
+            cancellation_token token;
+            token.cancelled = std::make_shared< std::atomic_bool >(false);
+            return token;
+        }
+
+        void cancel() {
+            if (cancelled) {
+                *cancelled = true;
+            }
+        }
+
+        bool is_cancelled() const { return cancelled && *cancelled; }
     };
 
+    inline constexpr const char *cancel_request_method = "$/cancelRequest";
+
     template< request_like request >
     class ticket
     {
@@ -57,6 +93,7 @@ namespace vast::server {
             has_been_waited = other.has_been_waited;
 
             other.is_valid = false;
+            return *this;
         }
 
         ~ticket() {
@@ -158,7 +195,17 @@ namespace vast::server {
         [[nodiscard]] result_type< request > wait_request(ticket< request > ticket) {
             VAST_ASSERT(ticket.is_valid && !ticket.has_been_waited);
             ticket.has_been_waited = true;
-            json response          = wait_message(ticket.id);
+
+            json response;
+            try {
+                response = wait_message(ticket.id);
+            } catch (const execution_stopped &) {
+                // The connection is gone, the request will not be answered.
+                error< request > err{};
+                err.code    = JSONRPC_INTERNAL_ERROR;
+                err.message = "Connection closed";
+                return err;
+            }
 
             if (response.find("error") != response.end()) {
                 error< request > err = response["error"];
@@ -189,7 +236,10 @@ namespace vast::server {
         struct dispatch_handler<>
         {
             template< typename handler >
-            void operator()(handler &, server_base &server, const nlohmann::json &req) {
+            void operator()(
+                handler &, server_base &server, const nlohmann::json &req,
+                const cancellation_token &
+            ) {
                 nlohmann::json id = req.find("id") != req.end() ? req["id"] : nullptr;
                 server.send_error(JSONRPC_METHOD_NOT_FOUND, "Unsupported method", id);
             }
@@ -199,7 +249,10 @@ namespace vast::server {
         struct dispatch_handler< message_type, messages... >
         {
             template< typename handler >
-            void operator()(handler &h, server_base &server, const nlohmann::json &j) {
+            void operator()(
+                handler &h, server_base &server, const nlohmann::json &j,
+                const cancellation_token &token
+            ) {
                 if (j["method"] == message_type::method) {
                     if (j.find("id") == j.end()) {
                         server.send_error(
@@ -208,10 +261,31 @@ namespace vast::server {
                         return;
                     }
 
-                    server.send_result(j["id"], h(server, j["params"]));
+                    if (token.is_cancelled()) {
+                        server.send_error(JSONRPC_REQUEST_CANCELLED, "Request cancelled", j["id"]);
+                        return;
+                    }
+
+                    auto result = [&] {
+                        if constexpr (std::is_invocable_v<
+                                          handler &, server_base &, const message_type &,
+                                          const cancellation_token & >)
+                        {
+                            return h(server, j["params"].template get< message_type >(), token);
+                        } else {
+                            return h(server, j["params"]);
+                        }
+                    }();
+
+                    // Cancelled while the handler ran, its result is stale.
+                    if (token.is_cancelled()) {
+                        server.send_error(JSONRPC_REQUEST_CANCELLED, "Request cancelled", j["id"]);
+                    } else {
+                        server.send_result< message_type >(j["id"], result);
+                    }
                 } else {
                     dispatch_handler< messages... > dispatcher;
-                    return dispatcher(h, server, j);
+                    return dispatcher(h, server, j, token);
                 }
             }
         };
@@ -220,7 +294,10 @@ namespace vast::server {
         struct dispatch_handler< message_type, messages... >
         {
             template< typename handler >
-            void operator()(handler &h, server_base &server, const nlohmann::json &j) {
+            void operator()(
+                handler &h, server_base &server, const nlohmann::json &j,
+                const cancellation_token &token
+            ) {
                 if (j["method"] == message_type::method) {
                     if (j.find("id") != j.end()) {
                         server.send_error(
@@ -232,77 +309,51 @@ namespace vast::server {
                     h(server, j["params"]);
                 } else {
                     dispatch_handler< messages... > dispatcher;
-                    return dispatcher(h, server, j);
+                    return dispatcher(h, server, j, token);
                 }
             }
         };
     } // namespace detail
 
+    //
+    // JSON-RPC server framing messages by `Content-Length` headers. A reader
+    // thread parses incoming messages straight from its input buffer,
+    // responses to our requests are handed to their waiters and requests
+    // from the client are processed by a pool of `num_request_threads`
+    // request threads.
+    //
     template< typename message_handler, message_like... message_types >
     class server final : public server_base
     {
+        struct pending_request
+        {
+            json message;
+            cancellation_token token;
+        };
+
+        // Headers are expected to be short, see the LSP base protocol.
+        static constexpr size_t max_header_size = 4096;
+
         std::mutex write_mutex;
-        std::thread reader_thread;
-        std::vector< std::thread > request_threads;
 
         std::unique_ptr< io_adapter > adapter;
+        buffered_reader reader;
 
         message_handler handler;
 
         sync_map< size_t, json > responses;
-        sync_queue< json > requests;
-
-        void read_lit(char lit) {
-            if (adapter->read() != lit) {
-                throw protocol_error("Invalid literal");
-            }
-        }
-
-        std::pair< std::string, std::string > read_header() {
-            std::stringstream header_name;
-            std::stringstream header_value;
-            do {
-                char c = adapter->read();
-                if (c == '\r') {
-                    break;
-                }
-
-                for (; c != ':'; c = adapter->read()) {
-                    header_name << c;
-                }
-
-                // Skip whitespace between : and header value
-                do {
-                    c = adapter->read();
-                } while (c == ' ' || c == '\t');
-
-                for (; c != '\r'; c = adapter->read()) {
-                    header_value << c;
-                }
-            } while (false);
-            read_lit('\n');
-            return std::make_pair(header_name.str(), header_value.str());
-        }
-
-        size_t read_headers() {
-            std::unordered_map< std::string, std::string, ci_hash<>, ci_comparison<> > headers;
+        sync_queue< pending_request > requests;
 
-            while (true) {
-                auto [name, value] = read_header();
-                if (name == "") {
-                    break;
-                }
-
-                headers[name] = value;
-            }
+        // Tokens of requests not yet answered, keyed by serialized id.
+        std::mutex cancellation_mutex;
+        std::unordered_map< std::string, cancellation_token > cancellations;
 
-            auto content_length = headers.find("content-length");
-            if (content_length == headers.end()) {
-                throw protocol_error{ "Missing Content-Length header" };
-            }
+        std::thread reader_thread;
+        std::vector< std::thread > request_threads;
 
+        static size_t parse_content_length(std::string_view value) {
             size_t size = 0;
-            for (char c : content_length->second) {
+            for (char c : value) {
                 if (c < '0' || c > '9') {
                     throw protocol_error{ "Invalid Content-Length value" };
                 }
@@ -320,12 +371,73 @@ namespace vast::server {
             return size;
         }
 
+        // Header line without the terminating CRLF.
+        std::string_view read_header_line() {
+            auto line = reader.read_until('\n', max_header_size);
+            if (!line.ends_with("\r\n")) {
+                throw protocol_error("Invalid literal");
+            }
+            line.remove_suffix(2);
+            return line;
+        }
+
+        size_t read_headers() {
+            std::optional< size_t > content_length;
+
+            for (auto line = read_header_line(); !line.empty(); line = read_header_line()) {
+                auto colon = line.find(':');
+                if (colon == std::string_view::npos) {
+                    throw protocol_error{ "Invalid header" };
+                }
+
+                auto name  = line.substr(0, colon);
+                auto value = line.substr(colon + 1);
+                // Skip whitespace between : and header value
+                value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+
+                if (ci_equal(name, "content-length")) {
+                    content_length = parse_content_length(value);
+                }
+            }
+
+            if (!content_length) {
+                throw protocol_error{ "Missing Content-Length header" };
+            }
+
+            return *content_length;
+        }
+
         json receive_message() {
             auto body_size = read_headers();
-            std::string body;
-            body.resize(body_size);
-            adapter->read_all(body);
-            return json::parse(body);
+            auto body      = reader.read(body_size);
+            return json::parse(body.data(), body.data() + body.size());
+        }
+
+        static std::string cancellation_key(const json &id) { return id.dump(); }
+
+        void enqueue_request(const json &msg) {
+            auto token = cancellation_token::create();
+            {
+                std::lock_guard< std::mutex > lock(cancellation_mutex);
+                cancellations[cancellation_key(msg["id"])] = token;
+            }
+            requests.enqueue(pending_request{ msg, token });
+        }
+
+        void cancel_request(const json &id) {
+            std::lock_guard< std::mutex > lock(cancellation_mutex);
+            if (auto it = cancellations.find(cancellation_key(id)); it != cancellations.end()) {
+                it->second.cancel();
+            }
+        }
+
+        void finish_request(const json &msg) {
+            if (msg.find("id") == msg.end()) {
+                return;
+            }
+
+            std::lock_guard< std::mutex > lock(cancellation_mutex);
+            cancellations.erase(cancellation_key(msg["id"]));
         }
 
         void receive_msg_with_id(const json &msg) {
@@ -333,7 +445,7 @@ namespace vast::server {
             json id = msg["id"];
 
             if (msg.find("method") != msg.end() && msg.find("params") != msg.end()) {
-                requests.enqueue(msg);
+                enqueue_request(msg);
             } else if (msg.find("result") != msg.end() || msg.find("error") != msg.end()) {
                 if (id == nullptr) {
                     VAST_FATAL("JSONRPC Error: {0}", msg.dump(2));
@@ -344,28 +456,48 @@ namespace vast::server {
             }
         }
 
+        void receive_notification(const json &msg) {
+            // Cancellation is handled right away, as request threads might
+            // all be busy.
+            if (msg["method"] == cancel_request_method) {
+                if (const auto &params = msg["params"]; params.contains("id")) {
+                    cancel_request(params["id"]);
+                }
+            } else {
+                requests.enqueue(pending_request{ msg, {} });
+            }
+        }
+
+        void receive(const json &msg) {
+            if (msg.find("id") != msg.end()) {
+                receive_msg_with_id(msg);
+            } else if (msg.find("method") != msg.end() && msg.find("params") != msg.end()) {
+                receive_notification(msg);
+            } else {
+                send_error(JSONRPC_INVALID_REQUEST, "Invalid request", nullptr);
+            }
+        }
+
         void reader_thread_routine() {
             try {
                 while (true) {
-                    json msg = receive_message();
-
-                    if (msg.find("id") != msg.end()) {
-                        receive_msg_with_id(msg);
-                    } else if (msg.find("method") != msg.end()
-                               && msg.find("params") != msg.end())
-                    {
-                        // Message is a notification
-                        requests.enqueue(msg);
-                    } else {
-                        send_error(JSONRPC_INVALID_REQUEST, "Invalid request", nullptr);
+                    // A malformed body is consumed whole, so the framing of
+                    // the following messages is intact.
+                    try {
+                        receive(receive_message());
+                    } catch (const json::parse_error &err) {
+                        send_error(JSONRPC_PARSE_ERROR, err.what(), nullptr);
                     }
                 }
             } catch (const execution_stopped &) {
             } catch (const connection_closed &) {
                 responses.stop();
                 requests.stop();
-            } catch (const json::parse_error &err) {
+            } catch (const protocol_error &err) {
+                // Message boundaries are lost, nothing more can be read.
                 send_error(JSONRPC_PARSE_ERROR, err.what(), nullptr);
+                responses.stop();
+                requests.stop();
             }
         }
 
@@ -374,26 +506,50 @@ namespace vast::server {
                 detail::dispatch_handler< message_types... > dispatcher;
                 while (true) {
                     auto req = requests.dequeue();
-                    dispatcher(this->handler, *this, req);
+                    try {
+                        dispatcher(this->handler, *this, req.message, req.token);
+                    } catch (...) {
+                        finish_request(req.message);
+                        throw;
+                    }
+                    finish_request(req.message);
                 }
-            } catch (const execution_stopped &stop) {
+            } catch (const execution_stopped &) {
+            } catch (const connection_closed &) {
+                // The reader thread stops the queues once it sees the
+                // connection closed as well.
             }
         }
 
+        static std::string_view format_header(std::span< char > dst, size_t content_length) {
+            constexpr std::string_view prefix =
+                "Content-Type: application/json;charset=utf-8\r\nContent-Length: ";
+            constexpr std::string_view suffix = "\r\n\r\n";
+
+            auto out = std::copy(prefix.begin(), prefix.end(), dst.begin());
+            auto [end, ec] = std::to_chars(&*out, dst.data() + dst.size(), content_length);
+            VAST_ASSERT(ec == std::errc());
+            end = std::copy(suffix.begin(), suffix.end(), end);
+
+            return { dst.data(), static_cast< size_t >(end - dst.data()) };
+        }
+
       protected:
         virtual void send_message(const json &j) override {
-            std::unique_lock< std::mutex > lock(write_mutex);
             // The final \r\n is not necessary, but makes things easier to
             // read when debugging from communication dumps
-            std::string data = j.dump() + "\r\n";
+            constexpr std::string_view crlf = "\r\n";
+
+            std::string body = j.dump();
 
-            std::stringstream ss;
-            ss << "Content-Type: application/json;charset=utf-8\r\n";
-            ss << "Content-Length: " << data.size() << "\r\n\r\n";
-            ss << data;
+            std::array< char, 128 > header_buffer;
+            auto header = format_header(header_buffer, body.size() + crlf.size());
 
-            std::string res = ss.str();
-            adapter->write_all(res);
+            // Header and body are written without joining them.
+            std::array< std::span< const char >, 3 > frame = { header, body, crlf };
+
+            std::unique_lock< std::mutex > lock(write_mutex);
+            adapter->writev_all(frame);
         }
 
         virtual json wait_message(size_t id) override { return responses.get(id); }
@@ -403,9 +559,13 @@ namespace vast::server {
             std::unique_ptr< io_adapter > adapter, int num_request_threads = 1,
             const message_handler &handler = {}
         )
-            : reader_thread(&server::reader_thread_routine, this)
-            , adapter(std::move(adapter))
+            : adapter(std::move(adapter))
+            , reader(*this->adapter)
             , handler(handler) {
+            VAST_ASSERT(num_request_threads > 0);
+
+            // Threads are started once all members they use are initialized.
+            reader_thread = std::thread(&server::reader_thread_routine, this);
             for (int i = 0; i < num_request_threads; ++i) {
                 request_threads.emplace_back(&server::request_thread_routine, this);
             }
@@ -46,12 +46,12 @@ namespace vast::server {
             std::unique_lock< std::mutex > lock(mutex);
             cv.wait(lock, [k, this]() { return data.find(k) != data.end() || stopped; });
 
-            if (stopped) {
+            // Values inserted before the stop are still handed out.
+            auto it = data.find(k);
+            if (it == data.end()) {
                 throw execution_stopped("User requested stop");
             }
 
-            auto it = data.find(k);
-            VAST_ASSERT(it != data.end());
             auto response = it->second;
             data.erase(it);
             return response;
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cctype>
 #include <string>
+#include <string_view>
 
 namespace vast::server {
     template< typename Hash = std::hash< std::string > >
@@ -46,4 +47,11 @@ namespace vast::server {
             return comp(a_lower, b_lower);
         }
     };
+
+    inline bool ci_equal(std::string_view a, std::string_view b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return std::tolower(static_cast< unsigned char >(x))
+                == std::tolower(static_cast< unsigned char >(y));
+        });
+    }
 } // namespace vast::server
@@ -0,0 +1,131 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/Dataflow/Dataflow.hpp"
+
+#include <functional>
+#include <queue>
+
+namespace vast::dataflow {
+
+    bitvector_problem::bitvector_problem(
+        const flow_graph &graph, unsigned width, direction dir, confluence meet
+    )
+        : graph(graph), dir(dir), meet(meet)
+        , boundary(width)
+        , initial(width, meet == confluence::all)
+        , gen(graph.size(), llvm::BitVector(width))
+        , kill(graph.size(), llvm::BitVector(width))
+    {}
+
+    bitvector_solution solve(const bitvector_problem &problem, const llvm::BitVector *live) {
+        const auto &graph = problem.graph;
+        const auto forward = problem.dir == direction::forward;
+        const auto start   = forward ? flow_graph::entry : flow_graph::exit;
+        const auto size    = unsigned(graph.size());
+
+        auto is_live = [&] (node_id id) { return !live || live->test(id); };
+
+        auto sources = [&] (node_id id) -> llvm::ArrayRef< node_id > {
+            return forward ? graph.node(id).preds : graph.node(id).succs;
+        };
+
+        auto targets = [&] (node_id id) -> llvm::ArrayRef< node_id > {
+            return forward ? graph.node(id).succs : graph.node(id).preds;
+        };
+
+        // Forward problems visit nodes in reverse post-order, backward
+        // problems in post-order, so that most sources are final before
+        // their targets are visited.
+        auto priority = [&] (node_id id) {
+            auto pos = graph.position(id);
+            return forward ? pos : size - 1 - pos;
+        };
+
+        auto node_at = [&] (unsigned prio) {
+            return graph.order()[forward ? prio : size - 1 - prio];
+        };
+
+        bitvector_solution solution;
+        solution.in.assign(size, problem.initial);
+        solution.out.assign(size, problem.initial);
+
+        std::priority_queue< unsigned, std::vector< unsigned >, std::greater<> > worklist;
+        llvm::BitVector pending(size);
+
+        auto enqueue = [&] (node_id id) {
+            if (is_live(id) && !pending.test(id)) {
+                pending.set(id);
+                worklist.push(priority(id));
+            }
+        };
+
+        auto meet_into = [&] (llvm::BitVector &in, node_id id) {
+            bool first = true;
+            for (auto src : sources(id)) {
+                if (!is_live(src)) {
+                    continue;
+                }
+
+                const auto &facts = solution.out[src];
+                if (first) {
+                    in = facts;
+                    first = false;
+                } else if (problem.meet == confluence::any) {
+                    in |= facts;
+                } else {
+                    in &= facts;
+                }
+            }
+
+            if (first) {
+                in = problem.initial;
+            }
+        };
+
+        for (auto id : graph.order()) {
+            enqueue(id);
+        }
+
+        llvm::BitVector out;
+        while (!worklist.empty()) {
+            auto id = node_at(worklist.top());
+            worklist.pop();
+            pending.reset(id);
+
+            auto &in = solution.in[id];
+            if (id == start) {
+                in = problem.boundary;
+            } else {
+                meet_into(in, id);
+            }
+
+            out = in;
+            out.reset(problem.kill[id]);
+            out |= problem.gen[id];
+
+            if (out != solution.out[id]) {
+                std::swap(solution.out[id], out);
+                for (auto tgt : targets(id)) {
+                    enqueue(tgt);
+                }
+            }
+        }
+
+        return solution;
+    }
+
+    std::vector< core::function_op_interface > functions_with_body(operation root) {
+        std::vector< core::function_op_interface > fns;
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            if (auto fn = mlir::dyn_cast< core::function_op_interface >(op)) {
+                if (!fn.getFunctionBody().empty()) {
+                    fns.push_back(fn);
+                }
+                return walk_result::skip();
+            }
+            return walk_result::advance();
+        });
+        return fns;
+    }
+
+} // namespace vast::dataflow
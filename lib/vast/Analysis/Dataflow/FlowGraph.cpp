@@ -0,0 +1,552 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/Dataflow/FlowGraph.hpp"
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+#include <optional>
+
+namespace vast::dataflow {
+
+    namespace {
+
+        // Value of a condition region yielding a literal, possibly wrapped in
+        // implicit casts.
+        std::optional< bool > constant_condition(region_t &region) {
+            if (region.empty() || region.back().empty()) {
+                return std::nullopt;
+            }
+
+            auto yield = mlir::dyn_cast< hl::CondYieldOp >(region.back().back());
+            if (!yield) {
+                return std::nullopt;
+            }
+
+            auto value = yield.getResult();
+            while (auto cast = value.getDefiningOp< hl::ImplicitCastOp >()) {
+                value = cast.getValue();
+            }
+
+            auto constant = value.getDefiningOp< hl::ConstantOp >();
+            if (!constant) {
+                return std::nullopt;
+            }
+
+            auto attr = constant.getValue();
+            if (auto flag = mlir::dyn_cast< core::BooleanAttr >(attr)) {
+                return flag.getValue();
+            }
+            if (auto integer = mlir::dyn_cast< core::IntegerAttr >(attr)) {
+                return !integer.getValue().isZero();
+            }
+            return std::nullopt;
+        }
+
+        //
+        // Builds the graph in a single recursive walk of the function body.
+        // `current` is the node the next operation is appended to. Jumps
+        // leave `current` in a fresh node without predecessors, so that
+        // code following them ends up unreachable.
+        //
+        struct flow_graph_builder
+        {
+            explicit flow_graph_builder(std::vector< flow_node > &nodes) : nodes(nodes) {
+                fresh(); // entry
+                fresh(); // exit
+            }
+
+            void build(region_t &body) {
+                current = flow_graph::entry;
+                visit(body);
+                edge(current, flow_graph::exit);
+
+                // Any label can be a target of an indirect jump.
+                for (auto from : indirect_gotos) {
+                    for (auto to : label_order) {
+                        edge(from, to);
+                    }
+                }
+            }
+
+          private:
+            struct loop_targets
+            {
+                node_id break_target;
+                std::optional< node_id > continue_target;
+            };
+
+            struct scope_targets
+            {
+                node_id entry;
+                node_id after;
+            };
+
+            node_id fresh() {
+                nodes.emplace_back();
+                return node_id(nodes.size() - 1);
+            }
+
+            void edge(node_id from, node_id to) {
+                auto &succs = nodes[from].succs;
+                if (llvm::is_contained(succs, to)) {
+                    return;
+                }
+                succs.push_back(to);
+                nodes[to].preds.push_back(from);
+            }
+
+            // Edge of a branch taken if the condition evaluates to `taken`.
+            void branch(node_id from, node_id to, std::optional< bool > cond, bool taken) {
+                if (!cond || *cond == taken) {
+                    edge(from, to);
+                }
+            }
+
+            void append(operation op) { nodes[current].ops.push_back(op); }
+
+            void jump(node_id to) {
+                edge(current, to);
+                current = fresh();
+            }
+
+            node_id block_node(block_ptr block) {
+                auto [it, inserted] = block_nodes.try_emplace(block, 0);
+                if (inserted) {
+                    it->second = fresh();
+                }
+                return it->second;
+            }
+
+            node_id label_node(mlir_value label) {
+                auto [it, inserted] = labels.try_emplace(label, 0);
+                if (inserted) {
+                    it->second = fresh();
+                    label_order.push_back(it->second);
+                }
+                return it->second;
+            }
+
+            void visit(region_t &region) {
+                if (region.empty()) {
+                    return;
+                }
+
+                // Structured regions are spliced into the current node, unless
+                // their block is a target of a jump.
+                if (region.hasOneBlock() && !block_nodes.count(&region.front())) {
+                    return visit(region.front());
+                }
+
+                auto after = fresh();
+                edge(current, block_node(&region.front()));
+                for (auto &block : region) {
+                    current = block_node(&block);
+                    visit(block);
+                    edge(current, after);
+                }
+                current = after;
+            }
+
+            void visit(block_t &block) {
+                for (auto &op : block) {
+                    visit(&op);
+                }
+            }
+
+            void visit(operation op) {
+                if (core::is_return_like(op)) {
+                    append(op);
+                    return jump(flow_graph::exit);
+                }
+
+                llvm::TypeSwitch< operation >(op)
+                    .Case<
+                        hl::IfOp, hl::WhileOp, hl::ForOp, hl::DoOp,
+                        hl::SwitchOp, hl::CaseOp, hl::DefaultOp,
+                        hl::BreakOp, hl::ContinueOp,
+                        hl::LabelStmt, hl::GotoStmt, hl::IndirectGotoStmt,
+                        hl::CondOp, hl::BinaryCondOp, hl::BinLAndOp, hl::BinLOrOp,
+                        hl::VarDeclOp,
+                        ll::Scope, ll::ScopeRet, ll::ScopeRecurse, ll::CondScopeRet
+                    >([&] (auto op) { visit(op); })
+                    .Case<
+                        hl::SizeOfExprOp, hl::AlignOfExprOp, hl::PreferredAlignOfExprOp,
+                        hl::TypeOfExprOp
+                    >([&] (auto op) {
+                        // Unevaluated operands.
+                        append(op);
+                    })
+                    .Default([&] (operation op) { visit_default(op); });
+            }
+
+            void visit_default(operation op) {
+                append(op);
+                for (auto &region : op->getRegions()) {
+                    visit(region);
+                }
+
+                if (op->getNumSuccessors() != 0) {
+                    for (auto succ : op->getSuccessors()) {
+                        edge(current, block_node(succ));
+                    }
+                    current = fresh();
+                }
+            }
+
+            void visit(hl::VarDeclOp op) {
+                // The variable is defined once its initializer is evaluated.
+                for (auto &region : op->getRegions()) {
+                    visit(region);
+                }
+                append(op);
+            }
+
+            void visit(hl::IfOp op) {
+                append(op);
+                visit(op.getCondRegion());
+                auto cond = constant_condition(op.getCondRegion());
+                auto head = current;
+                auto after = fresh();
+
+                current = fresh();
+                branch(head, current, cond, true);
+                visit(op.getThenRegion());
+                edge(current, after);
+
+                if (op.hasElse()) {
+                    current = fresh();
+                    branch(head, current, cond, false);
+                    visit(op.getElseRegion());
+                    edge(current, after);
+                } else {
+                    branch(head, after, cond, false);
+                }
+
+                current = after;
+            }
+
+            void visit(hl::WhileOp op) {
+                append(op);
+                auto header = fresh();
+                edge(current, header);
+
+                current = header;
+                visit(op.getCondRegion());
+                auto cond = constant_condition(op.getCondRegion());
+                auto head = current;
+                auto after = fresh();
+                branch(head, after, cond, false);
+
+                current = fresh();
+                branch(head, current, cond, true);
+                loops.push_back({ after, header });
+                visit(op.getBodyRegion());
+                loops.pop_back();
+                edge(current, header);
+
+                current = after;
+            }
+
+            void visit(hl::ForOp op) {
+                append(op);
+                auto header = fresh();
+                edge(current, header);
+
+                current = header;
+                visit(op.getCondRegion());
+                auto cond = op.getCondRegion().empty()
+                    ? std::optional< bool >(true)
+                    : constant_condition(op.getCondRegion());
+                auto head = current;
+                auto after = fresh();
+                auto incr = fresh();
+                branch(head, after, cond, false);
+
+                current = fresh();
+                branch(head, current, cond, true);
+                loops.push_back({ after, incr });
+                visit(op.getBodyRegion());
+                loops.pop_back();
+                edge(current, incr);
+
+                current = incr;
+                visit(op.getIncrRegion());
+                edge(current, header);
+
+                current = after;
+            }
+
+            void visit(hl::DoOp op) {
+                append(op);
+                auto body = fresh();
+                auto latch = fresh();
+                auto after = fresh();
+                edge(current, body);
+
+                current = body;
+                loops.push_back({ after, latch });
+                visit(op.getBodyRegion());
+                loops.pop_back();
+                edge(current, latch);
+
+                current = latch;
+                visit(op.getCondRegion());
+                auto cond = constant_condition(op.getCondRegion());
+                branch(current, body, cond, true);
+                branch(current, after, cond, false);
+
+                current = after;
+            }
+
+            void visit(hl::SwitchOp op) {
+                append(op);
+                visit(op.getCondRegion());
+                auto after = fresh();
+
+                switches.push_back({ current, false });
+                loops.push_back({ after, std::nullopt });
+
+                // Statements preceding the first label are skipped.
+                current = fresh();
+                for (auto &region : op.getCases()) {
+                    visit(region);
+                }
+                edge(current, after);
+
+                loops.pop_back();
+                auto [head, has_default] = switches.pop_back_val();
+                if (!has_default) {
+                    edge(head, after);
+                }
+
+                current = after;
+            }
+
+            // Cases fall through from the preceding statement.
+            void enter_case() {
+                VAST_CHECK(!switches.empty(), "case label outside of a switch");
+                auto entry = fresh();
+                edge(switches.back().head, entry);
+                edge(current, entry);
+                current = entry;
+            }
+
+            void visit(hl::CaseOp op) {
+                enter_case();
+                append(op);
+                visit(op.getLhs());
+                visit(op.getBody());
+            }
+
+            void visit(hl::DefaultOp op) {
+                enter_case();
+                switches.back().has_default = true;
+                append(op);
+                visit(op.getBody());
+            }
+
+            void visit(hl::BreakOp op) {
+                append(op);
+                VAST_CHECK(!loops.empty(), "break outside of a loop or a switch");
+                jump(loops.back().break_target);
+            }
+
+            void visit(hl::ContinueOp op) {
+                append(op);
+                auto loop = llvm::find_if(llvm::reverse(loops), [] (const auto &targets) {
+                    return targets.continue_target.has_value();
+                });
+                VAST_CHECK(loop != loops.rend(), "continue outside of a loop");
+                jump(*loop->continue_target);
+            }
+
+            void visit(hl::LabelStmt op) {
+                auto label = label_node(op.getLabel());
+                edge(current, label);
+                current = label;
+                append(op);
+                visit(op.getBody());
+            }
+
+            void visit(hl::GotoStmt op) {
+                append(op);
+                jump(label_node(op.getLabel()));
+            }
+
+            void visit(hl::IndirectGotoStmt op) {
+                append(op);
+                visit(op.getTarget());
+                indirect_gotos.push_back(current);
+                current = fresh();
+            }
+
+            void visit_conditional(region_t &cond_region, region_t &then_region, region_t &else_region) {
+                visit(cond_region);
+                auto cond = constant_condition(cond_region);
+                auto head = current;
+                auto after = fresh();
+
+                current = fresh();
+                branch(head, current, cond, true);
+                visit(then_region);
+                edge(current, after);
+
+                current = fresh();
+                branch(head, current, cond, false);
+                visit(else_region);
+                edge(current, after);
+
+                current = after;
+            }
+
+            void visit(hl::CondOp op) {
+                append(op);
+                visit_conditional(op.getCondRegion(), op.getThenRegion(), op.getElseRegion());
+            }
+
+            void visit(hl::BinaryCondOp op) {
+                append(op);
+                visit(op.getCommonRegion());
+                visit_conditional(op.getCondRegion(), op.getThenRegion(), op.getElseRegion());
+            }
+
+            // The right-hand side is evaluated only if the left-hand side
+            // does not decide the result.
+            void visit_logic(operation op, region_t &lhs, region_t &rhs, bool evaluate_rhs_on) {
+                append(op);
+                visit(lhs);
+                auto cond = constant_condition(lhs);
+                auto head = current;
+                auto after = fresh();
+                branch(head, after, cond, !evaluate_rhs_on);
+
+                current = fresh();
+                branch(head, current, cond, evaluate_rhs_on);
+                visit(rhs);
+                edge(current, after);
+
+                current = after;
+            }
+
+            void visit(hl::BinLAndOp op) { visit_logic(op, op.getLhs(), op.getRhs(), true); }
+            void visit(hl::BinLOrOp op) { visit_logic(op, op.getLhs(), op.getRhs(), false); }
+
+            void visit(ll::Scope op) {
+                append(op);
+                auto after = fresh();
+                auto &body = op.getBody();
+                if (body.empty()) {
+                    edge(current, after);
+                    current = after;
+                    return;
+                }
+
+                scopes.push_back({ block_node(&body.front()), after });
+                visit(body);
+                scopes.pop_back();
+                edge(current, after);
+
+                current = after;
+            }
+
+            const scope_targets &enclosing_scope() const {
+                VAST_CHECK(!scopes.empty(), "scope terminator outside of a scope");
+                return scopes.back();
+            }
+
+            void visit(ll::ScopeRet op) {
+                append(op);
+                jump(enclosing_scope().after);
+            }
+
+            void visit(ll::ScopeRecurse op) {
+                append(op);
+                jump(enclosing_scope().entry);
+            }
+
+            void visit(ll::CondScopeRet op) {
+                append(op);
+                edge(current, enclosing_scope().after);
+                jump(block_node(op.getDest()));
+            }
+
+            struct switch_state
+            {
+                node_id head;
+                bool has_default;
+            };
+
+            std::vector< flow_node > &nodes;
+            node_id current = flow_graph::entry;
+
+            llvm::SmallVector< loop_targets, 8 > loops;
+            llvm::SmallVector< switch_state, 4 > switches;
+            llvm::SmallVector< scope_targets, 8 > scopes;
+
+            llvm::DenseMap< block_ptr, node_id > block_nodes;
+            llvm::DenseMap< mlir_value, node_id > labels;
+            std::vector< node_id > label_order;
+            std::vector< node_id > indirect_gotos;
+        };
+
+    } // namespace
+
+    flow_graph::flow_graph(core::function_op_interface fn) : fn(fn) {
+        flow_graph_builder builder(nodes);
+        builder.build(fn.getFunctionBody());
+        compute_order();
+    }
+
+    void flow_graph::compute_order() {
+        rpo.reserve(nodes.size());
+        positions.assign(nodes.size(), 0);
+
+        // Iterative depth-first search, as nesting of the source may be deep.
+        llvm::BitVector visited(nodes.size());
+        std::vector< std::pair< node_id, unsigned > > stack;
+        std::vector< node_id > post;
+        post.reserve(nodes.size());
+
+        visited.set(entry);
+        stack.emplace_back(entry, 0);
+        while (!stack.empty()) {
+            auto &[id, next] = stack.back();
+            if (next < nodes[id].succs.size()) {
+                auto succ = nodes[id].succs[next++];
+                if (!visited.test(succ)) {
+                    visited.set(succ);
+                    stack.emplace_back(succ, 0);
+                }
+            } else {
+                post.push_back(id);
+                stack.pop_back();
+            }
+        }
+
+        rpo.assign(post.rbegin(), post.rend());
+        for (node_id id = 0; id < nodes.size(); ++id) {
+            if (!visited.test(id)) {
+                rpo.push_back(id);
+            }
+        }
+
+        for (unsigned pos = 0; pos < rpo.size(); ++pos) {
+            positions[rpo[pos]] = pos;
+        }
+    }
+
+} // namespace vast::dataflow
@@ -0,0 +1,98 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/Dataflow/Reachability.hpp"
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/Dataflow/Dataflow.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+
+namespace vast::dataflow {
+
+    llvm::BitVector reachable_nodes(const flow_graph &graph) {
+        // A single fact, "control may get here", seeded at the entry.
+        bitvector_problem problem(graph, 1, direction::forward, confluence::any);
+        problem.boundary.set();
+
+        auto solution = solve(problem);
+
+        llvm::BitVector reachable(unsigned(graph.size()));
+        for (node_id id = 0; id < graph.size(); ++id) {
+            if (solution.in[id].test(0)) {
+                reachable.set(id);
+            }
+        }
+        return reachable;
+    }
+
+    std::vector< operation > unreachable_code(
+        const flow_graph &graph, const llvm::BitVector &reachable
+    ) {
+        llvm::DenseSet< operation > dead;
+        for (node_id id = 0; id < graph.size(); ++id) {
+            if (!reachable.test(id)) {
+                dead.insert(graph.node(id).ops.begin(), graph.node(id).ops.end());
+            }
+        }
+
+        auto nested_in_dead = [&] (operation op) {
+            for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp()) {
+                if (dead.contains(parent)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // Implicit returns do not come from the source.
+        auto reportable = [&] (operation op) {
+            return !mlir::isa< core::ImplicitReturnOp >(op) && !nested_in_dead(op);
+        };
+
+        llvm::DenseSet< operation > reported;
+        for (node_id id = 0; id < graph.size(); ++id) {
+            if (reachable.test(id)) {
+                continue;
+            }
+
+            const auto &ops = graph.node(id).ops;
+            if (auto it = llvm::find_if(ops, reportable); it != ops.end()) {
+                reported.insert(*it);
+            }
+        }
+
+        // Report in the order of the source.
+        std::vector< operation > out;
+        if (!reported.empty()) {
+            graph.function()->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+                if (reported.contains(op)) {
+                    out.push_back(op);
+                }
+            });
+        }
+        return out;
+    }
+
+    std::vector< operation > unreachable_code(const flow_graph &graph) {
+        return unreachable_code(graph, reachable_nodes(graph));
+    }
+
+    std::vector< operation > unreachable_code(operation root) {
+        auto per_function = for_each_function(root, [] (core::function_op_interface fn) {
+            return unreachable_code(flow_graph(fn));
+        });
+
+        std::vector< operation > out;
+        for (auto &ops : per_function) {
+            out.insert(out.end(), ops.begin(), ops.end());
+        }
+        return out;
+    }
+
+} // namespace vast::dataflow
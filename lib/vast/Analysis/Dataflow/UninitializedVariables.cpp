@@ -0,0 +1,270 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/Dataflow/UninitializedVariables.hpp"
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/ScopedHashTable.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/Dataflow/Dataflow.hpp"
+#include "vast/Analysis/Dataflow/Reachability.hpp"
+
+#include <optional>
+
+namespace vast::dataflow {
+
+    namespace {
+
+        using slot_t = unsigned;
+
+        //
+        // Assigns a slot to each local variable with automatic storage and
+        // resolves references to them, following the scoping of regions.
+        // A variable is in scope of its own initializer.
+        //
+        struct slot_table
+        {
+            explicit slot_table(core::function_op_interface fn) {
+                resolve(fn.getFunctionBody());
+            }
+
+            std::optional< slot_t > slot_of_var(operation op) const {
+                if (auto it = var_slots.find(op); it != var_slots.end()) {
+                    return it->second;
+                }
+                return std::nullopt;
+            }
+
+            std::optional< slot_t > slot_of_ref(mlir_value value) const {
+                auto ref = value.getDefiningOp< hl::DeclRefOp >();
+                if (!ref) {
+                    return std::nullopt;
+                }
+                if (auto it = ref_slots.find(ref.getOperation()); it != ref_slots.end()) {
+                    return it->second;
+                }
+                return std::nullopt;
+            }
+
+            std::vector< hl::VarDeclOp > vars;
+
+          private:
+            // Variables without a slot shadow outer ones as well.
+            using symbols_t = llvm::ScopedHashTable< string_ref, std::optional< slot_t > >;
+            using scope_t   = llvm::ScopedHashTableScope< string_ref, std::optional< slot_t > >;
+
+            void resolve(region_t &region) {
+                scope_t scope(symbols);
+                for (auto &block : region) {
+                    for (auto &op : block) {
+                        resolve(&op);
+                    }
+                }
+            }
+
+            void resolve(operation op) {
+                if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                    std::optional< slot_t > slot;
+                    if (var.hasLocalStorage()) {
+                        slot = slot_t(vars.size());
+                        vars.push_back(var);
+                        var_slots[op] = *slot;
+                    }
+                    symbols.insert(var.getSymName(), slot);
+                } else if (auto ref = mlir::dyn_cast< hl::DeclRefOp >(op)) {
+                    if (auto slot = symbols.lookup(ref.getName())) {
+                        ref_slots[op] = *slot;
+                    }
+                }
+
+                for (auto &region : op->getRegions()) {
+                    resolve(region);
+                }
+            }
+
+            symbols_t symbols;
+            llvm::DenseMap< operation, slot_t > var_slots;
+            llvm::DenseMap< operation, slot_t > ref_slots;
+        };
+
+        enum class effect
+        {
+            // Declared without an initializer.
+            declare,
+            // Assigned, initialized or escaped.
+            define,
+            // Value read.
+            use,
+            // Value read and then written, e.g. by compound assignment.
+            update
+        };
+
+        struct event
+        {
+            operation op;
+            slot_t slot;
+            effect what;
+        };
+
+        template< typename... ops_t >
+        bool is_one_of(operation op) { return mlir::isa< ops_t... >(op); }
+
+        bool is_update(operation op) {
+            return is_one_of<
+                hl::AddIAssignOp, hl::AddFAssignOp, hl::SubIAssignOp, hl::SubFAssignOp,
+                hl::MulIAssignOp, hl::MulFAssignOp,
+                hl::DivSAssignOp, hl::DivUAssignOp, hl::DivFAssignOp,
+                hl::RemSAssignOp, hl::RemUAssignOp, hl::RemFAssignOp,
+                hl::BinAndAssignOp, hl::BinOrAssignOp, hl::BinXorAssignOp,
+                hl::BinShlAssignOp, hl::BinLShrAssignOp, hl::BinAShrAssignOp,
+                hl::PreIncOp, hl::PreDecOp, hl::PostIncOp, hl::PostDecOp
+            >(op);
+        }
+
+        // How `user` affects the variable referenced by its operand `idx`.
+        effect effect_of(operation user, unsigned idx) {
+            if (auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(user)) {
+                return cast.getKind() == hl::CastKind::LValueToRValue
+                    ? effect::use : effect::define;
+            }
+
+            if (auto assign = mlir::dyn_cast< hl::AssignOp >(user)) {
+                return user->getOperand(idx) == assign.getDst() ? effect::define : effect::use;
+            }
+
+            if (is_update(user)) {
+                // Operand 0 is the source of compound assignments.
+                return user->getNumOperands() == 1 || idx == 1 ? effect::update : effect::use;
+            }
+
+            // The address escapes or a part of the variable is accessed.
+            return effect::define;
+        }
+
+        std::vector< std::vector< event > > collect_events(
+            const flow_graph &graph, const slot_table &slots
+        ) {
+            std::vector< std::vector< event > > events(graph.size());
+            for (node_id id = 0; id < graph.size(); ++id) {
+                auto &out = events[id];
+                for (auto op : graph.node(id).ops) {
+                    for (auto &operand : op->getOpOperands()) {
+                        if (auto slot = slots.slot_of_ref(operand.get())) {
+                            out.push_back({ op, *slot, effect_of(op, operand.getOperandNumber()) });
+                        }
+                    }
+
+                    if (auto slot = slots.slot_of_var(op)) {
+                        auto var = mlir::cast< hl::VarDeclOp >(op);
+                        auto what = var.getInitializer().empty() ? effect::declare : effect::define;
+                        out.push_back({ op, *slot, what });
+                    }
+                }
+            }
+            return events;
+        }
+
+        // Bits of uninitialized slots.
+        void apply(llvm::BitVector &uninit, const event &ev) {
+            switch (ev.what) {
+                case effect::declare: uninit.set(ev.slot); break;
+                case effect::define:
+                case effect::update:  uninit.reset(ev.slot); break;
+                case effect::use:     break;
+            }
+        }
+
+        bool is_read(effect what) { return what == effect::use || what == effect::update; }
+
+    } // namespace
+
+    std::vector< uninitialized_use > uninitialized_uses(const flow_graph &graph) {
+        auto fn = mlir::cast< core::function_op_interface >(graph.function());
+        slot_table slots(fn);
+        if (slots.vars.empty()) {
+            return {};
+        }
+
+        auto width  = unsigned(slots.vars.size());
+        auto events = collect_events(graph, slots);
+
+        // Uninitialized on some path (may) and on all paths (must). Slots
+        // are uninitialized at the entry, which covers jumps past
+        // declarations.
+        bitvector_problem may(graph, width, direction::forward, confluence::any);
+        bitvector_problem must(graph, width, direction::forward, confluence::all);
+        may.boundary.set();
+        must.boundary.set();
+
+        for (node_id id = 0; id < graph.size(); ++id) {
+            for (const auto &ev : events[id]) {
+                if (ev.what == effect::use) {
+                    continue;
+                }
+
+                bool uninit = ev.what == effect::declare;
+                for (auto *problem : { &may, &must }) {
+                    problem->gen[id][ev.slot]  = uninit;
+                    problem->kill[id][ev.slot] = !uninit;
+                }
+            }
+        }
+
+        auto reachable = reachable_nodes(graph);
+        auto maybe  = solve(may, &reachable);
+        auto surely = solve(must, &reachable);
+
+        // Replay the events of reachable nodes to find the reads.
+        llvm::DenseMap< operation, llvm::SmallVector< uninitialized_use, 1 > > found;
+        for (node_id id = 0; id < graph.size(); ++id) {
+            if (!reachable.test(id) || events[id].empty()) {
+                continue;
+            }
+
+            auto may_uninit  = maybe.in[id];
+            auto must_uninit = surely.in[id];
+            for (const auto &ev : events[id]) {
+                if (is_read(ev.what) && may_uninit.test(ev.slot)) {
+                    found[ev.op].push_back({
+                        ev.op, slots.vars[ev.slot], must_uninit.test(ev.slot)
+                    });
+                }
+                apply(may_uninit, ev);
+                apply(must_uninit, ev);
+            }
+        }
+
+        // Report the first read of each variable in the order of the source.
+        std::vector< uninitialized_use > out;
+        if (!found.empty()) {
+            llvm::DenseSet< operation > reported;
+            fn->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+                if (auto it = found.find(op); it != found.end()) {
+                    for (const auto &use : it->second) {
+                        if (reported.insert(use.var.getOperation()).second) {
+                            out.push_back(use);
+                        }
+                    }
+                }
+            });
+        }
+        return out;
+    }
+
+    std::vector< uninitialized_use > uninitialized_uses(operation root) {
+        auto per_function = for_each_function(root, [] (core::function_op_interface fn) {
+            return uninitialized_uses(flow_graph(fn));
+        });
+
+        std::vector< uninitialized_use > out;
+        for (auto &uses : per_function) {
+            out.insert(out.end(), uses.begin(), uses.end());
+        }
+        return out;
+    }
+
+} // namespace vast::dataflow
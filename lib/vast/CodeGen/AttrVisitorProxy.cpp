@@ -9,7 +9,9 @@
 
 namespace vast::cg
 {
-    operation attr_visitor_proxy::visit_decl_attrs(operation op, const clang_decl *decl, scope_context &scope) {
+    operation visit_decl_attrs(
+        visitor_view head, operation op, const clang_decl *decl, scope_context &scope
+    ) {
         if (!decl->hasAttrs()) {
             return op;
         }
@@ -17,7 +19,7 @@ namespace vast::cg
         mlir_attr_list attrs = op->getAttrs();
 
         auto filtered_attrs = decl->getAttrs() | std::ranges::views::filter([&] (auto attr) {
-            return !util::is_one_of< excluded_attr_list >(attr);
+            return !util::is_one_of< excluded_decl_attr_list >(attr);
         });
 
         for (auto attr : filtered_attrs) {
@@ -14,6 +14,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenFunction.hpp"
 #include "vast/CodeGen/CodeGenModule.hpp"
 #include "vast/CodeGen/CodeGenVisitorList.hpp"
+#include "vast/CodeGen/CodeGenVisitorStack.hpp"
 #include "vast/CodeGen/DataLayout.hpp"
 #include "vast/CodeGen/DefaultCodeGenPolicy.hpp"
 #include "vast/CodeGen/DefaultMetaGenerator.hpp"
@@ -28,16 +29,74 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cg {
 
-    void driver::emit(clang::DeclGroupRef decls) { generator.emit(decls); }
+    // Visitors of the default driver:
+    // attr proxy -> type cache -> lazy decls -> default visitor -> unsupported
+    // -> unreachable
+    using default_visitor_stack = visitor_stack<
+        attr_visitor_layer<
+        type_caching_layer<
+        optional_layer< lazy_decl_visitor,
+        try_or_through_layer< default_visitor,
+        optional_layer< unsup_visitor,
+        bottom_layer< unreach_visitor > > > > > >
+    >;
+
+    void driver::emit(clang::DeclGroupRef decls) {
+        if (!lazy) {
+            return generator.emit(decls);
+        }
+
+        for (auto decl : decls) {
+            emit(decl);
+        }
+    }
+
+    void driver::emit(clang::Decl *decl) {
+        if (!lazy) {
+            return generator.emit(decl);
+        }
+
+        if (lazy->postpone(decl)) {
+            return;
+        }
 
-    void driver::emit(clang::Decl *decl) { generator.emit(decl); }
+        // Previous redeclarations of the declaration go first.
+        emit_required(nullptr);
+        emit_with_required(decl);
+    }
+
+    void driver::emit_with_required(clang::Decl *decl) {
+        auto block = bld->getInsertionBlock();
+        auto next  = bld->getInsertionPoint();
+        auto prev  = next == block->begin() ? nullptr : &*std::prev(next);
+
+        generator.emit(decl);
+
+        // Declarations required by `decl` go in front of its first operation.
+        auto first = prev ? std::next(prev->getIterator()) : block->begin();
+        emit_required(first == block->end() ? nullptr : &*first);
+    }
+
+    bool driver::emit_required(operation before) {
+        auto decls = lazy->take_required();
+        for (auto [decl, user] : decls) {
+            auto _ = bld->insertion_guard();
+            if (auto anchor = user ? user : before) {
+                bld->setInsertionPoint(anchor);
+            }
+
+            emit_with_required(decl);
+        }
+
+        return !decls.empty();
+    }
 
     owning_mlir_module_ref driver::freeze() { return std::move(top); }
 
     // TODO this should not be needed the data layout should be emitted from cached types
     // directly
     dl::DataLayoutBlueprint
-    emit_data_layout_blueprint(const acontext_t &actx, const type_caching_proxy &types) {
+    emit_data_layout_blueprint(const acontext_t &actx, const auto &types) {
         dl::DataLayoutBlueprint dl;
 
         auto store_layout = [&](const clang_type *orig, mlir_type vast_type) {
@@ -70,6 +129,12 @@ namespace vast::cg {
     void driver::finalize() {
         generator.finalize();
 
+        // Bodies of emitted functions may refer to postponed declarations,
+        // whose emission defers further function bodies.
+        while (lazy && emit_required(nullptr)) {
+            generator.finalize();
+        }
+
         emit_data_layout();
 
         if (enabled_verifier) {
@@ -80,8 +145,14 @@ namespace vast::cg {
     }
 
     void driver::emit_data_layout() {
+        if (auto stack = std::dynamic_pointer_cast< default_visitor_stack >(visitor)) {
+            return ::vast::cg::emit_data_layout(
+                mctx, mod, emit_data_layout_blueprint(actx, stack->types())
+            );
+        }
+
         auto list = std::dynamic_pointer_cast< visitor_list >(visitor);
-        for (auto node = list->head; node; node = node->next) {
+        for (auto node = list ? list->head : nullptr; node; node = node->next) {
             if (auto types = std::dynamic_pointer_cast< type_caching_proxy >(node)) {
                 ::vast::cg::emit_data_layout(
                     mctx, mod, emit_data_layout_blueprint(actx, *types)
@@ -121,7 +192,7 @@ namespace vast::cg {
     ) {
         auto bld = mk_codegen_builder(mctx);
 
-        // setup visitor list
+        // setup visitor stack
         const bool enable_unsupported = !vargs.has_option(cc::opt::disable_unsupported);
 
         auto mg         = mk_meta_generator(&actx, &mctx, vargs);
@@ -129,18 +200,36 @@ namespace vast::cg {
         auto sg         = mk_symbol_generator(actx);
         auto policy     = mk_codegen_policy(opts);
 
-        auto visitors = std::make_shared< visitor_list >()
-            | as_node_with_list_ref< attr_visitor_proxy >() | as_node< type_caching_proxy >()
-            | as_node_with_list_ref< default_visitor >(
-                            mctx, actx, *bld, std::move(mg), std::move(sg), std::move(policy)
-            )
-            | optional(enable_unsupported,
-                       as_node_with_list_ref< unsup_visitor >(mctx, *bld, std::move(invalid_mg))
-            )
-            | as_node< unreach_visitor >();
+        auto &bld_ref = *bld;
+
+        auto mk_default = [&] (visitor_base &head) {
+            return default_visitor(
+                head, mctx, actx, bld_ref, std::move(mg), std::move(sg), std::move(policy)
+            );
+        };
+
+        auto mk_unsupported = [&] (visitor_base &head) {
+            return unsup_visitor(head, mctx, bld_ref, std::move(invalid_mg));
+        };
+
+        auto mk_unreachable = [] (visitor_base &) { return unreach_visitor(); };
+
+        auto lazy = vargs.has_option(cc::opt::lazy_decls)
+            ? std::make_shared< lazy_decls >()
+            : nullptr;
+
+        auto mk_lazy = [lazy, &bld_ref] (visitor_base &) { return lazy_decl_visitor(lazy, bld_ref); };
+
+        auto visitors = std::make_shared< default_visitor_stack >(
+            optional(lazy != nullptr, std::move(mk_lazy)),
+            mk_default,
+            optional(enable_unsupported, std::move(mk_unsupported)),
+            mk_unreachable
+        );
 
         // setup driver
         auto drv = std::make_unique< driver >(actx, mctx, std::move(bld), visitors);
+        drv->enable_lazy_emission(std::move(lazy));
 
         drv->enable_verifier(!vargs.has_option(cc::opt::disable_vast_verifier));
         return drv;
@@ -0,0 +1,71 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/DefaultMetaGenerator.hpp"
+
+namespace vast::cg
+{
+    loc_t default_meta_gen::location(clang::SourceLocation loc) const {
+        if (loc.isInvalid()) {
+            return mlir::UnknownLoc::get(mctx);
+        }
+
+        if (auto it = locations.find(loc); it != locations.end()) {
+            return it->second;
+        }
+
+        auto [fid, offset] = actx->getSourceManager().getDecomposedLoc(loc);
+        auto result = file_location(fid, offset);
+        locations.try_emplace(loc, result);
+        return result;
+    }
+
+    file_loc_t default_meta_gen::file_location(clang::FileID fid, unsigned offset) const {
+        if (fid == last_line.fid && last_line.begin <= offset && offset < last_line.end) {
+            return file_loc_t::get(
+                last_line.file, last_line.line, offset - last_line.begin + 1
+            );
+        }
+
+        const auto &sm = actx->getSourceManager();
+
+        bool invalid = false;
+        const auto &entry = sm.getSLocEntry(fid, &invalid);
+        if (invalid || !entry.isFile()) {
+            // Matches the location clang reports for macro expansions.
+            return file_loc_t::get(file_name(fid), 1, 1);
+        }
+
+        auto line = sm.getLineNumber(fid, offset);
+        auto col  = sm.getColumnNumber(fid, offset);
+
+        // The end of line character itself is resolved by the slow path,
+        // clang attributes it differently for CRLF line endings.
+        auto buffer = sm.getBufferData(fid, &invalid);
+        auto end    = invalid ? offset : buffer.find_first_of("\r\n", offset);
+        if (end == llvm::StringRef::npos) {
+            end = buffer.size();
+        }
+
+        last_line = {
+            .fid   = fid,
+            .begin = offset - (col - 1),
+            .end   = static_cast< unsigned >(end),
+            .line  = line,
+            .file  = file_name(fid)
+        };
+
+        return file_loc_t::get(last_line.file, line, col);
+    }
+
+    mlir::StringAttr default_meta_gen::file_name(clang::FileID fid) const {
+        if (auto it = file_names.find(fid); it != file_names.end()) {
+            return it->second;
+        }
+
+        auto entry = actx->getSourceManager().getFileEntryRefForID(fid);
+        auto name  = mlir::StringAttr::get(mctx, entry ? entry->getName() : "unknown");
+        file_names.try_emplace(fid, name);
+        return name;
+    }
+
+} // namespace vast::cg
@@ -0,0 +1,98 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/LazyDeclVisitor.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/Type.h>
+VAST_UNRELAX_WARNINGS
+
+#include <utility>
+
+namespace vast::cg
+{
+    bool lazy_decls::must_emit(const clang_decl *decl) {
+        auto &actx = decl->getASTContext();
+
+        if (auto fn = clang::dyn_cast< clang::FunctionDecl >(decl)) {
+            return fn->doesThisDeclarationHaveABody() && actx.DeclMustBeEmitted(fn);
+        }
+
+        if (auto var = clang::dyn_cast< clang::VarDecl >(decl)) {
+            return actx.DeclMustBeEmitted(var);
+        }
+
+        // Other declarations (e.g., static asserts or file scope asm) are
+        // not referenced by name.
+        return !clang::isa< clang::TypeDecl >(decl);
+    }
+
+    bool lazy_decls::postpone(clang_decl *decl) {
+        auto canonical = decl->getCanonicalDecl();
+        if (required.contains(canonical)) {
+            return false;
+        }
+
+        if (must_emit(decl)) {
+            // Previous redeclarations are emitted first.
+            require(canonical);
+            return false;
+        }
+
+        postponed[canonical].push_back(decl);
+        return true;
+    }
+
+    void lazy_decls::require(const clang_decl *decl, operation user) {
+        auto canonical = decl->getCanonicalDecl();
+        if (!required.insert(canonical).second) {
+            return;
+        }
+
+        if (auto it = postponed.find(canonical); it != postponed.end()) {
+            for (auto redecl : it->second) {
+                ready.push_back({ redecl, user });
+            }
+            postponed.erase(it);
+        }
+    }
+
+    void lazy_decls::require_referenced(const clang_named_decl *decl, operation user) {
+        auto underlying = decl->getUnderlyingDecl();
+
+        if (clang::isa< clang::FunctionDecl >(underlying)) {
+            return require(underlying, user);
+        }
+
+        if (auto var = clang::dyn_cast< clang::VarDecl >(underlying)) {
+            if (var->isFileVarDecl()) {
+                require(var, user);
+            }
+            return;
+        }
+
+        if (auto constant = clang::dyn_cast< clang::EnumConstantDecl >(underlying)) {
+            if (auto enum_decl = clang::dyn_cast< clang::EnumDecl >(constant->getDeclContext())) {
+                require(enum_decl, user);
+            }
+        }
+    }
+
+    void lazy_decls::require_named(const clang_type *type, operation user) {
+        // Nested types are visited on their own, only the type itself is
+        // inspected.
+        if (auto td = clang::dyn_cast< clang::TypedefType >(type)) {
+            return require(td->getDecl(), user);
+        }
+
+        if (auto tag = clang::dyn_cast< clang::TagType >(type)) {
+            return require(tag->getDecl(), user);
+        }
+    }
+
+    auto lazy_decls::take_required() -> std::vector< required_decl > {
+        return std::exchange(ready, {});
+    }
+
+} // namespace vast::cg
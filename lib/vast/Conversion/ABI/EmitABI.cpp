@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/IR/Threading.h>
 #include <mlir/Conversion/LLVMCommon/TypeConverter.h>
 #include <mlir/Conversion/LLVMCommon/Pattern.h>
 
@@ -20,6 +21,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Conversion/ABI/Common.hpp"
 
+#include "vast/Conversion/Common/Mixins.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
 #include "vast/Conversion/TypeConverters/TypeConverter.hpp"
 
@@ -43,6 +45,7 @@ VAST_UNRELAX_WARNINGS
 #include <gap/core/overloads.hpp>
 
 #include <iostream>
+#include <optional>
 #include <unordered_map>
 
 namespace vast
@@ -57,27 +60,94 @@ namespace vast
         return out;
     }
 
-    template< typename Op >
-    using abi_info_map_t = std::unordered_map< std::string, abi::func_info< Op > >;
-
-    template< typename R, typename RootOp, typename DL >
-    auto collect_abi_info(RootOp root_op, const DL &dl)
-        -> abi_info_map_t< R >
+    using func_abi_info_t = abi::func_info< core::function_op_interface >;
+
+    //
+    // ABI classification of functions keyed by their interned symbol names.
+    // Wrappers emitted for functions are keyed by their names as well.
+    //
+    // As an analysis of the module, the classification is computed by
+    // `vast-emit-abi-module` and read by `vast-emit-abi` nested on functions.
+    // Functions the classification was computed from are replaced by then,
+    // so the `raw_fn` of classifications must not be accessed.
+    //
+    struct func_abi_info_map
     {
-        abi_info_map_t< R > out;
-        auto gather = [&](R op, const mlir::WalkStage &)
-        {
-            auto name = mlir::cast< core::func_symbol >(op.getOperation()).getSymbolName();
-            out.emplace( name.str(), abi::make_x86_64(op, dl) );
+        func_abi_info_map() = default;
+        func_abi_info_map(operation root, mlir::AnalysisManager &am);
 
-            return mlir::WalkResult::advance();
-        };
+        const func_abi_info_t *lookup(mlir::StringAttr name) const {
+            auto it = by_name.find(name);
+            return it != by_name.end() ? it->second : nullptr;
+        }
+
+        bool is_var_arg(const func_abi_info_t *info) const {
+            return var_arg[static_cast< std::size_t >(info - infos.data())];
+        }
+
+        // Functions of the same type under the same data layout share
+        // a single classification.
+        std::vector< func_abi_info_t > infos;
+        std::vector< bool > var_arg;
+        llvm::DenseMap< mlir::StringAttr, const func_abi_info_t * > by_name;
+    };
+
+    func_abi_info_map collect_abi_info(operation root, const mlir::DataLayoutAnalysis &dla) {
+        using signature_t = std::pair< mlir_type, const mlir::DataLayout * >;
+
+        llvm::DenseMap< signature_t, std::size_t > signatures;
+        std::vector< core::function_op_interface > representatives;
+        std::vector< std::pair< mlir::StringAttr, std::size_t > > functions;
+
+        root->walk([&] (core::function_op_interface fn) {
+            const auto &dl = dla.getAtOrAbove(fn);
+            auto [it, inserted] = signatures.try_emplace(
+                signature_t{ fn.getFunctionType(), &dl }, representatives.size()
+            );
+
+            if (inserted) {
+                representatives.push_back(fn);
+            }
+
+            functions.emplace_back(mlir::SymbolTable::getSymbolName(fn), it->second);
+        });
+
+        // Classification only reads the IR, distinct signatures are
+        // classified in parallel.
+        std::vector< std::optional< func_abi_info_t > > classified(representatives.size());
+        mlir::parallelFor(root->getContext(), 0, representatives.size(), [&] (std::size_t idx) {
+            auto fn = representatives[idx];
+            // Data layouts cache queried types, each task works with its own copy.
+            mlir::DataLayout dl = dla.getAtOrAbove(fn);
+            classified[idx].emplace(abi::make_x86_64(fn, dl));
+        });
+
+        func_abi_info_map out;
+        out.infos.reserve(classified.size());
+        for (auto &info : classified) {
+            out.infos.push_back(std::move(*info));
+        }
+
+        for (auto fn : representatives) {
+            auto fn_type = mlir::dyn_cast< core::FunctionType >(fn.getFunctionType());
+            out.var_arg.push_back(fn_type && fn_type.isVarArg());
+        }
+
+        auto mctx = root->getContext();
+        for (auto [name, idx] : functions) {
+            const auto *info = &out.infos[idx];
+            out.by_name.try_emplace(name, info);
+            out.by_name.try_emplace(
+                mlir::StringAttr::get(mctx, conv::abi::abi_func_name_prefix + name.str()), info
+            );
+        }
 
-        root_op->walk(gather);
         return out;
     }
 
-    using func_abi_info_t = abi_info_map_t< core::function_op_interface >;
+    func_abi_info_map::func_abi_info_map(operation root, mlir::AnalysisManager &am)
+        : func_abi_info_map(collect_abi_info(root, am.getAnalysis< mlir::DataLayoutAnalysis >()))
+    {}
 
     namespace
     {
@@ -380,26 +450,17 @@ namespace vast
 
             const abi_info_t &abi_info;
 
-            call_wrapper(state_t state, const abi_info_t &abi_info)
-                : state_t(std::move(state)), abi_info(abi_info)
+            // Taken from the classification, the callee may be already
+            // replaced by its wrapper.
+            bool var_arg;
+
+            call_wrapper(state_t state, const abi_info_t &abi_info, bool var_arg)
+                : state_t(std::move(state)), abi_info(abi_info), var_arg(var_arg)
             {}
 
             using values_t = std::vector< mlir::Value >;
 
-            auto get_callee() -> core::function_op_interface {
-                auto caller = mlir::dyn_cast< VastCallOpInterface >(*op);
-                auto callee = mlir::dyn_cast< core::function_op_interface >(
-                    caller.resolveCallable());
-                VAST_ASSERT(callee);
-                return callee;
-            }
-
-            bool is_var_arg() {
-                auto type = get_callee().getFunctionType();
-                auto fn_type = mlir::dyn_cast< core::FunctionType >(type);
-                VAST_ASSERT(fn_type);
-                return fn_type.isVarArg();
-            }
+            bool is_var_arg() { return var_arg; }
 
             template< typename Impl >
             values_t mk_direct(
@@ -689,21 +750,20 @@ namespace vast
             using base = mlir::OpConversionPattern< op_t >;
             using adaptor_t = typename op_t::Adaptor;
 
-            const func_abi_info_t &abi_info_map;
+            const func_abi_info_map &abi_info_map;
 
-            func_type(const func_abi_info_t &abi_info_map, mcontext_t &mctx)
+            func_type(const func_abi_info_map &abi_info_map, mcontext_t &mctx)
                 : base(&mctx), abi_info_map(abi_info_map)
             {}
 
             logical_result matchAndRewrite(
                 op_t op, adaptor_t ops, conversion_rewriter &rewriter
             ) const override {
-                auto abi_map_it = abi_info_map.find(op.getSymbolName().str());
-                if (abi_map_it == abi_info_map.end())
+                auto abi_info = abi_info_map.lookup(mlir::SymbolTable::getSymbolName(op));
+                if (!abi_info)
                     return mlir::failure();
 
-                const auto &abi_info = abi_map_it->second;
-                abi_transform< op_t >({ op, ops, rewriter }, abi_info).make();
+                abi_transform< op_t >({ op, ops, rewriter }, *abi_info).make();
                 rewriter.eraseOp(op);
                 return mlir::success();
             }
@@ -715,21 +775,22 @@ namespace vast
             using base = mlir::OpConversionPattern< op_t >;
             using adaptor_t = typename op_t::Adaptor;
 
-            const func_abi_info_t &abi_info_map;
+            const func_abi_info_map &abi_info_map;
 
-            call_op(const func_abi_info_t &abi_info_map, mcontext_t &mctx)
+            call_op(const func_abi_info_map &abi_info_map, mcontext_t &mctx)
                 : base(&mctx), abi_info_map(abi_info_map)
             {}
 
             logical_result matchAndRewrite(
                 op_t op, adaptor_t ops, conversion_rewriter &rewriter
             ) const override {
-                auto abi_map_it = abi_info_map.find(op.getCallee().str());
-                if (abi_map_it == abi_info_map.end())
+                auto abi_info = abi_info_map.lookup(op.getCalleeAttr().getAttr());
+                if (!abi_info)
                     return mlir::failure();
 
-                const auto &abi_info = abi_map_it->second;
-                auto call = call_wrapper< op_t >({op, ops, rewriter}, abi_info).make();
+                auto call = call_wrapper< op_t >(
+                    {op, ops, rewriter}, *abi_info, abi_info_map.is_var_arg(abi_info)
+                ).make();
                 rewriter.replaceOp(op, call);
                 return mlir::success();
             }
@@ -741,9 +802,9 @@ namespace vast
             using base = mlir::OpConversionPattern< op_t >;
             using adaptor_t = typename op_t::Adaptor;
 
-            const func_abi_info_t &abi_info_map;
+            const func_abi_info_map &abi_info_map;
 
-            return_op(const func_abi_info_t &abi_info_map, mcontext_t &mctx)
+            return_op(const func_abi_info_map &abi_info_map, mcontext_t &mctx)
                 : base(&mctx), abi_info_map(abi_info_map)
             {}
 
@@ -754,16 +815,12 @@ namespace vast
                 if (!func)
                     return mlir::failure();
 
-                auto name = func.getSymbolName();
-                if (!name.consume_front(conv::abi::abi_func_name_prefix))
-                    return mlir::failure();
-
-                auto abi_map_it = abi_info_map.find(name.str());
-                if (abi_map_it == abi_info_map.end())
+                // Wrappers are keyed by their prefixed names.
+                auto abi_info = abi_info_map.lookup(mlir::SymbolTable::getSymbolName(func));
+                if (!abi_info)
                     return mlir::failure();
 
-                const auto &abi_info = abi_map_it->second;
-                return_wrapper< op_t >({op, ops, rewriter}, abi_info).make();
+                return_wrapper< op_t >({op, ops, rewriter}, *abi_info).make();
 
                 rewriter.eraseOp(op);
                 return mlir::success();
@@ -775,52 +832,8 @@ namespace vast
 
     struct EmitABI : EmitABIBase< EmitABI >
     {
-        using target_t = mlir::ConversionTarget;
-        using patterns_t = mlir::RewritePatternSet;
-        using phase_t = std::tuple< target_t, patterns_t >;
-
-        phase_t first_phase(const auto &abi_info_map)
-        {
-            auto &mctx = this->getContext();
-
-            mlir::ConversionTarget target(mctx);
-            target.markUnknownOpDynamicallyLegal([](auto) { return true; });
-            target.addIllegalOp< hl::CallOp >();
-
-            mlir::RewritePatternSet patterns(&mctx);
-            patterns.add< call_op >(abi_info_map, mctx);
-
-            return { std::move(target), std::move(patterns) };
-        }
-
-        phase_t second_phase(const auto &abi_info_map)
-        {
-
-            auto &mctx = this->getContext();
-
-            mlir::ConversionTarget target(mctx);
-            target.markUnknownOpDynamicallyLegal([](auto) { return true; });
-
-            auto should_transform = [&](operation op)
-            {
-                // TODO(conv:abi): We should always emit main with a fixed type.
-                if (auto fn = mlir::dyn_cast< core::func_symbol >(op))
-                    return fn.getSymbolName() == "main";
-                return true;
-            };
-
-            target.markUnknownOpDynamicallyLegal(should_transform);
-            target.addLegalOp< abi::FuncOp >();
-
-            mlir::RewritePatternSet patterns(&mctx);
-            patterns.add< func_type< hl::FuncOp > >(abi_info_map, mctx);
-            patterns.add< func_type< ll::FuncOp > >(abi_info_map, mctx);
-
-            return { std::move(target), std::move(patterns) };
-        }
-
         template< typename ret_op_t >
-        auto get_is_legal_return() {
+        static auto get_is_legal_return() {
             return [] (ret_op_t op) -> bool {
                 auto func = op->template getParentOfType< abi::FuncOp >();
                 if (!func)
@@ -833,49 +846,124 @@ namespace vast
             };
         }
 
-        phase_t third_phase(const auto &abi_info_map)
-        {
-            auto &mctx = this->getContext();
+        // Functions, except for main, are transformed into wrappers.
+        static void legalize_functions(mlir::ConversionTarget &target) {
+            auto should_transform = [] (operation op) {
+                // TODO(conv:abi): We should always emit main with a fixed type.
+                if (auto fn = mlir::dyn_cast< core::func_symbol >(op))
+                    return fn.getSymbolName() == "main";
+                return true;
+            };
+
+            target.markUnknownOpDynamicallyLegal(should_transform);
+            target.addLegalOp< abi::FuncOp >();
+        }
 
-            mlir::ConversionTarget target(mctx);
-            target.markUnknownOpDynamicallyLegal([](auto) { return true; });
+        static void legalize_calls_and_returns(mlir::ConversionTarget &target) {
+            target.addIllegalOp< hl::CallOp >();
 
             // Plan is to still leave `hl.return` but it should return values
             // yielded by `abi.epilogue`.
             // FIXME: use some return op interface
             target.addDynamicallyLegalOp< hl::ReturnOp >(get_is_legal_return< hl::ReturnOp >());
             target.addDynamicallyLegalOp< ll::ReturnOp >(get_is_legal_return< ll::ReturnOp >());
+        }
 
-            mlir::RewritePatternSet patterns(&mctx);
+        static void add_function_patterns(
+            mlir::RewritePatternSet &patterns, const func_abi_info_map &abi_info_map
+        ) {
+            auto &mctx = *patterns.getContext();
+            patterns.add< func_type< hl::FuncOp > >(abi_info_map, mctx);
+            patterns.add< func_type< ll::FuncOp > >(abi_info_map, mctx);
+        }
+
+        static void add_call_and_return_patterns(
+            mlir::RewritePatternSet &patterns, const func_abi_info_map &abi_info_map
+        ) {
+            auto &mctx = *patterns.getContext();
+            patterns.add< call_op >(abi_info_map, mctx);
             patterns.add< return_op< hl::ReturnOp > >(abi_info_map, mctx);
             patterns.add< return_op< ll::ReturnOp > >(abi_info_map, mctx);
+        }
 
-            return { std::move(target), std::move(patterns) };
+        // Classification computed by `vast-emit-abi-module` for a module
+        // enclosing the function.
+        const func_abi_info_map *ancestor_abi_info() {
+            for (auto op = getOperation()->getParentOp(); op; op = op->getParentOp()) {
+                if (auto info = this->getCachedParentAnalysis< func_abi_info_map >(op)) {
+                    return &info->get();
+                }
+            }
+            return nullptr;
         }
 
-        mlir::LogicalResult run(phase_t phase)
-        {
-            auto [trg, patterns] = std::move(phase);
-            return mlir::applyPartialConversion(this->getOperation(), trg, std::move(patterns));
+        //
+        // Run on a module, calls, functions and returns are rewritten in
+        // a single conversion. Bodies of functions are cloned into their
+        // wrappers, the cloned calls and returns are legalized as part of the
+        // same traversal.
+        //
+        logical_result convert_module(operation op) {
+            const auto &dl = this->getAnalysis< mlir::DataLayoutAnalysis >();
+            auto abi_info_map = collect_abi_info(op, dl);
+
+            mlir::ConversionTarget target(this->getContext());
+            legalize_functions(target);
+            legalize_calls_and_returns(target);
+
+            mlir::RewritePatternSet patterns(&this->getContext());
+            add_function_patterns(patterns, abi_info_map);
+            add_call_and_return_patterns(patterns, abi_info_map);
+
+            return mlir::applyPartialConversion(op, target, std::move(patterns));
+        }
+
+        // Nested on a function, only calls and returns in its body are
+        // rewritten, the function itself is already transformed.
+        logical_result convert_function(operation op) {
+            auto abi_info_map = ancestor_abi_info();
+            if (!abi_info_map) {
+                return op->emitError("vast-emit-abi nested on a function requires"
+                                     " vast-emit-abi-module to run first");
+            }
+
+            mlir::ConversionTarget target(this->getContext());
+            target.markUnknownOpDynamicallyLegal([] (auto) { return true; });
+            legalize_calls_and_returns(target);
+
+            mlir::RewritePatternSet patterns(&this->getContext());
+            add_call_and_return_patterns(patterns, *abi_info_map);
+
+            return mlir::applyPartialConversion(op, target, std::move(patterns));
         }
 
         void runOnOperation() override
         {
             auto op = this->getOperation();
+            auto result = is_function(op) ? convert_function(op) : convert_module(op);
+            if (mlir::failed(result))
+                return signalPassFailure();
+        }
+    };
 
-            const auto &dl = this->getAnalysis< mlir::DataLayoutAnalysis >();
-            auto abi_info_map = collect_abi_info< core::function_op_interface >(
-                op, dl.getAtOrAbove(op)
-            );
+    struct EmitABIModule : EmitABIModuleBase< EmitABIModule >
+    {
+        void runOnOperation() override
+        {
+            const auto &abi_info_map = this->getAnalysis< func_abi_info_map >();
 
-            if (mlir::failed(run(first_phase(abi_info_map))))
-                return signalPassFailure();
+            mlir::ConversionTarget target(this->getContext());
+            EmitABI::legalize_functions(target);
 
-            if (mlir::failed(run(second_phase(abi_info_map))))
-                return signalPassFailure();
+            mlir::RewritePatternSet patterns(&this->getContext());
+            EmitABI::add_function_patterns(patterns, abi_info_map);
 
-            if (mlir::failed(run(third_phase(abi_info_map))))
+            if (mlir::failed(mlir::applyPartialConversion(getOperation(), target, std::move(patterns))))
                 return signalPassFailure();
+
+            // Wrappers are registered under their names, the classification
+            // stays valid for calls and returns converted by nested passes.
+            markAnalysesPreserved< func_abi_info_map >();
         }
     };
 
@@ -885,3 +973,8 @@ std::unique_ptr< mlir::Pass > vast::createEmitABIPass()
 {
     return std::make_unique< vast::EmitABI >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createEmitABIModulePass()
+{
+    return std::make_unique< vast::EmitABIModule >();
+}
@@ -573,6 +573,12 @@ namespace vast
             return target;
         }
 
+        static void add_function_patterns(base_conversion_config &cfg)
+        {
+            cfg.patterns.template add< pattern::function >(cfg.patterns.getContext());
+            cfg.target.template addIllegalOp< abi::FuncOp >();
+        }
+
         void add_patterns(base_conversion_config &cfg, const auto &dl)
         {
             auto ctx = cfg.patterns.getContext();
@@ -585,8 +591,6 @@ namespace vast
             cfg.patterns.template add< pattern::call >(ctx);
             cfg.patterns.template add< pattern::call_exec >(ctx);
 
-            cfg.patterns.template add< pattern::function >(ctx);
-
             cfg.target.template addIllegalOp< abi::PrologueOp >();
             cfg.target.template addIllegalOp< abi::EpilogueOp >();
 
@@ -595,8 +599,6 @@ namespace vast
 
             cfg.target.template addIllegalOp< abi::CallOp >();
             cfg.target.template addIllegalOp< abi::CallExecutionOp >();
-
-            cfg.target.template addIllegalOp< abi::FuncOp >();
         }
 
         void runOnOperation() override
@@ -609,11 +611,38 @@ namespace vast
 
             auto op     = this->getOperation();
 
-            const auto &dl_analysis = this->template getAnalysis< mlir::DataLayoutAnalysis >();
-            auto dl = dl_analysis.getAtOrAbove(op);
+            // Nested on a function, the pass cannot use analyses of the
+            // module, the layout is taken from the closest ancestor.
+            auto dl = mlir::DataLayout::closest(op);
 
             add_patterns(cfg, dl);
 
+            // Nested passes must not replace the function they run on, it is
+            // left to `vast-lower-abi-module`.
+            if (!is_function(op)) {
+                add_function_patterns(cfg);
+            }
+
+            if (mlir::failed(base::apply_conversions(std::move(cfg)))) {
+                return signalPassFailure();
+            }
+        }
+    };
+
+    struct LowerABIModule : ConversionPassMixin< LowerABIModule, LowerABIModuleBase >
+    {
+        using base = ConversionPassMixin< LowerABIModule, LowerABIModuleBase >;
+
+        void runOnOperation() override
+        {
+            auto &ctx = getContext();
+            base_conversion_config cfg = {
+                rewrite_pattern_set(&ctx),
+                LowerABI::create_conversion_target(ctx)
+            };
+
+            LowerABI::add_function_patterns(cfg);
+
             if (mlir::failed(base::apply_conversions(std::move(cfg)))) {
                 return signalPassFailure();
             }
@@ -626,3 +655,8 @@ std::unique_ptr< mlir::Pass > vast::createLowerABIPass()
 {
     return std::make_unique< vast::LowerABI >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createLowerABIModulePass()
+{
+    return std::make_unique< vast::LowerABIModule >();
+}
@@ -11,12 +11,22 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::conv::pipeline {
 
+    // Functions are transformed at the module level, their bodies by passes
+    // nested on functions.
+    static pipeline_step_ptr emit_abi_module() {
+        return pass(createEmitABIModulePass).depends_on(to_ll);
+    }
+
     static pipeline_step_ptr emit_abi() {
-        return pass(createEmitABIPass).depends_on(to_ll);
+        return function_pass(createEmitABIPass).depends_on(emit_abi_module);
+    }
+
+    static pipeline_step_ptr lower_abi_module() {
+        return pass(createLowerABIModulePass).depends_on(emit_abi);
     }
 
     static pipeline_step_ptr lower_abi() {
-        return pass(createLowerABIPass).depends_on(emit_abi);
+        return function_pass(createLowerABIPass).depends_on(lower_abi_module);
     }
 
     pipeline_step_ptr abi() {
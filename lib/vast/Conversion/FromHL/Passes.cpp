@@ -17,14 +17,23 @@ namespace vast::conv::pipeline {
         return pass(createHLToHLBI);
     }
 
+    //
+    // Passes rewriting bodies of functions run nested on functions, their
+    // module-level parts are scheduled as dependencies.
+    //
     pipeline_step_ptr hl_to_ll_cf() {
         // TODO add dependencies
-        return pass(createHLToLLCFPass);
+        return function_pass(createHLToLLCFPass);
+    }
+
+    static pipeline_step_ptr hl_to_ll_geps_module() {
+        return pass(createHLToLLGEPsModulePass);
     }
 
     pipeline_step_ptr hl_to_ll_geps() {
         // TODO add dependencies
-        return pass(createHLToLLGEPsPass);
+        return function_pass(createHLToLLGEPsPass)
+            .depends_on(hl_to_ll_geps_module);
     }
 
     pipeline_step_ptr lazy_regions() {
@@ -39,16 +48,20 @@ namespace vast::conv::pipeline {
 
     // FIXME: move to ToMem/Passes.cpp eventually
     pipeline_step_ptr vars_to_cells() {
-        return pass(createVarsToCellsPass);
+        return function_pass(createVarsToCellsPass);
     }
 
     pipeline_step_ptr evict_static_locals() {
         return pass(createEvictStaticLocalsPass);
     }
 
+    static pipeline_step_ptr refs_to_ssa_module() {
+        return pass(createRefsToSSAModulePass);
+    }
+
     pipeline_step_ptr refs_to_ssa() {
-        return pass(createRefsToSSAPass)
-            .depends_on(vars_to_cells);
+        return function_pass(createRefsToSSAPass)
+            .depends_on(vars_to_cells, refs_to_ssa_module);
     }
 
     // FIXME: run on hl.FuncOp. Once we remove graph regions ll::FuncOp is no longer needed
@@ -66,11 +79,16 @@ namespace vast::conv::pipeline {
     }
 
 
-    pipeline_step_ptr lower_value_categories() {
-        return pass(createLowerValueCategoriesPass)
+    static pipeline_step_ptr lower_value_categories_module() {
+        return pass(createLowerValueCategoriesModulePass)
             .depends_on(to_mem);
     }
 
+    pipeline_step_ptr lower_value_categories() {
+        return function_pass(createLowerValueCategoriesPass)
+            .depends_on(lower_value_categories_module);
+    }
+
     pipeline_step_ptr to_ll() {
         return compose( "to-ll",
             hl_to_ll_func,
@@ -503,14 +503,14 @@ namespace vast::conv {
                 // We really don't care if anything was removed or not.
                 std::ignore = mlir::eraseUnreachableBlocks(rewriter, scope.getBody());
             };
-            this->getOperation().walk(clean_scopes);
+            this->getOperation()->walk(clean_scopes);
 
             auto clean_functions = [&](hl::FuncOp fn) {
                 mlir::IRRewriter rewriter{ &this->getContext() };
                 // We really don't care if anything was removed or not.
                 std::ignore = mlir::eraseUnreachableBlocks(rewriter, fn.getBody());
             };
-            this->getOperation().walk(clean_functions);
+            this->getOperation()->walk(clean_functions);
         }
     };
 
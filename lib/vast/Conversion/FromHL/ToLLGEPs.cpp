@@ -17,6 +17,8 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Conversion/Common/Mixins.hpp"
+
 #include "vast/Util/DialectConversion.hpp"
 
 namespace vast {
@@ -102,14 +104,8 @@ namespace vast {
             }
         };
 
-    } // namespace
-
-    struct HLToLLGEPsPass : HLToLLGEPsBase< HLToLLGEPsPass >
-    {
-        void runOnOperation() override {
-            auto op    = this->getOperation();
-            auto &mctx = this->getContext();
-
+        // Converts members in `ops` and operations nested in them.
+        logical_result convert_record_members(mcontext_t &mctx, llvm::ArrayRef< operation > ops) {
             mlir::ConversionTarget trg(mctx);
             trg.markUnknownOpDynamicallyLegal([](auto) { return true; });
             trg.addIllegalOp< hl::RecordMemberOp >();
@@ -118,7 +114,25 @@ namespace vast {
 
             patterns.add< record_member_op >(&mctx);
 
-            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns)))) {
+            return mlir::applyPartialConversion(ops, trg, std::move(patterns));
+        }
+
+    } // namespace
+
+    struct HLToLLGEPsPass : HLToLLGEPsBase< HLToLLGEPsPass >
+    {
+        void runOnOperation() override {
+            if (mlir::failed(convert_record_members(getContext(), getOperation()))) {
+                return signalPassFailure();
+            }
+        }
+    };
+
+    struct HLToLLGEPsModulePass : HLToLLGEPsModuleBase< HLToLLGEPsModulePass >
+    {
+        void runOnOperation() override {
+            auto ops = ops_outside_functions(getOperation());
+            if (mlir::failed(convert_record_members(getContext(), ops))) {
                 return signalPassFailure();
             }
         }
@@ -128,3 +142,7 @@ namespace vast {
 std::unique_ptr< mlir::Pass > vast::createHLToLLGEPsPass() {
     return std::make_unique< vast::HLToLLGEPsPass >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createHLToLLGEPsModulePass() {
+    return std::make_unique< vast::HLToLLGEPsModulePass >();
+}
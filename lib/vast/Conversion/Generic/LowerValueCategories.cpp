@@ -410,12 +410,10 @@ namespace vast::conv {
         type_rewriter(mcontext_t *mctx) : pattern_rewriter(mctx) {}
     };
 
-    struct LowerValueCategoriesPass : LowerValueCategoriesBase< LowerValueCategoriesPass >
+    struct value_categories_lowering
     {
-        using base = LowerValueCategoriesBase< LowerValueCategoriesPass >;
-
         template< typename... Args >
-        void populate(
+        static void populate(
             util::type_list< Args... >, mlir::RewritePatternSet &patterns,
             mlir::ConversionTarget &trg, mcontext_t &mctx, value_category_type_converter &tc
         ) {
@@ -423,10 +421,8 @@ namespace vast::conv {
             (Args::legalize(trg), ...);
         }
 
-        void runOnOperation() override {
-            auto root  = getOperation();
-            auto &mctx = getContext();
-
+        // Lowers `ops` and operations nested in them.
+        static logical_result run(mcontext_t &mctx, llvm::ArrayRef< operation > ops) {
             value_category_type_converter tc(mctx);
 
             mlir::RewritePatternSet patterns(&mctx);
@@ -477,7 +473,25 @@ namespace vast::conv {
             // This will never have correct types but we want to have it legal.
             trg.addLegalOp< mlir::UnrealizedConversionCastOp >();
 
-            if (mlir::failed(mlir::applyPartialConversion(root, trg, std::move(patterns)))) {
+            return mlir::applyPartialConversion(ops, trg, std::move(patterns));
+        }
+    };
+
+    struct LowerValueCategoriesPass : LowerValueCategoriesBase< LowerValueCategoriesPass >
+    {
+        void runOnOperation() override {
+            if (mlir::failed(value_categories_lowering::run(getContext(), getOperation()))) {
+                return signalPassFailure();
+            }
+        }
+    };
+
+    struct LowerValueCategoriesModulePass
+        : LowerValueCategoriesModuleBase< LowerValueCategoriesModulePass >
+    {
+        void runOnOperation() override {
+            auto ops = ops_outside_functions(getOperation());
+            if (mlir::failed(value_categories_lowering::run(getContext(), ops))) {
                 return signalPassFailure();
             }
         }
@@ -487,3 +501,7 @@ namespace vast::conv {
 std::unique_ptr< mlir::Pass > vast::createLowerValueCategoriesPass() {
     return std::make_unique< vast::conv::LowerValueCategoriesPass >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createLowerValueCategoriesModulePass() {
+    return std::make_unique< vast::conv::LowerValueCategoriesModulePass >();
+}
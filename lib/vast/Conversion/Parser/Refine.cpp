@@ -215,6 +215,8 @@ namespace vast::conv {
     {
         using base = ConversionPassMixin< ParserRefinePass, ParserRefineBase >;
 
+        static constexpr bool index_symbol_uses = true;
+
         static conversion_target create_conversion_target(mcontext_t &mctx) {
             return conversion_target(mctx);
         }
@@ -4,6 +4,7 @@
 #include "vast/Conversion/Parser/Passes.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringSet.h>
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/YAMLParser.h>
@@ -175,45 +176,76 @@ namespace vast::conv {
         using response_type = function_model;
     };
 
-    function_model ask_user_for_function_model(
-        vast::server::server_base &server, core::function_op_interface op
-    ) {
-        function_model model{
-            .return_type = pr::data_type::maybedata,
-            .arguments   = {},
-            .category    = function_category::nonparser,
-            .is_stdlib   = false,
-        };
-
-        auto loc = op.getLoc();
+    std::string function_name(core::function_op_interface op) {
         auto sym = mlir::dyn_cast< core::SymbolOpInterface >(op.getOperation());
         VAST_ASSERT(sym);
-        auto name = sym.getSymbolName().str();
+        return sym.getSymbolName().str();
+    }
 
+    input_request make_input_request(core::function_op_interface op) {
         input_request req{
-            .functionName      = name,
+            .functionName      = function_name(op),
             .numberOfArguments = op.getNumArguments(),
             .filePath          = std::nullopt,
             .range             = std::nullopt,
         };
 
-        if (auto req_loc = get_location(loc)) {
+        if (auto req_loc = get_location(op.getLoc())) {
             req.filePath = req_loc->filePath;
             req.range    = req_loc->range;
         }
 
-        auto response = server.send_request(req);
+        return req;
+    }
+
+    function_model to_function_model(
+        core::function_op_interface op, const server::result_type< input_request > &response
+    ) {
         if (auto result = std::get_if< input_request::response_type >(&response)) {
             VAST_ASSERT(result->arguments.size() == op.getNumArguments());
-            model = *result;
-        } else {
-            for (unsigned int i = 0; i < op.getNumArguments(); ++i) {
-                model.arguments.push_back(pr::data_type::maybedata);
-            }
+            return *result;
         }
+
+        function_model model{
+            .return_type = pr::data_type::maybedata,
+            .arguments   = {},
+            .category    = function_category::nonparser,
+            .is_stdlib   = false,
+        };
+
+        for (unsigned int i = 0; i < op.getNumArguments(); ++i) {
+            model.arguments.push_back(pr::data_type::maybedata);
+        }
+
         return model;
     }
 
+    function_model ask_user_for_function_model(
+        vast::server::server_base &server, core::function_op_interface op
+    ) {
+        return to_function_model(op, server.send_request(make_input_request(op)));
+    }
+
+    //
+    // Requests for all functions are sent before waiting for any response,
+    // so resolution of the whole batch costs a single round trip.
+    //
+    void ask_user_for_function_models(
+        vast::server::server_base &server, llvm::ArrayRef< core::function_op_interface > ops,
+        function_models &models
+    ) {
+        std::vector< server::ticket< input_request > > tickets;
+        tickets.reserve(ops.size());
+        for (auto op : ops) {
+            tickets.push_back(server.send_request_nonblock(make_input_request(op)));
+        }
+
+        for (auto [idx, op] : llvm::enumerate(ops)) {
+            auto response = server.wait_request(std::move(tickets[idx]));
+            models.add(function_name(op), to_function_model(op, response));
+        }
+    }
+
 } // namespace vast::conv
 
 LLVM_YAML_IS_SEQUENCE_VECTOR(vast::pr::data_type);
@@ -1102,6 +1134,8 @@ namespace vast::conv {
     {
         using base = ConversionPassMixin< HLToParserPass, HLToParserBase >;
 
+        static constexpr bool cache_symbol_tables = true;
+
         struct get_function_model_request
         {
             static constexpr const char *method   = "get_function_model";
@@ -1170,6 +1204,27 @@ namespace vast::conv {
                     server_handler{ models }
                 );
             }
+
+            if (server) {
+                prefetch_function_models();
+            }
+        }
+
+        // Resolves models of all functions unknown to the configuration
+        // before the conversion starts, so that patterns do not block on the
+        // user one function at a time.
+        void prefetch_function_models() {
+            std::vector< core::function_op_interface > unmodeled;
+            llvm::StringSet<> seen;
+
+            getOperation()->walk([&] (hl::FuncOp op) {
+                auto name = op.getSymName();
+                if (!models.get(name) && seen.insert(name).second) {
+                    unmodeled.push_back(op);
+                }
+            });
+
+            ask_user_for_function_models(*server, unmodeled, models);
         }
 
         void load_and_parse(string_ref config) {
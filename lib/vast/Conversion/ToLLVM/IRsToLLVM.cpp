@@ -49,6 +49,91 @@ namespace vast::conv::irstollvm
         return opts;
     }
 
+    //
+    // Data layout and type converters shared by all patterns and legality
+    // callbacks of the conversion. Building them is costly, therefore they are
+    // built once per converted module instead of once per visited operation.
+    //
+    // Converted types are memoized by the type converters themselves, the
+    // legality of types and attribute dictionaries is memoized here.
+    //
+    struct llvm_conversion_state
+    {
+        explicit llvm_conversion_state(operation root)
+            : dla(root)
+            , type_converter(
+                root->getContext(), dla,
+                tc::lower_to_llvm_options(root->getContext(), dla.getAtOrAbove(root)),
+                root
+            )
+            , legality_converter(root->getContext(), dla, mk_default_opts(root->getContext()), root)
+        {}
+
+        tc::llvm_type_converter &converter(operation from) {
+            type_converter.set_anchor(from);
+            return type_converter;
+        }
+
+        const mlir::DataLayout &data_layout(operation from) const {
+            return dla.getAtOrAbove(from);
+        }
+
+        bool is_legal(operation from, mlir_type type) {
+            if (auto it = legal_types.find(type); it != legal_types.end()) {
+                return it->second;
+            }
+
+            legality_converter.set_anchor(from);
+            bool legal = legality_converter.isLegal(type);
+            legal_types[type] = legal;
+            return legal;
+        }
+
+        bool has_legal_return_type(operation op) {
+            return tc::all_of_subtypes(op->getResults().getTypes(), [&] (mlir_type type) {
+                return is_legal(op, type);
+            });
+        }
+
+        bool has_legal_operand_types(operation op) {
+            return tc::all_of_subtypes(op->getOperands().getTypes(), [&] (mlir_type type) {
+                return is_legal(op, type);
+            });
+        }
+
+        // Result types and types of attributes need to be legal, types of
+        // arguments are result types of a different op.
+        bool is_type_conversion_legal(operation op) {
+            for (auto type : op->getResultTypes()) {
+                if (!is_legal(op, type)) {
+                    return false;
+                }
+            }
+
+            auto attrs = op->getAttrDictionary();
+            if (auto it = illegal_attrs.find(attrs); it != illegal_attrs.end()) {
+                return !it->second;
+            }
+
+            bool illegal = contains_subtype(attrs, [&] (mlir_type type) {
+                return !is_legal(op, type);
+            });
+            illegal_attrs[attrs] = illegal;
+            return !illegal;
+        }
+
+      private:
+        mlir::DataLayoutAnalysis dla;
+
+        // Converter used by patterns.
+        tc::llvm_type_converter type_converter;
+        // Converter deciding legality, it lowers with the default options.
+        tc::llvm_type_converter legality_converter;
+
+        llvm::DenseMap< mlir_type, bool > legal_types;
+        llvm::DenseMap< mlir::DictionaryAttr, bool > illegal_attrs;
+    };
+
     template< typename op_t >
     struct llvm_conversion_pattern
         : operation_conversion_pattern< op_t >
@@ -57,17 +142,22 @@ namespace vast::conv::irstollvm
         using base = operation_conversion_pattern< op_t >;
         using base::base;
 
-        // const mlir::DataLayoutAnalysis &dl;
+        llvm_conversion_pattern(mcontext_t *mctx, llvm_conversion_state &state)
+            : base(mctx), state(&state)
+        {}
+
+        tc::llvm_type_converter &tc(operation from) const {
+            VAST_ASSERT(state);
+            return state->converter(from);
+        }
 
-        tc::llvm_type_converter tc(operation from) const {
-            auto dl = mlir::DataLayoutAnalysis(from);
-            tc::lower_to_llvm_options opts(from->getContext(), dl.getAtOrAbove(from));
-            return tc::llvm_type_converter(from->getContext(), dl, opts, from);
+        const mlir::DataLayout &data_layout(operation from) const {
+            VAST_ASSERT(state);
+            return state->data_layout(from);
         }
 
         mlir_type convert_type_to_type(operation from, mlir_type type) const {
-            auto t = tc(from);
-            return t.convert_type_to_type(type).value();
+            return tc(from).convert_type_to_type(type).value();
         }
 
         mlir_type convert_element_type(operation from, mlir_type type) const {
@@ -85,6 +175,9 @@ namespace vast::conv::irstollvm
                 loc, index_type, rewriter.getIntegerAttr(index_type, idx)
             );
         }
+
+      private:
+        llvm_conversion_state *state = nullptr;
     };
 
     template< typename op_t >
@@ -231,7 +324,7 @@ namespace vast::conv::irstollvm
             auto ptr = mlir::dyn_cast< hl::PointerType >(op.getRecord().getType());
             VAST_CHECK(ptr, "{0} is not a pointer to record!", op.getRecord().getType());
 
-            auto tc = this->tc(op);
+            auto &tc = this->tc(op);
 
             auto gep = rewriter.create< mlir::LLVM::GEPOp >(
                 op.getLoc(),
@@ -283,8 +376,7 @@ namespace vast::conv::irstollvm
 
         std::size_t bw(operation op) const {
             VAST_ASSERT(op->getNumResults() == 1);
-            auto dl = mlir::DataLayoutAnalysis(op);
-            return dl.getAtOrAbove(op).getTypeSizeInBits(
+            return this->data_layout(op).getTypeSizeInBits(
                 convert_type_to_type(op, op->getResult(0).getType())
             );
         }
@@ -506,7 +598,7 @@ namespace vast::conv::irstollvm
         logical_result matchAndRewrite(
             op_t func_op, adaptor_t ops, conversion_rewriter &rewriter
         ) const override {
-            auto tc = this->tc(func_op);
+            auto &tc = this->tc(func_op);
             auto maybe_target_type = tc.convert_fn_t(func_op.getFunctionType());
             // TODO(irs-to-llvm): Handle varargs.
             auto maybe_signature = tc.get_conversion_signature(func_op, /* variadic */ true);
@@ -628,8 +720,7 @@ namespace vast::conv::irstollvm
             auto attr, auto op, conversion_rewriter &rewriter
         ) const {
             auto target_type = convert_type_to_type(op, attr.getType());
-            auto dla = mlir::DataLayoutAnalysis(op);
-            const auto &dl = dla.getAtOrAbove(op);
+            const auto &dl = this->data_layout(op);
             if (!target_type)
                 return {};
 
@@ -1399,8 +1490,7 @@ namespace vast::conv::irstollvm
             // TODO mimic: clang/lib/CodeGen/CGExprScalar.cpp:VisitUnaryExprOrTypeTraitExpr
             // This does not consider type alignment and VLA types
             auto target_type = convert_type_to_type(op, op.getType());
-            auto dla = mlir::DataLayoutAnalysis(op);
-            const auto &dl = dla.getAtOrAbove(op);
+            const auto &dl = this->data_layout(op);
             auto attr = rewriter.getIntegerAttr(
                 target_type, dl.getTypeSize(op.getArg())
             );
@@ -1458,7 +1548,7 @@ namespace vast::conv::irstollvm
             }
 
             // It does not have regions
-            auto tc = this->tc(op);
+            auto &tc = this->tc(op);
             return update_via_clone(rewriter, op, ops.getOperands(), tc);
         }
     };
@@ -1496,7 +1586,7 @@ namespace vast::conv::irstollvm
             }
 
             // TODO: What would it take to make this work `updateRootInPlace`?
-            auto tc = this->tc(op);
+            auto &tc = this->tc(op);
             return update_via_clone(rewriter, op, ops.getOperands(),tc);
         }
     };
@@ -1600,7 +1690,11 @@ namespace vast::conv::irstollvm
     {
         using base = ConversionPassMixin< IRsToLLVMPass, IRsToLLVMBase >;
 
-        static conversion_target create_conversion_target(mcontext_t &mctx) {
+        std::unique_ptr< llvm_conversion_state > state;
+
+        static conversion_target create_conversion_target(
+            mcontext_t &mctx, llvm_conversion_state &state
+        ) {
             conversion_target target(mctx);
 
             target.addIllegalDialect< hl::HighLevelDialect >();
@@ -1608,16 +1702,8 @@ namespace vast::conv::irstollvm
             target.addLegalDialect< core::CoreDialect >();
             target.addLegalDialect< mlir::LLVM::LLVMDialect >();
 
-            auto has_legal_return_type = [](auto op) {
-                auto dla = mlir::DataLayoutAnalysis(op);
-                auto opts = mk_default_opts(op->getContext());
-                return tc::llvm_type_converter(op->getContext(), dla, opts, op).has_legal_return_type(op);
-            };
-
-            auto has_legal_operand_types = [](auto op) {
-                auto dla = mlir::DataLayoutAnalysis(op);
-                auto opts = mk_default_opts(op->getContext());
-                return tc::llvm_type_converter(op->getContext(), dla, opts, op).has_legal_operand_types(op);
+            auto has_legal_return_type = [state = &state] (operation op) {
+                return state->has_legal_return_type(op);
             };
 
             target.addDynamicallyLegalOp< core::LazyOp    >(has_legal_return_type);
@@ -1625,23 +1711,49 @@ namespace vast::conv::irstollvm
             target.addDynamicallyLegalOp< core::BinLOrOp  >(has_legal_return_type);
             target.addDynamicallyLegalOp< core::SelectOp  >(has_legal_return_type);
 
-            target.addDynamicallyLegalOp< hl::ValueYieldOp >([&](hl::ValueYieldOp op) {
-                return mlir::isa< core::LazyOp >(op->getParentOp()) && has_legal_operand_types(op);
+            target.addDynamicallyLegalOp< hl::ValueYieldOp >([state = &state] (hl::ValueYieldOp op) {
+                return mlir::isa< core::LazyOp >(op->getParentOp())
+                    && state->has_legal_operand_types(op);
             });
 
             target.addIllegalOp< mlir::func::FuncOp >();
 
-            target.markUnknownOpDynamicallyLegal([&] (auto op) {
-                auto dla = mlir::DataLayoutAnalysis(op);
-                auto opts = mk_default_opts(&mctx);
-                tc::llvm_type_converter tc(op->getContext(), dla, opts, op);
-                return tc.get_is_type_conversion_legal()(op);
+            target.markUnknownOpDynamicallyLegal([state = &state] (operation op) {
+                return state->is_type_conversion_legal(op);
             });
 
             return target;
         }
 
+        //
+        // Patterns and legality callbacks share the state of the conversion.
+        //
+        struct llvm_conversion_config : base_conversion_config
+        {
+            llvm_conversion_state &state;
+
+            template< typename pattern >
+            void add_pattern() {
+                if constexpr (std::is_constructible_v< pattern, mcontext_t *, llvm_conversion_state & >) {
+                    patterns.template add< pattern >(patterns.getContext(), state);
+                } else {
+                    patterns.template add< pattern >(patterns.getContext());
+                }
+            }
+        };
+
+        llvm_conversion_config make_config() {
+            auto &mctx = getContext();
+            state = std::make_unique< llvm_conversion_state >(getOperation());
+            return {
+                { rewrite_pattern_set(&mctx), create_conversion_target(mctx, *state) },
+                *state
+            };
+        }
+
         void run_after_conversion() {
+            state.reset();
+
             mcontext_t &mctx = getContext();
             conversion_target target(mctx);
 
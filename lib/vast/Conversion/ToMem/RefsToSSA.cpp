@@ -60,6 +60,9 @@ namespace vast::conv {
     {
         using base = ConversionPassMixin< RefsToSSAPass, RefsToSSABase >;
 
+        static constexpr bool cache_symbol_tables    = true;
+        static constexpr bool preserve_symbol_tables = true;
+
         static conversion_target create_conversion_target(mcontext_t &mctx) {
             return conversion_target(mctx);
         }
@@ -69,8 +72,22 @@ namespace vast::conv {
         }
     };
 
+    // Materializes the symbol tables enclosing functions once, before the
+    // nested passes run on them in parallel and only read the tables.
+    struct RefsToSSAModulePass : RefsToSSAModuleBase< RefsToSSAModulePass >
+    {
+        void runOnOperation() override {
+            getAnalysis< core::symbol_table_cache >().materialize_enclosing();
+            markAllAnalysesPreserved();
+        }
+    };
+
 } // namespace vast::conv
 
 std::unique_ptr< mlir::Pass > vast::createRefsToSSAPass() {
     return std::make_unique< vast::conv::RefsToSSAPass >();
 }
+
+std::unique_ptr< mlir::Pass > vast::createRefsToSSAModulePass() {
+    return std::make_unique< vast::conv::RefsToSSAModulePass >();
+}
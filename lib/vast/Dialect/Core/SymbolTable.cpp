@@ -70,51 +70,249 @@ namespace vast::core {
         auto symbol_name = mlir::cast< symbol >(op).getSymbolName();
         VAST_ASSERT(symbol_tables.contains(kind));
         symbol_tables[kind][symbol_name].push_back(op);
+        names[op] = symbol_name;
+    }
+
+    bool symbol_table::try_insert(operation op) {
+        if (!mlir::isa< symbol >(op) || names.contains(op)) {
+            return false;
+        }
+
+        for (const auto &[kind, _] : symbol_tables) {
+            if (op->getName().hasInterface(kind)) {
+                insert(kind, op);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool symbol_table::erase(operation op) {
+        auto it = names.find(op);
+        if (it == names.end()) {
+            return false;
+        }
+
+        for (auto &[_, table] : symbol_tables) {
+            auto bucket = table.find(it->second);
+            if (bucket == table.end()) {
+                continue;
+            }
+
+            auto &ops = bucket->second;
+            if (auto pos = llvm::find(ops, op); pos != ops.end()) {
+                ops.erase(pos);
+                if (ops.empty()) {
+                    table.erase(bucket);
+                }
+                break;
+            }
+        }
+
+        names.erase(it);
+        return true;
+    }
+
+    void symbol_table::rename(operation op) {
+        auto it = names.find(op);
+        if (it == names.end() || it->second == mlir::cast< symbol >(op).getSymbolName()) {
+            return;
+        }
+
+        erase(op);
+        try_insert(op);
     }
 
     string_ref symbol_attr_name() {
         return mlir::SymbolTable::getSymbolAttrName();
     }
 
-    std::optional< symbol_table > get_effective_symbol_table_for(
-        operation from, symbol_kind kind
-    ) {
+    operation get_effective_symbol_table_op_for(operation from, symbol_kind kind) {
         while (from) {
             if (auto table = mlir::dyn_cast_if_present< SymbolTableOpInterface >(from)) {
                 if (table.can_hold_symbol_kind(kind)) {
-                    return table.materialize();
+                    return from;
                 }
             }
             from = from->getParentOp();
         }
 
+        return {};
+    }
+
+    std::optional< symbol_table > get_effective_symbol_table_for(
+        operation from, symbol_kind kind
+    ) {
+        if (auto table = get_effective_symbol_table_op_for(from, kind)) {
+            return mlir::cast< SymbolTableOpInterface >(table).materialize();
+        }
+
         return std::nullopt;
     }
 
     //
-    // direct symbol uses
+    // symbol table cache
     //
 
-    auto direct_regions(region_ptr root) {
-        return vws::single(root);
+    namespace {
+
+        thread_local symbol_table_cache *active_symbol_table_cache = nullptr;
+
+        // Returns the table that keeps `op` when materialized, mirrors the
+        // lookup of symbols performed by `symbol_table` construction.
+        operation owning_table_op(operation op) {
+            auto parent = mlir::dyn_cast_if_present< symbol_table_op_interface >(op->getParentOp());
+            if (!parent) {
+                return {};
+            }
+
+            if (parent.can_hold_operation(op)) {
+                return parent;
+            }
+
+            // symbols unrecognized by the nested table are kept by its parent
+            auto grand = mlir::dyn_cast_if_present< symbol_table_op_interface >(
+                parent->getParentOp()
+            );
+            if (grand && grand.can_hold_operation(op)) {
+                return grand;
+            }
+
+            return {};
+        }
+
+    } // namespace
+
+    symbol_table &symbol_table_cache::get(operation table_op) {
+        auto &table = tables[table_op];
+        if (!table) {
+            table = std::make_unique< symbol_table >(
+                mlir::cast< symbol_table_op_interface >(table_op).materialize()
+            );
+
+            for (const auto &[op, _] : table->symbols()) {
+                owners[op] = table.get();
+            }
+        }
+
+        return *table;
+    }
+
+    const symbol_table *symbol_table_cache::find(operation table_op) const {
+        auto it = tables.find(table_op);
+        return it != tables.end() ? it->second.get() : nullptr;
+    }
+
+    void symbol_table_cache::materialize_enclosing() {
+        VAST_CHECK(root, "Symbol table cache without a root operation.");
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            if (op != root && op->hasTrait< mlir::OpTrait::IsIsolatedFromAbove >()) {
+                return walk_result::skip();
+            }
+
+            if (mlir::isa< symbol_table_op_interface >(op)) {
+                get(op);
+            }
+            return walk_result::advance();
+        });
+    }
+
+    const symbol_table &symbol_table_cache::resolve(operation table_op) {
+        if (outer && root && !root->isAncestor(table_op)) {
+            // Materializing the table here would race with other nested passes.
+            auto table = outer->find(table_op);
+            VAST_CHECK(table, "Enclosing symbol table is not materialized by the ancestor cache.");
+            return *table;
+        }
+
+        return get(table_op);
+    }
+
+    void symbol_table_cache::notify_inserted(operation op) {
+        if (!mlir::isa< symbol >(op)) {
+            return;
+        }
+
+        // moved symbols can change their owning table
+        forget(op);
+
+        if (auto table_op = owning_table_op(op)) {
+            if (auto it = tables.find(table_op); it != tables.end()) {
+                if (it->second->try_insert(op)) {
+                    owners[op] = it->second.get();
+                }
+            }
+        }
+    }
+
+    void symbol_table_cache::notify_erased(operation op) {
+        // Nested operations are erased together with the operation.
+        op->walk([&] (operation nested) {
+            forget(nested);
+
+            if (auto it = tables.find(nested); it != tables.end()) {
+                for (const auto &[sym, _] : it->second->symbols()) {
+                    owners.erase(sym);
+                }
+                tables.erase(it);
+            }
+        });
+    }
+
+    void symbol_table_cache::notify_renamed(operation op) {
+        if (auto it = owners.find(op); it != owners.end()) {
+            it->second->rename(op);
+        }
     }
 
-    auto direct_regions(operation root) -> gap::generator< region_ptr > {
-        for (auto &region : root->getRegions()) {
-            co_yield &region;
+    void symbol_table_cache::forget(operation op) {
+        if (auto it = owners.find(op); it != owners.end()) {
+            it->second->erase(op);
+            owners.erase(it);
         }
     }
 
-    using symbol_use = mlir::SymbolTable::SymbolUse;
+    void symbol_table_cache::clear() {
+        tables.clear();
+        owners.clear();
+    }
+
+    symbol_table_cache *symbol_table_cache::active() {
+        return active_symbol_table_cache;
+    }
+
+    symbol_table_cache::scope::scope(symbol_table_cache &cache)
+        : previous(std::exchange(active_symbol_table_cache, &cache))
+    {}
+
+    symbol_table_cache::scope::~scope() {
+        active_symbol_table_cache = previous;
+    }
+
+    void symbol_table_cache::listener::notifyOperationInserted(
+        operation op, mlir::OpBuilder::InsertPoint /* previous */
+    ) {
+        cache.notify_inserted(op);
+    }
+
+    void symbol_table_cache::listener::notifyOperationErased(operation op) {
+        cache.notify_erased(op);
+    }
+
+    void symbol_table_cache::listener::notifyOperationModified(operation op) {
+        cache.notify_renamed(op);
+    }
+
+    //
+    // symbol references
+    //
 
     string_attr get_symbol_name(operation op) {
         return op->getAttrOfType< string_attr >(symbol_attr_name());
     }
 
-    // FIXME: This is not nice. Can this be inferred from the symbol reference directly?
-    enum class reference_kind { var, type, func, label, member, enum_constant, elaborated_type };
-
-    reference_kind get_reference_kind(symbol_ref_attr attr) {
+    std::optional< reference_kind > try_get_reference_kind(symbol_ref_attr attr) {
         if (mlir::isa< var_symbol_ref_attr >(attr))
             return reference_kind::var;
         if (mlir::isa< type_symbol_ref_attr >(attr))
@@ -130,6 +328,13 @@ namespace vast::core {
         if (mlir::isa< elaborated_type_symbol_ref_attr >(attr))
             return reference_kind::elaborated_type;
 
+        return std::nullopt;
+    }
+
+    reference_kind get_reference_kind(symbol_ref_attr attr) {
+        if (auto kind = try_get_reference_kind(attr))
+            return *kind;
+
         VAST_UNREACHABLE("unrecognized reference kind");
     }
 
@@ -152,164 +357,286 @@ namespace vast::core {
         VAST_UNREACHABLE("unrecognized reference kind");
     }
 
-    bool is_reference_of(symbol_ref_attr attr, operation symbol) {
-        return get_reference_kind(attr) == get_reference_kind(symbol);
+    //
+    // symbol use index
+    //
+
+    namespace {
+
+        thread_local const symbol_use_index *active_symbol_use_index = nullptr;
+
+    } // namespace
+
+    symbol_use_index::symbol_use_index(operation root) : root(root) {
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            // The root encloses the scope, it is never a user within it.
+            if (op != root) {
+                index_references(op);
+            }
+        });
     }
 
-    symbol_ref_attr get_symbol_ref_attr(operation op, operation symbol) {
-        symbol_ref_attr result;
+    void symbol_use_index::index_references(operation op) {
+        llvm::SmallVector< use_key, 4 > seen;
         op->getAttrDictionary().walk< mlir::WalkOrder::PreOrder >(
             [&] (symbol_ref_attr attr) {
-                if (!is_reference_of(attr, symbol)) {
-                    return mlir::WalkResult::skip();
-                }
-
-                if (attr.getRootReference() == get_symbol_name(symbol)) {
-                    result = attr;
-                    return mlir::WalkResult::interrupt();
+                if (auto kind = try_get_reference_kind(attr)) {
+                    use_key key{ attr.getRootReference(), static_cast< unsigned >(*kind) };
+                    // Only the first reference to a symbol counts as its use.
+                    if (!llvm::is_contained(seen, key)) {
+                        seen.push_back(key);
+                        uses[key].push_back(symbol_use{ op, attr });
+                    }
                 }
 
                 // Don't walk nested references.
                 return mlir::WalkResult::skip();
             }
         );
-
-        return result;
     }
 
-    struct symbol_scope {
-        // The first effective operation in the scope
-        // allows to reduce the search space in the region.
+    namespace {
+
+        // Predicates selecting users of a symbol within the queried scope,
+        // shared by the index and by the scoped walk.
+        //
+        // If the symbol is defined in an ancestor region of the scope, direct
+        // uses are searched in the region of the symbol definition from the
+        // definition onwards, otherwise in the immediate regions of the scope.
+        // Nested uses are searched in regions nested in the scope.
+
+        using user_filter = llvm::function_ref< bool(operation) >;
+
+        // Functions are visible through their declarations, hence they are
+        // used even before their definition.
+        bool precedes_definition(operation symbol, operation user) {
+            // TBD: use proper dominance analysis
+            return !mlir::isa< func_symbol >(symbol)
+                && user->getBlock() == symbol->getBlock()
+                && !symbol->isBeforeInBlock(user);
+        }
+
+        region_ptr direct_uses_region(operation symbol, operation scope) {
+            auto symbol_region = symbol->getParentRegion();
+            auto scope_region  = scope->getParentRegion();
+            return scope_region && symbol_region->isAncestor(scope_region) ? symbol_region : nullptr;
+        }
+
+        bool is_direct_user(operation symbol, operation scope, operation user) {
+            if (auto region = direct_uses_region(symbol, scope)) {
+                return user->getParentRegion() == region;
+            }
+            return user->getParentOp() == scope;
+        }
+
+        bool is_direct_user(region_ptr scope, operation user) {
+            return user->getParentRegion() == scope;
+        }
+
+        bool is_nested_user(operation symbol, operation scope, operation user) {
+            return symbol->getParentRegion()->isAncestor(user->getParentRegion())
+                && scope->isProperAncestor(user);
+        }
+
+        // Operations placed directly in the region are not users, only
+        // operations in regions nested in it.
+        bool is_nested_user(operation symbol, region_ptr scope, operation user) {
+            auto user_region = user->getParentRegion();
+            return user_region != scope
+                && symbol->getParentRegion()->isAncestor(user_region)
+                && scope->isAncestor(user_region);
+        }
+
+        // The first reference of `symbol` in attributes of `op`.
+        symbol_ref_attr get_symbol_ref_attr(operation op, operation symbol) {
+            auto name = get_symbol_name(symbol);
+            auto kind = get_reference_kind(symbol);
+
+            symbol_ref_attr result;
+            op->getAttrDictionary().walk< mlir::WalkOrder::PreOrder >(
+                [&] (symbol_ref_attr attr) {
+                    if (attr.getRootReference() == name && try_get_reference_kind(attr) == kind) {
+                        result = attr;
+                        return mlir::WalkResult::interrupt();
+                    }
+
+                    // Don't walk nested references.
+                    return mlir::WalkResult::skip();
+                }
+            );
+
+            return result;
+        }
+
         //
-        // Can be used if definition of symbol is in middle of region, we want
-        // to look at references only after the definition.
+        // Scoped walk answering a single query without an index, it visits
+        // only operations that can be users within the scope.
         //
-        // If scope_begin is not set, the scope is the region itself.
-        operation scope_begin;
-        region_ptr scope;
-    };
-
-    gap::generator< operation > operations(symbol_scope region) {
-        // TBD: use proper dominance analysis
-        for (auto &bb : *region.scope) {
-            for (auto &op : bb) {
-                if (&bb != region.scope_begin->getBlock()) {
-                    co_yield &op;
-                } else if (!region.scope_begin || region.scope_begin->isBeforeInBlock(&op)) {
-                    co_yield &op;
+        struct scoped_use_walk
+        {
+            operation symbol;
+            user_filter in_scope;
+            std::vector< mlir::SymbolTable::SymbolUse > out = {};
+
+            void visit(operation op) {
+                if (!in_scope(op) || precedes_definition(symbol, op)) {
+                    return;
+                }
+
+                if (auto attr = get_symbol_ref_attr(op, symbol)) {
+                    out.push_back({ op, attr });
+                }
+            }
+
+            void visit_direct(region_ptr region) {
+                for (auto &block : *region) {
+                    for (auto &op : block) {
+                        visit(&op);
+                    }
+                }
+            }
+
+            void visit_nested(region_ptr region) {
+                region->walk< mlir::WalkOrder::PreOrder >([&] (operation op) { visit(op); });
+            }
+
+            symbol_use_range take() { return symbol_use_range(std::move(out)); }
+        };
+
+    } // namespace
+
+    symbol_use_range symbol_use_index::collect(operation symbol, user_filter in_scope) const {
+        VAST_ASSERT(symbol);
+        std::vector< symbol_use > out;
+
+        use_key key{ get_symbol_name(symbol), static_cast< unsigned >(get_reference_kind(symbol)) };
+        if (auto it = uses.find(key); it != uses.end()) {
+            for (const auto &use : it->second) {
+                auto user = use.getUser();
+                if (in_scope(user) && !precedes_definition(symbol, user)) {
+                    out.push_back(use);
                 }
             }
         }
+
+        return symbol_use_range(std::move(out));
     }
 
-    std::optional< symbol_scope > constrain_ancestor_scope(operation scope, operation symbol) {
-        if (symbol->getParentRegion()->isAncestor(scope->getParentRegion()))
-            return symbol_scope{ symbol, symbol->getParentRegion() };
-        return std::nullopt;
+    symbol_use_range symbol_use_index::get_direct_symbol_uses(
+        operation symbol, operation scope
+    ) const {
+        return collect(symbol, [&] (operation user) {
+            return is_direct_user(symbol, scope, user);
+        });
     }
 
-    std::optional< symbol_scope > constrain_ancestor_scope(region_ptr scope, operation symbol) {
-        if (symbol->getParentRegion()->isAncestor(scope))
-            return symbol_scope{ symbol, scope };
-        return std::nullopt;
+    symbol_use_range symbol_use_index::get_direct_symbol_uses(
+        operation symbol, region_ptr scope
+    ) const {
+        return collect(symbol, [&] (operation user) { return is_direct_user(scope, user); });
     }
 
-    gap::generator< symbol_scope > symbol_scopes(auto scope, operation symbol) {
-        // If symbol is defined in ancestor region of scope, return the most immediate
-        // region and constrain it to scope from symbol definition ownwards
-        if (auto constrained = constrain_ancestor_scope(scope, symbol)) {
-            co_yield *constrained;
-        } else {
-            // Else symbol is defined above scope, therefore references can be anywhere in scope
-            for (auto region : direct_regions(scope)) {
-                co_yield symbol_scope{ nullptr, region };
-            }
-        }
+    symbol_use_range symbol_use_index::get_symbol_uses(operation symbol, operation scope) const {
+        return collect(symbol, [&] (operation user) {
+            return is_nested_user(symbol, scope, user);
+        });
     }
 
-    auto direct_symbol_uses_in_scope(operation symbol, symbol_scope scope)
-        -> gap::generator< symbol_use >
-    {
-        for (auto op : operations(scope)) {
-            if (auto symbol_ref = get_symbol_ref_attr(op, symbol)) {
-                co_yield symbol_use{ op, symbol_ref };
-            }
-        }
+    symbol_use_range symbol_use_index::get_symbol_uses(operation symbol, region_ptr scope) const {
+        return collect(symbol, [&] (operation user) {
+            return is_nested_user(symbol, scope, user);
+        });
     }
 
-    auto direct_symbol_uses_in_scope(operation symbol, auto scope)
-        -> gap::generator< symbol_use >
-    {
-        for (auto scope : symbol_scopes(scope, symbol)) {
-            for (auto use : direct_symbol_uses_in_scope(symbol, scope)) {
-                co_yield use;
-            }
-        }
+    bool symbol_use_index::covers(operation scope) const {
+        return root == scope || root->isProperAncestor(scope);
     }
 
+    bool symbol_use_index::covers(region_ptr scope) const {
+        return covers(scope->getParentOp());
+    }
 
-    namespace detail {
+    const symbol_use_index *symbol_use_index::active() {
+        return active_symbol_use_index;
+    }
 
-        symbol_use_range get_direct_symbol_uses_impl(operation symbol, auto root) {
-            VAST_ASSERT(symbol);
-            std::vector< symbol_use > uses;
+    symbol_use_index::scope::scope(const symbol_use_index &index)
+        : previous(std::exchange(active_symbol_use_index, &index))
+    {}
 
-            for (auto use : direct_symbol_uses_in_scope(symbol, root)) {
-                uses.push_back(use);
-            }
+    symbol_use_index::scope::~scope() {
+        active_symbol_use_index = previous;
+    }
 
-            return symbol_use_range(std::move(uses));
-        }
+    //
+    // Queries are answered by the active index if it holds the scope,
+    // otherwise by a walk of the scope, which is cheaper than indexing it for
+    // a single query.
+    //
 
-    } // namespace detail
+    //
+    // direct symbol uses
+    //
 
     symbol_use_range symbol_table::get_direct_symbol_uses(operation symbol, operation scope) {
-        return detail::get_direct_symbol_uses_impl(symbol, scope);
+        if (auto index = symbol_use_index::active(); index && index->covers(scope)) {
+            return index->get_direct_symbol_uses(symbol, scope);
+        }
+
+        auto in_scope = [&] (operation user) { return is_direct_user(symbol, scope, user); };
+        scoped_use_walk walk{ symbol, in_scope };
+
+        if (auto region = direct_uses_region(symbol, scope)) {
+            walk.visit_direct(region);
+        } else {
+            for (auto &region : scope->getRegions()) {
+                walk.visit_direct(&region);
+            }
+        }
+
+        return walk.take();
     }
 
     symbol_use_range symbol_table::get_direct_symbol_uses(operation symbol, region_ptr scope) {
-        return detail::get_direct_symbol_uses_impl(symbol, scope);
+        if (auto index = symbol_use_index::active(); index && index->covers(scope)) {
+            return index->get_direct_symbol_uses(symbol, scope);
+        }
+
+        auto in_scope = [&] (operation user) { return is_direct_user(scope, user); };
+        scoped_use_walk walk{ symbol, in_scope };
+        walk.visit_direct(scope);
+        return walk.take();
     }
 
     //
     // symbol uses
     //
 
-    namespace detail {
-
-        symbol_use_range get_symbol_uses_impl(operation symbol, auto scope) {
-            VAST_ASSERT(symbol);
-            std::vector< symbol_use > uses;
-
-            auto symbol_region = symbol->getParentRegion();
-            scope->walk([&](operation op) {
-                if (op->getNumRegions() == 0)
-                    return mlir::WalkResult::skip();
-
-                bool skip = true;
-                for (auto &region : op->getRegions()) {
-                    if (symbol_region->isAncestor(&region)) {
-                        for (auto use : direct_symbol_uses_in_scope(symbol, &region)) {
-                            uses.push_back(use);
-                        }
-                        skip = false;
-                    }
-                }
+    symbol_use_range symbol_table::get_symbol_uses(operation symbol, operation scope) {
+        if (auto index = symbol_use_index::active(); index && index->covers(scope)) {
+            return index->get_symbol_uses(symbol, scope);
+        }
 
-                return skip ? mlir::WalkResult::skip() : mlir::WalkResult::advance();
-            });
+        auto in_scope = [&] (operation user) { return is_nested_user(symbol, scope, user); };
+        scoped_use_walk walk{ symbol, in_scope };
 
-            return symbol_use_range(std::move(uses));
+        for (auto &region : scope->getRegions()) {
+            walk.visit_nested(&region);
         }
 
-    } // namespace detail
-
-    symbol_use_range symbol_table::get_symbol_uses(operation symbol, operation scope) {
-        return detail::get_symbol_uses_impl(symbol, scope);
+        return walk.take();
     }
 
     symbol_use_range symbol_table::get_symbol_uses(operation symbol, region_ptr scope) {
-        return detail::get_symbol_uses_impl(symbol, scope);
+        if (auto index = symbol_use_index::active(); index && index->covers(scope)) {
+            return index->get_symbol_uses(symbol, scope);
+        }
+
+        auto in_scope = [&] (operation user) { return is_nested_user(symbol, scope, user); };
+        scoped_use_walk walk{ symbol, in_scope };
+
+        walk.visit_nested(scope);
+        return walk.take();
     }
 
 
@@ -86,92 +86,282 @@ namespace vast::hl
         );
     }
 
-    FoldResult checked_int_arithmetic(mlir_type type, auto adaptor, auto &&op) {
-        if (auto lhs = mlir::dyn_cast_or_null< core::IntegerAttr >(adaptor.getLhs())) {
-            if (auto rhs = mlir::dyn_cast_or_null< core::IntegerAttr >(adaptor.getRhs())) {
-                if (auto result = op(lhs.getValue(), rhs.getValue())) {
-                    return core::IntegerAttr::get(type, result.value());
+    namespace {
+
+        using apint_result = std::optional< llvm::APInt >;
+
+        apint_result unless_overflow(llvm::APInt value, bool overflow) {
+            if (overflow) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        // Bit width of an integral `type` as recorded in the data layout of the
+        // enclosing module. Yields no value if the layout does not know the
+        // type, instead of failing as `mlir::DataLayout` queries do.
+        std::optional< unsigned > integral_width(operation op, mlir_type type) {
+            if (!isIntegerType(type) && !isBoolType(type)) {
+                return std::nullopt;
+            }
+
+            auto mod = op->getParentOfType< core::module >();
+            if (!mod || !mod.getDataLayoutSpec()) {
+                return std::nullopt;
+            }
+
+            std::optional< unsigned > exact, generic;
+            for (auto entry : mod.getDataLayoutSpec().getSpecForType(type.getTypeID())) {
+                auto raw = dl::DLEntry(entry);
+                if (raw.type == type) {
+                    exact = raw.bw;
+                } else if (!generic) {
+                    generic = raw.bw;
                 }
             }
+
+            return exact ? exact : generic;
+        }
+
+        std::optional< llvm::APInt > integral_value(mlir_attr attr) {
+            if (auto value = mlir::dyn_cast_or_null< core::IntegerAttr >(attr)) {
+                return value.getValue();
+            }
+            if (auto value = mlir::dyn_cast_or_null< core::BooleanAttr >(attr)) {
+                return llvm::APInt(1, value.getValue());
+            }
+            return std::nullopt;
+        }
+
+        const llvm::fltSemantics &float_semantics(mlir_type type) {
+            return mlir::cast< mlir::FloatType >(to_std_float_type(type)).getFloatSemantics();
+        }
+
+        FoldResult truth_value(operation op, mlir_type type, bool value) {
+            if (isBoolType(type)) {
+                return core::BooleanAttr::get(type, value);
+            }
+
+            if (auto bw = integral_width(op, type)) {
+                return core::IntegerAttr::get(
+                    type, llvm::APSInt(llvm::APInt(*bw, value), isUnsigned(type))
+                );
+            }
+
+            return {};
+        }
+
+    } // namespace
+
+    //
+    // Folds an integer binary operation on constants of the result type.
+    // Signedness is taken from the result type, the attribute sign flag is not
+    // reliable. `op` yields no value if the operation has undefined behavior,
+    // in which case the operation is left as is.
+    //
+    FoldResult checked_int_arithmetic(auto self, auto adaptor, auto &&op) {
+        auto type = self.getResult().getType();
+        if (!isIntegerType(type)) {
+            return {};
+        }
+
+        auto lhs = mlir::dyn_cast_or_null< core::IntegerAttr >(adaptor.getLhs());
+        auto rhs = mlir::dyn_cast_or_null< core::IntegerAttr >(adaptor.getRhs());
+        if (!lhs || !rhs || lhs.getType() != type || rhs.getType() != type) {
+            return {};
+        }
+
+        const llvm::APInt &lval = lhs.getValue();
+        const llvm::APInt &rval = rhs.getValue();
+        if (lval.getBitWidth() != rval.getBitWidth()) {
+            return {};
+        }
+
+        bool is_signed = isSigned(type);
+        if (auto result = op(lval, rval, is_signed)) {
+            return core::IntegerAttr::get(type, llvm::APSInt(result.value(), !is_signed));
         }
 
         return {};
     }
 
-    namespace {
+    //
+    // Shifts are undefined for negative amounts and amounts not less than the
+    // width of the promoted left operand. Signed left shifts are in addition
+    // undefined for negative values and for results not representable in the
+    // result type.
+    //
+    FoldResult checked_shift(auto self, auto adaptor, auto &&op) {
+        auto type = self.getResult().getType();
+        auto amount_type = self.getRhs().getType();
+        if (!isIntegerType(type) || !isIntegerType(amount_type)) {
+            return {};
+        }
 
-        FoldResult fold_integral_cast(auto &self, auto adaptor) {
-            if (self.getResult().getType() == self.getValue().getType())
-                return self.getValue();
+        auto lhs = mlir::dyn_cast_or_null< core::IntegerAttr >(adaptor.getLhs());
+        auto rhs = mlir::dyn_cast_or_null< core::IntegerAttr >(adaptor.getRhs());
+        if (!lhs || !rhs || lhs.getType() != type) {
             return {};
         }
 
-    } // namespace
+        const llvm::APInt &value  = lhs.getValue();
+        const llvm::APInt &amount = rhs.getValue();
+        if (isSigned(amount_type) && amount.isNegative()) {
+            return {};
+        }
+
+        if (amount.uge(value.getBitWidth())) {
+            return {};
+        }
+
+        bool is_signed = isSigned(type);
+        if (auto result = op(value, unsigned(amount.getZExtValue()), is_signed)) {
+            return core::IntegerAttr::get(type, llvm::APSInt(result.value(), !is_signed));
+        }
 
-    FoldResult ImplicitCastOp::fold(FoldAdaptor adaptor) {
-        if (getKind() == CastKind::IntegralCast)
-            return fold_integral_cast(*this, adaptor);
         return {};
     }
 
-    FoldResult AddIOp::fold(FoldAdaptor /* adaptor */) { 
-        return {}; 
+    //
+    // Folds a floating binary operation on constants of the result type,
+    // rounding to nearest. Invalid operations (producing NaN from non-NaN
+    // operands) are left as is.
+    //
+    FoldResult checked_float_arithmetic(auto self, auto adaptor, auto &&op) {
+        auto type = self.getResult().getType();
+        if (!isFloatingType(type)) {
+            return {};
+        }
+
+        auto lhs = mlir::dyn_cast_or_null< core::FloatAttr >(adaptor.getLhs());
+        auto rhs = mlir::dyn_cast_or_null< core::FloatAttr >(adaptor.getRhs());
+        if (!lhs || !rhs || lhs.getType() != type || rhs.getType() != type) {
+            return {};
+        }
+
+        llvm::APFloat result = lhs.getValue();
+        const llvm::APFloat &rval = rhs.getValue();
+        if (&result.getSemantics() != &rval.getSemantics()) {
+            return {};
+        }
+
+        if (op(result, rval) & llvm::APFloat::opInvalidOp) {
+            return {};
+        }
+
+        return core::FloatAttr::get(type, result);
     }
 
-    FoldResult SubIOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult AddIOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool is_signed) {
+            bool overflow = false;
+            return is_signed ? unless_overflow(lhs.sadd_ov(rhs, overflow), overflow)
+                             : apint_result(lhs + rhs);
+        });
     }
 
-    FoldResult AddFOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult SubIOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool is_signed) {
+            bool overflow = false;
+            return is_signed ? unless_overflow(lhs.ssub_ov(rhs, overflow), overflow)
+                             : apint_result(lhs - rhs);
+        });
     }
 
-    FoldResult SubFOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult AddFOp::fold(FoldAdaptor adaptor) {
+        return checked_float_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs) {
+            return lhs.add(rhs, llvm::APFloat::rmNearestTiesToEven);
+        });
     }
 
-    FoldResult MulIOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult SubFOp::fold(FoldAdaptor adaptor) {
+        return checked_float_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs) {
+            return lhs.subtract(rhs, llvm::APFloat::rmNearestTiesToEven);
+        });
     }
 
-    FoldResult MulFOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult MulIOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool is_signed) {
+            bool overflow = false;
+            return is_signed ? unless_overflow(lhs.smul_ov(rhs, overflow), overflow)
+                             : apint_result(lhs * rhs);
+        });
     }
 
-    FoldResult DivSOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult MulFOp::fold(FoldAdaptor adaptor) {
+        return checked_float_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs) {
+            return lhs.multiply(rhs, llvm::APFloat::rmNearestTiesToEven);
+        });
     }
 
-    FoldResult DivUOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    //
+    // Division and remainder by zero are undefined, folding them would hide
+    // the undefined behavior. The same holds for `INT_MIN / -1` and
+    // `INT_MIN % -1` of signed types.
+    //
+    FoldResult DivSOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            if (rhs.isZero()) {
+                return apint_result();
+            }
+            bool overflow = false;
+            return unless_overflow(lhs.sdiv_ov(rhs, overflow), overflow);
+        });
     }
 
-    FoldResult DivFOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult DivUOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            return rhs.isZero() ? apint_result() : apint_result(lhs.udiv(rhs));
+        });
     }
 
-    FoldResult RemSOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult DivFOp::fold(FoldAdaptor adaptor) {
+        return checked_float_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs) {
+            if (rhs.isZero()) {
+                return llvm::APFloat::opInvalidOp;
+            }
+            return lhs.divide(rhs, llvm::APFloat::rmNearestTiesToEven);
+        });
     }
 
-    FoldResult RemUOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult RemSOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            if (rhs.isZero() || (lhs.isMinSignedValue() && rhs.isAllOnes())) {
+                return apint_result();
+            }
+            return apint_result(lhs.srem(rhs));
+        });
     }
 
-    FoldResult RemFOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult RemUOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            return rhs.isZero() ? apint_result() : apint_result(lhs.urem(rhs));
+        });
     }
 
-    FoldResult BinXorOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult RemFOp::fold(FoldAdaptor adaptor) {
+        return checked_float_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs) {
+            // `mod` matches the semantics of C `fmod`.
+            return lhs.mod(rhs);
+        });
     }
 
-    FoldResult BinOrOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult BinXorOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            return apint_result(lhs ^ rhs);
+        });
     }
 
-    FoldResult BinAndOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult BinOrOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            return apint_result(lhs | rhs);
+        });
+    }
+
+    FoldResult BinAndOp::fold(FoldAdaptor adaptor) {
+        return checked_int_arithmetic(*this, adaptor, [] (auto &lhs, auto &rhs, bool) {
+            return apint_result(lhs & rhs);
+        });
     }
 
     FoldResult BinLAndOp::fold(FoldAdaptor /* adaptor */) {
@@ -183,19 +373,245 @@ namespace vast::hl
     }
 
     FoldResult BinComma::fold(FoldAdaptor /* adaptor */) {
+        // The left operand is evaluated by its own defining operations.
+        if (getRhs().getType() == getResult().getType()) {
+            return getRhs();
+        }
         return {};
     }
 
-    FoldResult BinShlOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult BinShlOp::fold(FoldAdaptor adaptor) {
+        return checked_shift(*this, adaptor, [] (auto &value, unsigned amount, bool is_signed) {
+            if (!is_signed) {
+                return apint_result(value.shl(amount));
+            }
+
+            if (value.isNegative()) {
+                return apint_result();
+            }
+
+            bool overflow = false;
+            return unless_overflow(value.sshl_ov(amount, overflow), overflow);
+        });
     }
 
-    FoldResult BinLShrOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult BinLShrOp::fold(FoldAdaptor adaptor) {
+        return checked_shift(*this, adaptor, [] (auto &value, unsigned amount, bool) {
+            return apint_result(value.lshr(amount));
+        });
     }
 
-    FoldResult BinAShrOp::fold(FoldAdaptor /* adaptor */) {
-        return {};
+    FoldResult BinAShrOp::fold(FoldAdaptor adaptor) {
+        return checked_shift(*this, adaptor, [] (auto &value, unsigned amount, bool) {
+            return apint_result(value.ashr(amount));
+        });
+    }
+
+    //===----------------------------------------------------------------------===//
+    // CmpOps
+    //===----------------------------------------------------------------------===//
+
+    namespace {
+
+        bool compare(Predicate predicate, const llvm::APInt &lhs, const llvm::APInt &rhs) {
+            switch (predicate) {
+                case Predicate::eq:  return lhs.eq(rhs);
+                case Predicate::ne:  return lhs.ne(rhs);
+                case Predicate::slt: return lhs.slt(rhs);
+                case Predicate::sle: return lhs.sle(rhs);
+                case Predicate::sgt: return lhs.sgt(rhs);
+                case Predicate::sge: return lhs.sge(rhs);
+                case Predicate::ult: return lhs.ult(rhs);
+                case Predicate::ule: return lhs.ule(rhs);
+                case Predicate::ugt: return lhs.ugt(rhs);
+                case Predicate::uge: return lhs.uge(rhs);
+            }
+            VAST_UNREACHABLE("unknown comparison predicate");
+        }
+
+        bool compare(FPredicate predicate, const llvm::APFloat &lhs, const llvm::APFloat &rhs) {
+            using cmp = llvm::APFloat::cmpResult;
+            auto result = lhs.compare(rhs);
+
+            auto unordered = result == cmp::cmpUnordered;
+            auto eq = result == cmp::cmpEqual;
+            auto lt = result == cmp::cmpLessThan;
+            auto gt = result == cmp::cmpGreaterThan;
+
+            switch (predicate) {
+                case FPredicate::ffalse: return false;
+                case FPredicate::oeq:    return eq;
+                case FPredicate::ogt:    return gt;
+                case FPredicate::oge:    return gt || eq;
+                case FPredicate::olt:    return lt;
+                case FPredicate::ole:    return lt || eq;
+                case FPredicate::one:    return lt || gt;
+                case FPredicate::ord:    return !unordered;
+                case FPredicate::uno:    return unordered;
+                case FPredicate::ueq:    return unordered || eq;
+                case FPredicate::ugt:    return unordered || gt;
+                case FPredicate::uge:    return unordered || gt || eq;
+                case FPredicate::ult:    return unordered || lt;
+                case FPredicate::ule:    return unordered || lt || eq;
+                case FPredicate::une:    return !eq;
+                case FPredicate::ftrue:  return true;
+            }
+            VAST_UNREACHABLE("unknown floating comparison predicate");
+        }
+
+    } // namespace
+
+    FoldResult CmpOp::fold(FoldAdaptor adaptor) {
+        auto lhs = integral_value(adaptor.getLhs());
+        auto rhs = integral_value(adaptor.getRhs());
+        if (!lhs || !rhs || lhs->getBitWidth() != rhs->getBitWidth()) {
+            return {};
+        }
+
+        return truth_value(*this, getResult().getType(), compare(getPredicate(), *lhs, *rhs));
+    }
+
+    FoldResult FCmpOp::fold(FoldAdaptor adaptor) {
+        auto lhs = mlir::dyn_cast_or_null< core::FloatAttr >(adaptor.getLhs());
+        auto rhs = mlir::dyn_cast_or_null< core::FloatAttr >(adaptor.getRhs());
+        if (!lhs || !rhs) {
+            return {};
+        }
+
+        const llvm::APFloat &lval = lhs.getValue();
+        const llvm::APFloat &rval = rhs.getValue();
+        if (&lval.getSemantics() != &rval.getSemantics()) {
+            return {};
+        }
+
+        return truth_value(*this, getResult().getType(), compare(getPredicate(), lval, rval));
+    }
+
+    //===----------------------------------------------------------------------===//
+    // CastOps
+    //===----------------------------------------------------------------------===//
+
+    namespace {
+
+        FoldResult fold_integral_cast(operation op, mlir_attr value, mlir_type from, mlir_type to) {
+            auto src = integral_value(value);
+            auto bw  = integral_width(op, to);
+            if (!src || !bw || !isIntegerType(to)) {
+                return {};
+            }
+
+            // Conversions to narrower signed types are implementation-defined,
+            // the value is truncated as by clang.
+            auto result = isSigned(from) ? src->sextOrTrunc(*bw) : src->zextOrTrunc(*bw);
+            return core::IntegerAttr::get(to, llvm::APSInt(result, isUnsigned(to)));
+        }
+
+        FoldResult fold_integral_to_floating(mlir_attr value, mlir_type from, mlir_type to) {
+            auto src = integral_value(value);
+            if (!src || !isFloatingType(to)) {
+                return {};
+            }
+
+            llvm::APFloat result(float_semantics(to));
+            result.convertFromAPInt(*src, isSigned(from), llvm::APFloat::rmNearestTiesToEven);
+            return core::FloatAttr::get(to, result);
+        }
+
+        FoldResult fold_floating_to_integral(operation op, mlir_attr value, mlir_type to) {
+            auto src = mlir::dyn_cast_or_null< core::FloatAttr >(value);
+            auto bw  = integral_width(op, to);
+            if (!src || !bw || !isIntegerType(to)) {
+                return {};
+            }
+
+            // Values not representable after truncation toward zero are
+            // undefined.
+            llvm::APSInt result(*bw, isUnsigned(to));
+            bool exact = false;
+            auto status = src.getValue().convertToInteger(
+                result, llvm::APFloat::rmTowardZero, &exact
+            );
+
+            if (status & llvm::APFloat::opInvalidOp) {
+                return {};
+            }
+
+            return core::IntegerAttr::get(to, result);
+        }
+
+        FoldResult fold_floating_cast(mlir_attr value, mlir_type to) {
+            auto src = mlir::dyn_cast_or_null< core::FloatAttr >(value);
+            if (!src || !isFloatingType(to)) {
+                return {};
+            }
+
+            llvm::APFloat result = src.getValue();
+            bool loses_info = false;
+            auto status = result.convert(
+                float_semantics(to), llvm::APFloat::rmNearestTiesToEven, &loses_info
+            );
+
+            if (status & (llvm::APFloat::opInvalidOp | llvm::APFloat::opOverflow)) {
+                return {};
+            }
+
+            return core::FloatAttr::get(to, result);
+        }
+
+        FoldResult fold_cast(auto self, auto adaptor) {
+            auto from = self.getValue().getType();
+            auto to   = self.getResult().getType();
+
+            auto kind = self.getKind();
+            if (from == to && (kind == CastKind::NoOp || kind == CastKind::IntegralCast)) {
+                return self.getValue();
+            }
+
+            auto value = adaptor.getValue();
+            if (!value) {
+                return {};
+            }
+
+            auto from_integral = isIntegerType(from) || isBoolType(from);
+
+            switch (kind) {
+                case CastKind::IntegralCast:
+                    if (!from_integral) {
+                        return {};
+                    }
+                    return fold_integral_cast(self, value, from, to);
+                case CastKind::IntegralToBoolean:
+                    if (auto src = integral_value(value); src && isBoolType(to)) {
+                        return core::BooleanAttr::get(to, !src->isZero());
+                    }
+                    return {};
+                case CastKind::IntegralToFloating:
+                    if (!from_integral) {
+                        return {};
+                    }
+                    return fold_integral_to_floating(value, from, to);
+                case CastKind::FloatingToIntegral:
+                    return fold_floating_to_integral(self, value, to);
+                case CastKind::FloatingToBoolean:
+                    if (auto src = mlir::dyn_cast< core::FloatAttr >(value); src && isBoolType(to)) {
+                        return core::BooleanAttr::get(to, !src.getValue().isZero());
+                    }
+                    return {};
+                case CastKind::FloatingCast:
+                    return fold_floating_cast(value, to);
+                default:
+                    return {};
+            }
+        }
+
+    } // namespace
+
+    FoldResult ImplicitCastOp::fold(FoldAdaptor adaptor) {
+        return fold_cast(*this, adaptor);
+    }
+
+    FoldResult CStyleCastOp::fold(FoldAdaptor adaptor) {
+        return fold_cast(*this, adaptor);
     }
 
     void build_logic_op(
@@ -26,6 +26,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/TypeUseIndex.hpp"
 
 #include "PassesDetails.hpp"
 
@@ -71,11 +72,13 @@ namespace vast::hl {
 
     struct LowerElaboratedTypes : ConversionPassMixin< LowerElaboratedTypes, LowerElaboratedTypesBase >
     {
-        static auto create_conversion_target(mcontext_t &mctx) {
+        static auto create_conversion_target(mcontext_t &mctx, type_use_index &types) {
             mlir::ConversionTarget trg(mctx);
 
-            trg.markUnknownOpDynamicallyLegal([](operation op) {
-                return !has_type_somewhere< hl::ElaboratedType >(op);
+            // Nested types are memoized by the index, so rechecking legality
+            // of rewritten operations does not walk their types again.
+            trg.markUnknownOpDynamicallyLegal([&types](operation op) {
+                return !types.mentions< hl::ElaboratedType >(op);
             });
 
             return trg;
@@ -83,7 +86,7 @@ namespace vast::hl {
 
         void runOnOperation() override {
             auto &mctx     = getContext();
-            auto target    = create_conversion_target(mctx);
+            auto target    = create_conversion_target(mctx, getAnalysis< type_use_index >());
             core::module op = getOperation();
 
             rewrite_pattern_set patterns(&mctx);
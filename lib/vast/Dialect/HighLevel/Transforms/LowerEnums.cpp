@@ -85,6 +85,9 @@ namespace vast::hl {
     {
         using base = ConversionPassMixin< LowerEnumRefsPass, LowerEnumRefsBase >;
 
+        static constexpr bool cache_symbol_tables    = true;
+        static constexpr bool preserve_symbol_tables = true;
+
         static conversion_target create_conversion_target(mcontext_t &mctx) {
             return conversion_target(mctx);
         }
@@ -99,6 +102,11 @@ namespace vast::hl {
     {
         using base = ConversionPassMixin< LowerEnumDeclsPass, LowerEnumDeclsBase >;
 
+        // Erased declarations are removed from the cache by the listener
+        // attached to the conversion.
+        static constexpr bool cache_symbol_tables    = true;
+        static constexpr bool preserve_symbol_tables = true;
+
         static conversion_target create_conversion_target(mcontext_t &mctx) {
             auto trg = conversion_target(mctx);
             trg.markUnknownOpDynamicallyLegal([](operation op) {
@@ -26,6 +26,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/TypeUseIndex.hpp"
 
 #include "PassesDetails.hpp"
 
@@ -94,11 +95,13 @@ namespace vast::hl {
 
     struct LowerTypeDefs : ConversionPassMixin< LowerTypeDefs, LowerTypeDefsBase >
     {
-        static auto create_conversion_target(mcontext_t &mctx) {
+        static auto create_conversion_target(mcontext_t &mctx, type_use_index &types) {
             mlir::ConversionTarget trg(mctx);
 
-            trg.markUnknownOpDynamicallyLegal([](operation op) {
-                return !has_type_somewhere< hl::TypedefType >(op);
+            // Nested types are memoized by the index, so rechecking legality
+            // of rewritten operations does not walk their types again.
+            trg.markUnknownOpDynamicallyLegal([&types](operation op) {
+                return !types.mentions< hl::TypedefType >(op);
             });
 
             trg.addIllegalOp< hl::TypeDefOp >();
@@ -108,7 +111,7 @@ namespace vast::hl {
 
         void runOnOperation() override {
             auto &mctx  = getContext();
-            auto target = create_conversion_target(mctx);
+            auto target = create_conversion_target(mctx, getAnalysis< type_use_index >());
             auto op     = getOperation();
 
             rewrite_pattern_set patterns(&mctx);
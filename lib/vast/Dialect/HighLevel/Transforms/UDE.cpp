@@ -9,11 +9,13 @@ VAST_RELAX_WARNINGS
 #include <mlir/Rewrite/FrozenRewritePatternSet.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
-VAST_UNRELAX_WARNINGS
 
-#include <gap/coro/generator.hpp>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
 
 #include <vast/Dialect/HighLevel/HighLevelUtils.hpp>
+#include <vast/Dialect/HighLevel/TypeUseIndex.hpp>
 #include <vast/Dialect/Core/Interfaces/TypeDefinitionInterface.hpp>
 
 #include <vast/Conversion/Common/Mixins.hpp>
@@ -23,8 +25,6 @@ VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
 
-#include <unordered_set>
-
 namespace vast::hl {
 
 #if !defined(NDEBUG)
@@ -36,109 +36,215 @@ namespace vast::hl {
 
     constexpr bool keep_only_if_used = false;
 
-    template< typename yield_t >
-    walk_result users(hl::FieldDeclOp decl, auto scope, yield_t &&yield) {
-        return hl::users(decl.getAggregate(), scope, std::forward< yield_t >(yield));
-    }
-
-    struct UDE : UDEBase< UDE >
-    {
-        using base = UDEBase< UDE >;
+    namespace {
 
-        std::unordered_set< operation > unused_cached;
+        bool keep(core::aggregate_interface op) { return keep_only_if_used; }
+        bool keep(hl::TypeDefOp op)             { return keep_only_if_used; }
+        bool keep(hl::TypeDeclOp op)            { return keep_only_if_used; }
 
-        bool keep(core::aggregate_interface op, auto scope) const {
-            return keep_only_if_used;
-        }
-
-        bool keep(hl::TypeDefOp op, auto scope)       const { return keep_only_if_used; }
-        bool keep(hl::TypeDeclOp op, auto scope)      const { return keep_only_if_used; }
-
-        // Mark field to be kept if the parent aggregate is kept
-        bool keep(hl::FieldDeclOp op, auto scope) const { return keep(op.getAggregate(), scope); }
-
-        bool keep(hl::FuncOp op, auto scope) const {
+        bool keep(hl::FuncOp op) {
             return !op.isDeclaration() && !util::has_attr< hl::AlwaysInlineAttr >(op);
         }
 
-        bool keep(hl::VarDeclOp op, auto scope) const {
+        bool keep(hl::VarDeclOp op) {
             VAST_CHECK(!op.hasExternalStorage() || op.getInitializer().empty(), "extern variable with initializer");
             return !op.hasExternalStorage();
         }
 
-        bool is_unused_impl(auto op, auto scope, auto &seen) {
-            if (keep(op, scope)) {
-                VAST_UDE_DEBUG("keep: {0}", *op);
-                return false;
+        //
+        // Graph of declarations that may be eliminated. An edge leads from
+        // a declaration to every declaration it refers to, directly or from
+        // its nested operations. References made outside of any declaration
+        // and references of kept declarations lead from the `root` node.
+        //
+        // A declaration is used if it is reachable from the `root`.
+        //
+        struct def_use_graph
+        {
+            using node_id   = unsigned;
+            using node_list = llvm::SmallVector< node_id, 2 >;
+
+            static constexpr node_id root = 0;
+
+            def_use_graph(core::ModuleOp mod, type_use_index &types) : types(types) {
+                deps.emplace_back();
+
+                mod->walk([&] (operation op) { register_definition(op); });
+
+                for (auto &op : mod.getOps()) {
+                    collect(&op, root);
+                }
             }
 
-            auto result = hl::users(op, scope, [&](operation user) -> walk_result {
-                VAST_UDE_DEBUG("user: {0} of {1}", *user, *op);
-                // Ignore top-level use
-                if (user == scope) {
-                    return walk_result::advance();
+            // Marks declarations reachable from the `root`.
+            std::vector< bool > live() const {
+                std::vector< bool > out(deps.size(), false);
+                std::vector< node_id > worklist = { root };
+                out[root] = true;
+
+                while (!worklist.empty()) {
+                    auto node = worklist.back();
+                    worklist.pop_back();
+
+                    for (auto dep : deps[node]) {
+                        if (!out[dep]) {
+                            out[dep] = true;
+                            worklist.push_back(dep);
+                        }
+                    }
                 }
 
-                if (is_unused(user, scope, seen)) {
-                    VAST_UDE_DEBUG("unused user: {0}", *user);
-                    return walk_result::advance();
+                return out;
+            }
+
+            std::optional< node_id > node(operation op) const {
+                if (auto it = nodes.find(op); it != nodes.end()) {
+                    return it->second;
                 }
+                return std::nullopt;
+            }
 
-                // If the user is an always inlined function that is not used,
-                // we mark it as unused.
-                if (auto parent = user->template getParentOfType< hl::FuncOp >()) {
-                    if (is_unused(parent, scope, seen)) {
-                        VAST_UDE_DEBUG("user in always inlined function: {0}", *user);
-                        return walk_result::advance();
-                    }
+          private:
+            static bool is_declaration(operation op) {
+                return mlir::isa<
+                    core::aggregate_interface, hl::TypeDefOp, hl::TypeDeclOp,
+                    hl::FuncOp, hl::VarDeclOp
+                >(op);
+            }
+
+            static bool is_kept(operation op) {
+                return llvm::TypeSwitch< operation, bool >(op)
+                    .Case([&] (core::aggregate_interface op) { return keep(op); })
+                    .Case([&] (hl::TypeDefOp op)  { return keep(op); })
+                    .Case([&] (hl::TypeDeclOp op) { return keep(op); })
+                    .Case([&] (hl::FuncOp op)     { return keep(op); })
+                    .Case([&] (hl::VarDeclOp op)  { return keep(op); })
+                    .Default([&] (operation) { return true; });
+            }
+
+            void register_definition(operation op) {
+                if (!is_declaration(op)) {
+                    return;
                 }
 
-                // We interrupt the walk if the operation is used
-                return walk_result::interrupt();
-            });
+                auto id = node_id(deps.size());
+                deps.emplace_back();
+                nodes[op] = id;
+
+                llvm::TypeSwitch< operation >(op)
+                    .Case([&] (core::aggregate_interface op) {
+                        records[op.getDefinedName()].push_back(id);
+                    })
+                    .Case([&] (hl::TypeDefOp op)  { typedefs[op.getSymName()].push_back(id); })
+                    .Case([&] (hl::TypeDeclOp op) { records[op.getSymName()].push_back(id); })
+                    .Case([&] (hl::FuncOp op)     { functions[op.getSymbolName()].push_back(id); })
+                    .Case([&] (hl::VarDeclOp op)  { vars[op.getSymbolName()].push_back(id); });
+            }
 
-            // Operation is used if the walk was interrupted so we need to keep it.
-            return !result.wasInterrupted();
-        }
+            // Node whose liveness decides whether references made by `op`
+            // count. `enclosing` is the node of the closest function or the
+            // `root` outside of functions.
+            node_id source(operation op, node_id enclosing) {
+                if (auto field = mlir::dyn_cast< hl::FieldDeclOp >(op)) {
+                    return nodes.lookup(field.getAggregate().getOperation());
+                }
 
-        bool is_unused(operation op, auto scope, auto &seen) {
-            if (unused_cached.contains(op)) {
-                VAST_UDE_DEBUG("cached: {0}", *op);
-                return true;
+                if (!is_declaration(op)) {
+                    return enclosing;
+                }
+
+                if (!is_kept(op)) {
+                    return nodes.lookup(op);
+                }
+
+                // Kept declarations nested in a function live with it.
+                if (enclosing != root) {
+                    return enclosing;
+                }
+
+                add_edge(root, nodes.lookup(op));
+                return nodes.lookup(op);
             }
 
-            if (const auto [_, inserted] = seen.insert(op); !inserted) {
-                VAST_UDE_DEBUG("recursive: {0}", *op);
-                // Already processed, the operation has recursive dependency.
-                // We can safely return true here, as some other user
-                // needs to determine if the operation is to be kept.
-                return true;
+            void collect(operation op, node_id enclosing) {
+                auto from = source(op, enclosing);
+
+                for (auto type : types.mentioned_types(op)) {
+                    if (auto td = mlir::dyn_cast< hl::TypedefType >(type)) {
+                        add_edges(from, lookup(typedefs, td.getName()));
+                    } else if (auto rt = mlir::dyn_cast< hl::RecordType >(type)) {
+                        add_edges(from, lookup(records, rt.getName()));
+                    }
+                }
+
+                llvm::TypeSwitch< operation >(op)
+                    .Case([&] (hl::CallOp op) {
+                        add_edges(from, lookup(functions, op.getCallee()));
+                    })
+                    .Case([&] (hl::FuncRefOp op) {
+                        add_edges(from, lookup(functions, op.getFunction()));
+                    })
+                    .Case([&] (hl::DeclRefOp op) {
+                        add_edges(from, lookup(vars, op.getName()));
+                    });
+
+                auto nested = mlir::isa< hl::FuncOp >(op) ? nodes.lookup(op) : enclosing;
+                for (auto &region : op->getRegions()) {
+                    for (auto &child : region.getOps()) {
+                        collect(&child, nested);
+                    }
+                }
             }
 
-            VAST_UDE_DEBUG("processing: {0}", *op);
-            bool result = llvm::TypeSwitch< operation, bool >(op)
-                .Case([&](core::aggregate_interface op) {
-                    return is_unused_impl(op, scope, seen);
-                })
-                .Case([&](hl::FieldDeclOp op)     { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::TypeDefOp op)       { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::TypeDeclOp op)      { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::FuncOp op)          { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::VarDeclOp op)       { return is_unused_impl(op, scope, seen); })
-                .Default([&](operation)           { return false; });
-
-            if (result) {
-                unused_cached.insert(op);
+            static llvm::ArrayRef< node_id > lookup(
+                const llvm::StringMap< node_list > &defs, string_ref name
+            ) {
+                if (auto it = defs.find(name); it != defs.end()) {
+                    return it->second;
+                }
+                return {};
             }
 
-            return result;
-        }
+            void add_edge(node_id from, node_id to) {
+                auto &out = deps[from];
+                // Self references and repeated references from consecutive
+                // operations do not change reachability.
+                if (from != to && (out.empty() || out.back() != to)) {
+                    out.push_back(to);
+                }
+            }
+
+            void add_edges(node_id from, llvm::ArrayRef< node_id > to) {
+                for (auto dep : to) {
+                    add_edge(from, dep);
+                }
+            }
+
+            type_use_index &types;
+
+            llvm::DenseMap< operation, node_id > nodes;
+            std::vector< llvm::SmallVector< node_id, 4 > > deps;
+
+            llvm::StringMap< node_list > typedefs;
+            llvm::StringMap< node_list > records;
+            llvm::StringMap< node_list > functions;
+            llvm::StringMap< node_list > vars;
+        };
+
+    } // namespace
+
+    struct UDE : UDEBase< UDE >
+    {
+        using base = UDEBase< UDE >;
+
+        std::vector< operation > gather_unused(core::ModuleOp scope) {
+            def_use_graph graph(scope, getAnalysis< type_use_index >());
+            auto live = graph.live();
 
-        std::vector< operation > gather_unused(auto scope) {
             std::vector< operation > unused_operations;
             for (auto &op : scope.getOps()) {
-                std::unordered_set< operation > seen;
-                if (is_unused(&op, scope, seen)) {
+                if (auto node = graph.node(&op); node && !live[*node]) {
+                    VAST_UDE_DEBUG("unused: {0}", op);
                     unused_operations.push_back(&op);
                 }
             }
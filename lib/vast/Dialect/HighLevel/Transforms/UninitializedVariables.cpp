@@ -0,0 +1,34 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+#include "vast/Analysis/Dataflow/UninitializedVariables.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl {
+
+    struct UninitializedVariables : UninitializedVariablesBase< UninitializedVariables >
+    {
+        using base = UninitializedVariablesBase< UninitializedVariables >;
+
+        void runOnOperation() override {
+            for (auto [use, var, on_all_paths] : dataflow::uninitialized_uses(getOperation())) {
+                auto diag = use->emitWarning()
+                    << "variable '" << var.getSymName() << "' "
+                    << (on_all_paths ? "is" : "may be")
+                    << " uninitialized when used here";
+                diag.attachNote(var.getLoc()) << "variable declared here";
+            }
+
+            markAllAnalysesPreserved();
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createUninitializedVariablesPass() {
+        return std::make_unique< UninitializedVariables >();
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,30 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+#include "vast/Analysis/Dataflow/Reachability.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl {
+
+    struct UnreachableCode : UnreachableCodeBase< UnreachableCode >
+    {
+        using base = UnreachableCodeBase< UnreachableCode >;
+
+        void runOnOperation() override {
+            for (auto op : dataflow::unreachable_code(getOperation())) {
+                op->emitWarning("code will never be executed");
+            }
+
+            markAllAnalysesPreserved();
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createUnreachableCodePass() {
+        return std::make_unique< UnreachableCode >();
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,129 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/TypeUseIndex.hpp"
+
+#include "vast/Dialect/Core/Interfaces/FunctionInterface.hpp"
+
+namespace vast::hl {
+
+    namespace {
+
+        bool is_named_type(mlir_type type) {
+            return mlir::isa<
+                hl::TypedefType, hl::RecordType, hl::EnumType, hl::ElaboratedType
+            >(type);
+        }
+
+        llvm::ArrayRef< operation > lookup(
+            const llvm::StringMap< std::vector< operation > > &users, string_ref name
+        ) {
+            if (auto it = users.find(name); it != users.end()) {
+                return it->second;
+            }
+            return {};
+        }
+
+        // Named types nested in the uniqued `entity`, walked only once.
+        template< typename memo_t >
+        const auto &memoized(memo_t &memo, auto entity) {
+            auto [it, inserted] = memo.try_emplace(entity.getAsOpaquePointer());
+            if (inserted) {
+                entity.walk([&, &out = it->second] (mlir_type sub) {
+                    if (is_named_type(sub)) {
+                        out.push_back(sub);
+                    }
+                });
+            }
+            return it->second;
+        }
+
+        void add_user(std::vector< operation > &users, operation op) {
+            // An operation may mention the same name several times.
+            if (users.empty() || users.back() != op) {
+                users.push_back(op);
+            }
+        }
+
+    } // namespace
+
+    type_use_index::type_use_index(operation root) {
+        root->walk([&] (operation op) {
+            for_each_mentioned_type(op, [&] (mlir_type type) {
+                if (auto td = mlir::dyn_cast< hl::TypedefType >(type)) {
+                    add_user(typedefs[td.getName()], op);
+                } else if (auto rt = mlir::dyn_cast< hl::RecordType >(type)) {
+                    add_user(records[rt.getName()], op);
+                }
+                return true;
+            });
+        });
+    }
+
+    llvm::ArrayRef< operation > type_use_index::typedef_users(string_ref name) const {
+        return lookup(typedefs, name);
+    }
+
+    llvm::ArrayRef< operation > type_use_index::record_users(string_ref name) const {
+        return lookup(records, name);
+    }
+
+    llvm::ArrayRef< operation > type_use_index::users(hl::TypeDefOp op) const {
+        return typedef_users(op.getSymName());
+    }
+
+    llvm::ArrayRef< operation > type_use_index::users(hl::TypeDeclOp op) const {
+        return record_users(op.getSymName());
+    }
+
+    llvm::ArrayRef< operation > type_use_index::users(core::aggregate_interface op) const {
+        return record_users(op.getDefinedName());
+    }
+
+    llvm::SmallVector< mlir_type, 4 > type_use_index::mentioned_types(operation op) {
+        llvm::SmallVector< mlir_type, 4 > out;
+        for_each_mentioned_type(op, [&] (mlir_type type) {
+            out.push_back(type);
+            return true;
+        });
+        return out;
+    }
+
+    bool type_use_index::for_each_mentioned_type(
+        operation op, llvm::function_ref< bool(mlir_type) > yield
+    ) {
+        auto all_of = [&] (const named_types_t &types) {
+            return llvm::all_of(types, yield);
+        };
+
+        for (auto type : op->getResultTypes()) {
+            if (!all_of(named_types(type))) {
+                return false;
+            }
+        }
+
+        for (auto type : op->getOperandTypes()) {
+            if (!all_of(named_types(type))) {
+                return false;
+            }
+        }
+
+        if (!all_of(named_types(op->getAttrDictionary()))) {
+            return false;
+        }
+
+        if (auto fn = mlir::dyn_cast< core::function_op_interface >(op)) {
+            return all_of(named_types(fn.getFunctionType()));
+        }
+
+        return true;
+    }
+
+    auto type_use_index::named_types(mlir_type type) -> const named_types_t & {
+        return memoized(nested, type);
+    }
+
+    auto type_use_index::named_types(mlir_attr attr) -> const named_types_t & {
+        return memoized(nested, attr);
+    }
+
+} // namespace vast::hl
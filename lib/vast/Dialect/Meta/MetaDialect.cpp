@@ -3,8 +3,6 @@
 #include "vast/Dialect/Meta/MetaDialect.hpp"
 #include "vast/Dialect/Meta/MetaAttributes.hpp"
 
-#include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
-
 namespace vast::meta
 {
     void MetaDialect::initialize() {
@@ -29,17 +27,35 @@ namespace vast::meta
         op->removeAttr(identifier_name);
     }
 
-    bool has_identifier(operation op, identifier_t id) {
+    std::optional< identifier_t > get_identifier(operation op) {
         if (auto attr = op->getAttr(identifier_name)) {
-            return mlir::cast< IdentifierAttr >(attr).getValue() == id;
+            return mlir::cast< IdentifierAttr >(attr).getValue();
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional< identifier_t > get_location_identifier(loc_t loc) {
+        while (auto opaque = mlir::dyn_cast< mlir::OpaqueLoc >(loc)) {
+            loc = opaque.getFallbackLocation();
+        }
+
+        if (auto fused = mlir::dyn_cast< mlir::FusedLoc >(loc)) {
+            if (auto id = mlir::dyn_cast_or_null< IdentifierAttr >(fused.getMetadata())) {
+                return id.getValue();
+            }
         }
 
-        return false;
+        return std::nullopt;
+    }
+
+    bool has_identifier(operation op, identifier_t id) {
+        return get_identifier(op) == id;
     }
 
     std::vector< operation  > get_with_identifier(operation scope, identifier_t id) {
         std::vector< operation  > result;
-        core::symbols< core::symbol >(scope, [&](operation op) {
+        scope->walk([&](operation op) {
             if (has_identifier(op, id)) {
                 result.push_back(op);
             }
@@ -47,23 +63,16 @@ namespace vast::meta
         return result;
     }
 
-    std::vector< operation  > get_with_meta_location(operation scope, IdentifierAttr id) {
+    std::vector< operation  > get_with_meta_location(operation scope, identifier_t id) {
         std::vector< operation  > result;
         scope->walk([&](operation op) {
-            if (auto loc = mlir::dyn_cast< mlir::FusedLoc >(op->getLoc())) {
-                if (id == loc.getMetadata()) {
-                    result.push_back(op);
-                }
+            if (get_location_identifier(op->getLoc()) == id) {
+                result.push_back(op);
             }
         });
         return result;
     }
 
-    std::vector< operation  > get_with_meta_location(operation scope, identifier_t id) {
-        auto ctx = scope->getContext();
-        return get_with_meta_location(scope, IdentifierAttr::get(ctx, id));
-    }
-
 } // namespace vast::meta
 
 #include "vast/Dialect/Meta/MetaDialect.cpp.inc"
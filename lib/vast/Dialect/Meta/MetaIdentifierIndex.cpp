@@ -0,0 +1,73 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/Meta/MetaIdentifierIndex.hpp"
+#include "vast/Dialect/Meta/MetaAttributes.hpp"
+
+namespace vast::meta {
+
+    namespace {
+
+        llvm::ArrayRef< operation > lookup(
+            const llvm::DenseMap< identifier_t, llvm::SmallVector< operation, 1 > > &ops,
+            identifier_t id
+        ) {
+            if (auto it = ops.find(id); it != ops.end()) {
+                return it->second;
+            }
+            return {};
+        }
+
+    } // namespace
+
+    identifier_index::identifier_index(operation root) : indexed_root(root) {
+        root->walk([&] (operation op) {
+            if (auto id = get_identifier(op)) {
+                identifiers[*id].push_back(op);
+            }
+
+            if (auto id = get_location_identifier(op->getLoc())) {
+                locations[*id].push_back(op);
+            }
+        });
+    }
+
+    llvm::ArrayRef< operation > identifier_index::with_identifier(identifier_t id) const {
+        return lookup(identifiers, id);
+    }
+
+    llvm::ArrayRef< operation > identifier_index::with_meta_location(identifier_t id) const {
+        return lookup(locations, id);
+    }
+
+    std::vector< llvm::ArrayRef< operation > >
+    identifier_index::with_meta_locations(llvm::ArrayRef< identifier_t > ids) const {
+        std::vector< llvm::ArrayRef< operation > > result;
+        result.reserve(ids.size());
+        for (auto id : ids) {
+            result.push_back(with_meta_location(id));
+        }
+        return result;
+    }
+
+    void identifier_index::add_identifier(operation op, identifier_t id) {
+        remove_identifier(op);
+        meta::add_identifier(op, id);
+        identifiers[id].push_back(op);
+    }
+
+    void identifier_index::remove_identifier(operation op) {
+        auto id = get_identifier(op);
+        if (!id) {
+            return;
+        }
+
+        meta::remove_identifier(op);
+        if (auto it = identifiers.find(*id); it != identifiers.end()) {
+            llvm::erase(it->second, op);
+            if (it->second.empty()) {
+                identifiers.erase(it);
+            }
+        }
+    }
+
+} // namespace vast::meta
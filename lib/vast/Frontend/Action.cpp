@@ -67,11 +67,20 @@ namespace vast::cc {
         return ci.createDefaultOutputFile(false, in, get_output_stream_suffix(act));
     }
 
-    vast_stream_action::vast_stream_action(output_type act, const vast_args &vargs, mcontext_t &mctx)
-        : action(act), vargs(vargs), mctx(mctx)
+    vast_stream_action::vast_stream_action(
+        output_type act, const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines
+    )
+        : action(act), vargs(vargs), mctx(mctx), pipelines(pipelines)
     {}
 
     void vast_stream_action::ExecuteAction() {
+        // Units found in the module cache skip parsing and codegen.
+        if (consumer && (cache = module_cache::open(vargs))) {
+            if (consumer->compile_from_cache(cache.value())) {
+                return;
+            }
+        }
+
         // FIXME: if (getCurrentFileKind().getLanguage() != Language::CIR)
         frontend_action::ExecuteAction();
     }
@@ -85,7 +94,7 @@ namespace vast::cc {
         }
 
         auto result = std::make_unique< vast_stream_consumer >(
-            action, options(ci), vargs, mctx, std::move(out)
+            action, options(ci), vargs, mctx, std::move(out), ci, pipelines
         );
 
         consumer = result.get();
@@ -142,29 +151,37 @@ namespace vast::cc {
     // emit assembly
     void emit_assembly_action::anchor() {}
 
-    emit_assembly_action::emit_assembly_action(const vast_args &vargs, mcontext_t &mctx)
-        : vast_stream_action(output_type::emit_assembly, vargs, mctx)
+    emit_assembly_action::emit_assembly_action(
+        const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines
+    )
+        : vast_stream_action(output_type::emit_assembly, vargs, mctx, pipelines)
     {}
 
     // emit_llvm
     void emit_llvm_action::anchor() {}
 
-    emit_llvm_action::emit_llvm_action(const vast_args &vargs, mcontext_t &mctx)
-        : vast_stream_action(output_type::emit_llvm, vargs, mctx)
+    emit_llvm_action::emit_llvm_action(
+        const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines
+    )
+        : vast_stream_action(output_type::emit_llvm, vargs, mctx, pipelines)
     {}
 
     // emit_mlir
     void emit_mlir_action::anchor() {}
 
-    emit_mlir_action::emit_mlir_action(const vast_args &vargs, mcontext_t &mctx)
-        : vast_stream_action(output_type::emit_mlir, vargs, mctx)
+    emit_mlir_action::emit_mlir_action(
+        const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines
+    )
+        : vast_stream_action(output_type::emit_mlir, vargs, mctx, pipelines)
     {}
 
     // emit_obj
     void emit_obj_action::anchor() {}
 
-    emit_obj_action::emit_obj_action(const vast_args &vargs, mcontext_t &mctx)
-        : vast_stream_action(output_type::emit_obj, vargs, mctx)
+    emit_obj_action::emit_obj_action(
+        const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines
+    )
+        : vast_stream_action(output_type::emit_obj, vargs, mctx, pipelines)
     {}
 
     // emit_mlir_module
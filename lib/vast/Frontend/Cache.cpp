@@ -0,0 +1,337 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Cache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/SourceManager.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Lex/Preprocessor.h>
+#include <llvm/Support/BLAKE3.h>
+#include <llvm/Support/CachePruning.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Parser/Parser.h>
+VAST_UNRELAX_WARNINGS
+
+#include <array>
+
+#include "vast/Config/config.h"
+
+namespace vast::cc {
+
+    namespace {
+
+        // Bump when the format of cached entries or of keys changes.
+        constexpr std::string_view cache_format = "vast-module-cache-v1";
+
+        // Prefix required by `llvm::pruneCache` to consider a file for pruning.
+        constexpr std::string_view entry_prefix = "llvmcache-vast-";
+
+        constexpr std::uint64_t default_size_limit_mb = 1024;
+
+        struct hasher
+        {
+            hasher() { update(cache_format); }
+
+            hasher &update(string_ref data) {
+                // Length prefix keeps concatenations of different fields apart.
+                auto size = static_cast< std::uint64_t >(data.size());
+                blake.update(llvm::ArrayRef< std::uint8_t >(
+                    reinterpret_cast< const std::uint8_t * >(&size), sizeof(size)
+                ));
+                blake.update(data);
+                return *this;
+            }
+
+            hasher &update(std::uint64_t value) {
+                return update(string_ref(reinterpret_cast< const char * >(&value), sizeof(value)));
+            }
+
+            std::string digest() {
+                return llvm::toHex(blake.final(), /* LowerCase */ true);
+            }
+
+            llvm::BLAKE3 blake;
+        };
+
+        // Options that only select the form of the output or affect the
+        // process without changing produced modules.
+        constexpr std::array< option_t, 17 > output_only_options = {
+            opt::emit_llvm, opt::emit_obj, opt::emit_asm, opt::emit_mlir,
+            opt::emit_mlir_after, opt::emit_mlir_bytecode, opt::print_pipeline,
+            opt::disable_multithreading, opt::debug, opt::show_locs, opt::loc_attrs,
+            opt::module_cache_dir, opt::module_cache_size, opt::module_cache_remarks,
+            opt::compile_commands, opt::batch_jobs, opt::batch_output_dir
+        };
+
+        // Invocation without options that only name outputs of the compilation
+        // (e.g., `-o` or dependency files) or select their form.
+        clang::CompilerInvocation key_invocation(const clang::CompilerInvocation &inv) {
+            clang::CompilerInvocation out(inv);
+            out.getFrontendOpts().OutputFile.clear();
+            out.getFrontendOpts().ProgramAction = clang::frontend::ParseSyntaxOnly;
+            out.getDependencyOutputOpts() = clang::DependencyOutputOptions();
+            out.getDiagnosticOpts().DiagnosticSerializationFile.clear();
+            return out;
+        }
+
+        bool is_output_only(string_ref arg) {
+            if (!arg.consume_front(vast_option_prefix)) {
+                return false;
+            }
+
+            auto name = arg.split('=').first;
+            return llvm::is_contained(output_only_options, name);
+        }
+
+        //
+        // Hashes the token stream of the preprocessed unit together with the
+        // presumed locations of tokens, since locations are part of the module.
+        //
+        struct hash_preprocessed_action : clang::PreprocessorFrontendAction
+        {
+            explicit hash_preprocessed_action(hasher &hash) : hash(hash) {}
+
+          protected:
+            void ExecuteAction() override {
+                auto &pp = getCompilerInstance().getPreprocessor();
+                auto &sm = pp.getSourceManager();
+
+                pp.EnterMainSourceFile();
+
+                std::string filename;
+                clang::Token tok;
+                for (pp.Lex(tok); tok.isNot(clang::tok::eof); pp.Lex(tok)) {
+                    if (auto loc = sm.getPresumedLoc(tok.getLocation()); loc.isValid()) {
+                        if (filename != loc.getFilename()) {
+                            filename = loc.getFilename();
+                            hash.update(filename);
+                        }
+
+                        hash.update(loc.getLine()).update(loc.getColumn());
+                    }
+
+                    hash.update(tok.getKind());
+                    hash.update(pp.getSpelling(tok));
+                }
+            }
+
+          private:
+            hasher &hash;
+        };
+
+    } // namespace
+
+    std::optional< module_cache > module_cache::open(const vast_args &vargs) {
+        auto dir = vargs.get_option(opt::module_cache_dir);
+        if (!dir) {
+            return std::nullopt;
+        }
+
+        // These need the pipeline to actually run on the produced module.
+        for (auto option : {
+            opt::snapshot_at, opt::emit_crash_reproducer, opt::profile_pipeline,
+            opt::vast_verify_diags, opt::output_sarif
+        }) {
+            if (vargs.has_option(option)) {
+                return std::nullopt;
+            }
+        }
+
+        std::uint64_t size_limit_mb = default_size_limit_mb;
+        if (auto size = vargs.get_option(opt::module_cache_size)) {
+            if (size->getAsInteger(10, size_limit_mb)) {
+                llvm::errs() << "warning: invalid module cache size '" << size.value()
+                             << "', using the default\n";
+                size_limit_mb = default_size_limit_mb;
+            }
+        }
+
+        if (auto ec = llvm::sys::fs::create_directories(dir.value())) {
+            llvm::errs() << "warning: cannot create module cache directory '" << dir.value()
+                         << "': " << ec.message() << '\n';
+            return std::nullopt;
+        }
+
+        return module_cache(dir->str(), size_limit_mb * 1024 * 1024);
+    }
+
+    std::optional< std::string > module_cache::unit_key(
+        compiler_instance &ci, const vast_args &vargs
+    ) {
+        hasher hash;
+        hash.update(vast::version);
+
+        for (const auto &arg : key_invocation(ci.getInvocation()).getCC1CommandLine()) {
+            hash.update(arg);
+        }
+
+        for (auto arg : vargs.args) {
+            if (!is_output_only(arg)) {
+                hash.update(arg);
+            }
+        }
+
+        compiler_instance pre;
+        pre.setInvocation(std::make_shared< clang::CompilerInvocation >(ci.getInvocation()));
+        // Diagnostics are reported by the actual compilation.
+        pre.createDiagnostics(new clang::IgnoringDiagConsumer(), /* ShouldOwnClient */ true);
+        // Lookups of the unit and its headers are shared with the actual
+        // compilation through the file manager. The source manager is
+        // separate, executing an action clears the file tables of the one it
+        // uses.
+        pre.setFileManager(&ci.getFileManager());
+        pre.createSourceManager(ci.getFileManager());
+
+        hash_preprocessed_action action(hash);
+        if (!pre.ExecuteAction(action) || pre.getDiagnostics().hasErrorOccurred()) {
+            return std::nullopt;
+        }
+
+        return hash.digest();
+    }
+
+    auto module_cache::stages(string_ref unit, const pipeline_t &ppl) -> stages_t {
+        stages_t out;
+
+        hasher hash;
+        hash.update(unit);
+        out.push_back({ 0, hasher(hash).digest() });
+
+        std::size_t applied = 0;
+        for (auto end : ppl.stage_ends) {
+            for (; applied < end; ++applied) {
+                std::string pass;
+                llvm::raw_string_ostream os(pass);
+                ppl.scheduled[applied]->printAsTextualPipeline(os);
+                hash.update(os.str());
+            }
+
+            if (applied > 0) {
+                out.push_back({ applied, hasher(hash).digest() });
+            }
+        }
+
+        return out;
+    }
+
+    std::string module_cache::path(string_ref key) const {
+        llvm::SmallString< 256 > out(directory);
+        llvm::sys::path::append(out, std::string(entry_prefix) + key.str() + ".mlirbc");
+        return out.str().str();
+    }
+
+    std::optional< std::size_t > module_cache::lookup(const stages_t &stages) const {
+        for (auto idx = stages.size(); idx > 0; --idx) {
+            if (llvm::sys::fs::exists(path(stages[idx - 1].key))) {
+                return idx - 1;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    owning_mlir_module_ref module_cache::load(string_ref key, mcontext_t &mctx) const {
+        // Refresh access time, so pruning evicts least recently used entries.
+        if (auto file = llvm::sys::fs::openNativeFileForRead(path(key))) {
+            std::ignore = llvm::sys::fs::setLastAccessAndModificationTime(
+                *file, std::chrono::system_clock::now()
+            );
+            llvm::sys::fs::closeFile(*file);
+        } else {
+            llvm::consumeError(file.takeError());
+        }
+
+        return mlir::parseSourceFile< mlir_module >(path(key), mlir::ParserConfig(&mctx));
+    }
+
+    void module_cache::store(string_ref key, mlir_module mod) const {
+        auto final_path = path(key);
+        if (llvm::sys::fs::exists(final_path)) {
+            return;
+        }
+
+        // Write into a unique temporary file first and move it into place,
+        // readers never see partially written entries.
+        llvm::SmallString< 256 > tmp_model(directory);
+        llvm::sys::path::append(tmp_model, "tmp-%%%%%%%%.mlirbc");
+
+        int fd = -1;
+        llvm::SmallString< 256 > tmp_path;
+        if (llvm::sys::fs::createUniqueFile(tmp_model, fd, tmp_path)) {
+            return;
+        }
+
+        bool written = false;
+        {
+            llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+            mlir::BytecodeWriterConfig config("VAST");
+            written = mlir::succeeded(mlir::writeBytecodeToFile(mod, os, config));
+            os.close();
+            written &= !os.has_error();
+            os.clear_error();
+        }
+
+        if (!written || llvm::sys::fs::rename(tmp_path, final_path)) {
+            llvm::sys::fs::remove(tmp_path);
+            return;
+        }
+
+        llvm::CachePruningPolicy policy;
+        policy.Interval     = std::chrono::seconds(60);
+        policy.MaxSizeBytes = size_limit;
+        llvm::pruneCache(directory, policy);
+    }
+
+    with_module_cache::with_module_cache(
+        const module_cache &cache, const module_cache::stages_t &stages,
+        const pipeline_t &ppl
+    )
+        : cache(cache)
+    {
+        for (const auto &stage : stages) {
+            if (stage.applied > 0) {
+                auto last = ppl.scheduled[stage.applied - 1];
+                stage_ends[last->getTypeID()] = stage.key;
+            }
+        }
+    }
+
+    void with_module_cache::runAfterPass(pass_ptr pass, operation op) {
+        auto is_top = !op->getParentOp();
+
+        if (auto it = stage_ends.find(pass->getTypeID()); it != stage_ends.end()) {
+            if (!is_top) {
+                // Nested passes run on a part of the module, possibly in
+                // parallel with siblings. The whole module is stored once
+                // the enclosing pass adaptor finishes.
+                std::lock_guard< std::mutex > lock(mutex);
+                pending = it->second;
+                return;
+            }
+
+            store(it->second, op);
+            return;
+        }
+
+        if (is_top) {
+            std::optional< std::string > key;
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+                key = std::exchange(pending, std::nullopt);
+            }
+
+            if (key) {
+                store(*key, op);
+            }
+        }
+    }
+
+    void with_module_cache::store(string_ref key, operation op) const {
+        if (auto mod = mlir::dyn_cast< mlir_module >(op)) {
+            cache.store(key, mod);
+        }
+    }
+
+} // namespace vast::cc
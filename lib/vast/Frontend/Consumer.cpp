@@ -5,6 +5,7 @@
 #include "mlir/IR/Location.h"
 
 VAST_RELAX_WARNINGS
+#include <llvm/Support/FormatVariadic.h>
 #include <llvm/Support/Signals.h>
 
 #include <mlir/Bytecode/BytecodeWriter.h>
@@ -18,6 +19,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h>
 VAST_UNRELAX_WARNINGS
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
@@ -44,6 +46,7 @@ namespace vast::cc {
     void vast_consumer::Initialize(acontext_t &actx) {
         VAST_CHECK(!driver, "initialized multiple times");
         driver = cg::mk_default_driver(opts, vargs, actx, mctx);
+        frontend_start = util::profile_sample::take();
     }
 
     bool vast_consumer::HandleTopLevelDecl(clang::DeclGroupRef decls) {
@@ -51,7 +54,9 @@ namespace vast::cc {
             return true;
         }
 
+        auto start = clock::now();
         driver->emit(decls);
+        codegen_time += clock::now() - start;
         return true;
     }
 
@@ -69,7 +74,9 @@ namespace vast::cc {
         // Note that this method is called after `HandleTopLevelDecl` has already
         // ran all over the top level decls. Here clang mostly wraps defered and
         // global codegen, followed by running vast passes.
+        parse_end = clock::now();
         driver->finalize();
+        finalize_time = clock::now() - parse_end;
     }
 
     void vast_consumer::HandleTagDeclDefinition(clang::TagDecl *decl) {
@@ -105,6 +112,34 @@ namespace vast::cc {
 
     owning_mlir_module_ref vast_consumer::result() { return driver->freeze(); }
 
+    void vast_consumer::record_frontend_profile(
+        util::pipeline_profile &profile, mlir_module mod
+    ) const {
+        auto frontend_end = util::profile_sample::take(mod);
+
+        // Only the time can be split between interleaved parse and codegen,
+        // the remaining measurements are accounted to the whole frontend.
+        auto parse_start = frontend_start;
+        auto parse_stop  = frontend_start;
+        parse_stop.time  = frontend_start.time
+                         + std::max(parse_end - frontend_start.time - codegen_time, clock::duration::zero());
+        profile.record_phase({ "clang-parse", parse_start, parse_stop });
+
+        auto codegen_start = frontend_start;
+        auto codegen_stop  = frontend_end;
+        codegen_stop.time  = codegen_start.time + codegen_time;
+        profile.record_phase({ "codegen", codegen_start, codegen_stop });
+
+        // Deferred declarations are emitted after the parse has finished.
+        auto finalize_start = frontend_start;
+        auto finalize_stop  = frontend_end;
+        finalize_start.time = parse_end;
+        finalize_stop.time  = parse_end + finalize_time;
+        profile.record_phase({ "codegen-finalize", finalize_start, finalize_stop });
+
+        profile.record_phase({ "frontend", frontend_start, frontend_end });
+    }
+
     //
     // vast stream consumer
     //
@@ -123,10 +158,87 @@ namespace vast::cc {
         return std::nullopt;
     }
 
+    vast_stream_consumer::vast_stream_consumer(
+        output_type act, action_options opts,
+        const vast_args &vargs, mcontext_t &mctx,
+        output_stream_ptr os, compiler_instance &ci,
+        pipeline_cache *pipelines
+    )
+        : base(std::move(opts), vargs, mctx)
+        , action(act), output_stream(std::move(os)), ci(ci), pipelines(pipelines)
+    {}
+
+    vast_stream_consumer::~vast_stream_consumer() = default;
+
     void vast_stream_consumer::HandleTranslationUnit(acontext_t &actx) {
         base::HandleTranslationUnit(actx);
-        auto mod = result();
+        emit_output(result());
+    }
+
+    std::optional< target_dialect > vast_stream_consumer::pipeline_target() const {
+        switch (action) {
+            case output_type::emit_mlir:
+                return get_target_dialect(vargs);
+            case output_type::emit_assembly:
+            case output_type::emit_llvm:
+            case output_type::emit_obj:
+                return target_dialect::llvm;
+            case output_type::none:
+                break;
+        }
+
+        return std::nullopt;
+    }
+
+    // Reports use of the module cache if requested, e.g., to observe hits in tests.
+    static void remark_module_cache(compiler_instance &ci, const vast_args &vargs, string_ref msg) {
+        if (!vargs.has_option(opt::module_cache_remarks)) {
+            return;
+        }
+
+        auto &diags = ci.getDiagnostics();
+        diags.Report(diags.getCustomDiagID(clang::DiagnosticsEngine::Remark, "%0")) << msg;
+    }
+
+    bool vast_stream_consumer::compile_from_cache(const module_cache &cache) {
+        auto target = pipeline_target();
+        if (!target) {
+            return false;
+        }
+
+        auto unit = module_cache::unit_key(ci, vargs);
+        if (!unit) {
+            return false;
+        }
+
+        auto pipeline = setup_pipeline(pipeline_source::ast, target.value(), mctx, vargs);
+        auto stages   = module_cache::stages(unit.value(), *pipeline);
+        cached.emplace(cache, std::move(stages), std::move(pipeline), std::nullopt);
+
+        auto hit = cache.lookup(cached->stages);
+        if (!hit) {
+            remark_module_cache(ci, vargs, "module cache miss");
+            return false;
+        }
+
+        auto mod = cache.load(cached->stages[hit.value()].key, mctx);
+        if (!mod) {
+            // Unreadable entry, compile from scratch and overwrite it.
+            remark_module_cache(ci, vargs, "module cache miss, unreadable entry");
+            return false;
+        }
+
+        remark_module_cache(ci, vargs, llvm::formatv(
+            "module cache hit after {0} of {1} pipeline passes",
+            cached->stages[hit.value()].applied, cached->pipeline->scheduled.size()
+        ).str());
+
+        cached->restored = hit;
+        emit_output(std::move(mod));
+        return true;
+    }
 
+    void vast_stream_consumer::emit_output(owning_mlir_module_ref mod) {
         switch (action) {
             case output_type::emit_assembly:
                 return emit_backend_output(backend::Backend_EmitAssembly, std::move(mod));
@@ -154,7 +266,7 @@ namespace vast::cc {
 
         auto final_mlir_module = mlir::cast< mlir_module >(mod->getBody()->front());
         auto llvm_mod          = target::llvmir::translate(final_mlir_module, llvm_context);
-        auto dl                = driver->acontext().getTargetInfo().getDataLayoutString();
+        auto dl                = ci.getTarget().getDataLayoutString();
 
         clang::EmitBackendOutput(
             opts.diags, opts.headers, opts.codegen, opts.target, opts.lang, dl, llvm_mod.get(),
@@ -200,8 +312,7 @@ namespace vast::cc {
     void vast_stream_consumer::process_mlir_module(target_dialect target, mlir_module mod) {
         // Handle source manager properly given that lifetime analysis
         // might emit warnings and remarks.
-        auto &src_mgr     = driver->acontext().getSourceManager();
-        auto &mctx        = driver->mcontext();
+        auto &src_mgr     = ci.getSourceManager();
         auto main_file_id = src_mgr.getMainFileID();
 
         auto file_buff = llvm::MemoryBuffer::getMemBuffer(
@@ -226,19 +337,51 @@ namespace vast::cc {
         VAST_CHECK(file_entry, "failed to recover file entry ref");
         auto snapshot_prefix = std::filesystem::path(file_entry->getName().str()).stem().string();
 
-        auto pipeline = setup_pipeline(pipeline_source::ast, target, mctx, vargs, snapshot_prefix);
+        // Outlives the pipeline, which refers to it from its instrumentation.
+        std::optional< util::pipeline_profile > profile;
+        if (vargs.has_option(opt::profile_pipeline)) {
+            profile.emplace();
+            record_frontend_profile(*profile, mod);
+        }
+
+        std::unique_ptr< vast_pipeline > owned_pipeline;
+        vast_pipeline *pipeline = nullptr;
+        if (cached) {
+            pipeline = cached_pipeline(target, mod, owned_pipeline, snapshot_prefix);
+        } else if (pipelines && pipeline_cache::is_cacheable(vargs)) {
+            pipeline = &pipelines->get(pipeline_source::ast, target, mctx, vargs);
+        } else {
+            owned_pipeline = setup_pipeline(pipeline_source::ast, target, mctx, vargs, snapshot_prefix);
+            pipeline = owned_pipeline.get();
+        }
         VAST_CHECK(pipeline, "failed to setup pipeline");
 
+        if (profile) {
+            pipeline->addInstrumentation(
+                std::make_unique< util::with_profile >(*profile, pipeline->pass_steps)
+            );
+        }
+
         #ifdef VAST_ENABLE_SARIF
         auto sarif_diagnostics = setup_sarif_diagnostics(vargs, mctx);
         #endif // VAST_ENABLE_SARIF
 
         auto result = pipeline->run(mod);
 
+        if (profile) {
+            auto path = vargs.get_option(opt::profile_pipeline);
+            VAST_CHECK(path.has_value(), "expected path to pipeline profile");
+            profile->write(path.value());
+        }
+
         VAST_CHECK(
             mlir::succeeded(result), "MLIR pass manager failed when running vast passes"
         );
 
+        if (cached) {
+            cached->cache.store(cached->stages.back().key, mod);
+        }
+
         // Verify the diagnostic handler to make sure that each of the
         // diagnostics matched.
         if (verify_diagnostics && src_mgr_handler.verify().failed()) {
@@ -266,6 +409,47 @@ namespace vast::cc {
         // }
     }
 
+    vast_pipeline *vast_stream_consumer::cached_pipeline(
+        target_dialect target, mlir_module mod,
+        std::unique_ptr< vast_pipeline > &owned, string_ref snapshot_prefix
+    ) {
+        auto &full = *cached->pipeline;
+
+        if (!cached->restored) {
+            // Fresh compilation, store the module right after codegen and
+            // then after every stage of the full pipeline.
+            cached->cache.store(cached->stages.front().key, mod);
+            full.addInstrumentation(
+                std::make_unique< with_module_cache >(cached->cache, cached->stages, full)
+            );
+            return &full;
+        }
+
+        // Resume from the restored stage, passes applied on the restored
+        // module are not scheduled again.
+        auto restored = cached->restored.value();
+
+        std::vector< mlir::TypeID > applied;
+        for (std::size_t i = 0; i < cached->stages[restored].applied; ++i) {
+            applied.push_back(full.scheduled[i]->getTypeID());
+        }
+
+        owned = setup_pipeline(
+            pipeline_source::ast, target, mctx, vargs, snapshot_prefix, applied
+        );
+
+        module_cache::stages_t remaining(
+            std::next(cached->stages.begin(), static_cast< std::ptrdiff_t >(restored + 1)),
+            cached->stages.end()
+        );
+
+        owned->addInstrumentation(
+            std::make_unique< with_module_cache >(cached->cache, remaining, full)
+        );
+
+        return owned.get();
+    }
+
     void vast_stream_consumer::emit_mlir_output(
         target_dialect target, owning_mlir_module_ref mod
     ) {
@@ -145,17 +145,26 @@ namespace vast::cc {
         target_dialect trg,
         mcontext_t &mctx,
         const vast_args &vargs,
-        string_ref snapshot_prefix
+        string_ref snapshot_prefix,
+        llvm::ArrayRef< mlir::TypeID > applied
     ) {
         auto passes = std::make_unique< vast_pipeline >(mctx, vargs);
         passes->print_on_error(llvm::errs());
+        passes->seen.insert(applied.begin(), applied.end());
 
         if (auto at = vargs.get_options_list(opt::snapshot_at)) {
+            auto format = util::snapshot_format::text;
+            if (auto requested = vargs.get_option(opt::snapshot_format)) {
+                auto parsed = util::parse_snapshot_format(requested.value());
+                VAST_CHECK(parsed, "Unknown snapshot format: {0}", requested.value());
+                format = parsed.value();
+            }
+
             passes->addInstrumentation([&] () -> std::unique_ptr< util::with_snapshots > {
                 if (std::ranges::count(at.value(), "*")) {
-                    return std::make_unique< util::snapshot_all >(snapshot_prefix);
+                    return std::make_unique< util::snapshot_all >(snapshot_prefix, format);
                 } else {
-                    return std::make_unique< util::snapshot_after_passes >(at.value(), snapshot_prefix);
+                    return std::make_unique< util::snapshot_after_passes >(at.value(), snapshot_prefix, format);
                 }
             } ());
         }
@@ -164,6 +173,7 @@ namespace vast::cc {
         if (pipeline_source::ast == src) {
             for (auto &&step : pipeline::codegen()) {
                 passes->schedule(std::move(step));
+                passes->mark_stage();
             }
         }
 
@@ -172,7 +182,9 @@ namespace vast::cc {
         // can specify how we want to convert to llvm dialect and allows to turn
         // off optional pipelines.
         for (auto &&step : pipeline::conversion(src, trg, vargs)) {
-            if (passes->schedule(std::move(step)) == schedule_result::stop) {
+            auto result = passes->schedule(std::move(step));
+            passes->mark_stage();
+            if (result == schedule_result::stop) {
                 break;
             }
         }
@@ -196,4 +208,27 @@ namespace vast::cc {
         return passes;
     }
 
+    bool pipeline_cache::is_cacheable(const vast_args &vargs) {
+        return !vargs.has_option(opt::snapshot_at)
+            && !vargs.has_option(opt::emit_crash_reproducer)
+            && !vargs.has_option(opt::profile_pipeline);
+    }
+
+    vast_pipeline &pipeline_cache::get(
+        pipeline_source src,
+        target_dialect trg,
+        mcontext_t &mctx,
+        const vast_args &vargs
+    ) {
+        VAST_CHECK(is_cacheable(vargs), "requested pipeline can not be cached");
+
+        auto &pipeline = pipelines[{ src, trg }];
+        if (!pipeline) {
+            pipeline = setup_pipeline(src, trg, mctx, vargs);
+        }
+
+        VAST_CHECK(pipeline->getContext() == &mctx, "cached pipeline used with a different context");
+        return *pipeline;
+    }
+
 } // namespace vast::cc
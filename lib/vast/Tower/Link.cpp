@@ -2,6 +2,7 @@
 
 #include "vast/Tower/Link.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 namespace vast::tw {
@@ -13,17 +14,29 @@ namespace vast::tw {
             into.insert(into.end(), what.begin(), what.end());
         }
 
-    } // namespace
-
-    op_mapping reverse_mapping(const op_mapping &from) {
-        op_mapping out;
-        for (const auto &[root, ops] : from) {
-            for (auto op : ops) {
-                out[op].push_back(root);
+        // Operations of the module with given ids, ids without an operation
+        // are skipped.
+        operations resolve(const handle_t &handle, const op_ids &ids) {
+            operations out;
+            out.reserve(ids.size());
+            for (auto id : ids) {
+                if (auto op = handle.mod.lookup(id)) {
+                    out.push_back(op);
+                }
             }
+            return out;
+        }
+
+        op_mapping mapping(const handle_t &from, auto &&query) {
+            op_mapping out;
+            from.mod.get()->walk([&](operation op) {
+                if (auto ops = query(op); !ops.empty())
+                    out[op] = std::move(ops);
+            });
+            return out;
         }
-        return out;
-    }
+
+    } // namespace
 
     void dbg(const op_mapping &mapping, auto &outs) {
         outs << "Mapping:\n";
@@ -47,98 +60,126 @@ namespace vast::tw {
         }
     }
 
-    using loc_to_op_t = llvm::DenseMap< loc_t, operations >;
+    /* id_mapping */
 
-    void dbg(const loc_to_op_t &mapping, auto &outs) {
-        outs << "loc_to_op\n";
-        for (const auto &[loc, to] : mapping) {
-            outs << ".." << loc << "\n";
-            for (auto t : to) {
-                outs << "   -> " << *t << "\n";
+    id_mapping id_mapping::invert(const op_ids &from, std::size_t keys) {
+        id_mapping out;
+        out.offsets.assign(keys + 1, 0);
+
+        for (auto key : from) {
+            if (key < keys) {
+                ++out.offsets[key + 1];
+            }
+        }
+
+        for (std::size_t key = 0; key < keys; ++key) {
+            out.offsets[key + 1] += out.offsets[key];
+        }
+
+        out.values.resize(out.offsets.back());
+        auto cursor = out.offsets;
+        for (op_id_t idx = 0; idx < from.size(); ++idx) {
+            if (auto key = from[idx]; key < keys) {
+                out.values[cursor[key]++] = idx;
             }
         }
-    }
 
-    loc_to_op_t gather_loc_to_op(location_info_t &li, operation op) {
-        loc_to_op_t out;
-        auto collect = [&](operation op) { out[li.self(op)].push_back(op); };
-        op->walk(collect);
         return out;
     }
 
-    // TODO: Reimplement using ranges once we have newer stdlib in CI
-    auto mk_link_mappings(const auto &links) {
-        std::vector< op_mapping > out;
-        for (const auto &l : links) {
-            out.emplace_back(l->parents_to_children());
+    llvm::ArrayRef< id_mapping::op_id_t > id_mapping::operator[](op_id_t key) const {
+        if (key >= size()) {
+            return {};
         }
-        return out;
+
+        return llvm::ArrayRef< op_id_t >(values).slice(offsets[key], offsets[key + 1] - offsets[key]);
+    }
+
+    /* id_memo */
+
+    std::optional< op_ids > id_memo::lookup(op_id_t id) const {
+        auto it = ranges.find(id);
+        if (it == ranges.end()) {
+            return std::nullopt;
+        }
+
+        auto [begin, end] = it->second;
+        return op_ids(storage.begin() + begin, storage.begin() + end);
     }
 
+    void id_memo::store(op_id_t id, const op_ids &ids) {
+        auto begin = storage.size();
+        append_range(storage, ids);
+        ranges[id] = { begin, storage.size() };
+    }
 
-    // `transition` handles the lookup between levels - we need this as we want to generalise
-    // (`levels` can be arbitrary mapping, not just `op -> { op }`).
-    op_mapping build_map(op_mapping init, const auto &levels, auto transition) {
-        auto handle_level = [&](const auto &level) {
-            auto handle_element = [&](operation op) -> operations {
-                auto prev_ops = level.find(transition(op));
-                if (prev_ops == level.end())
-                    return {};
-                return prev_ops->second;
-            };
+    /* conversion_step::link_interface API */
 
-            for (auto &[op, todo] : init) {
-                operations parents;
-                for (auto current : todo) {
-                    append_range(parents, handle_element(current));
+    auto conversion_step::to_children() -> const id_mapping & {
+        if (!_to_children) {
+            auto backlinks = _location_info.backlinks(_child.id);
+            // Parents have smaller ids than the number of parent operations, which
+            // is not known without the parent module, the largest one bounds it.
+            std::size_t keys = 0;
+            if (backlinks) {
+                for (auto id : *backlinks) {
+                    if (id != location_info_t::no_parent) {
+                        keys = std::max< std::size_t >(keys, id + 1);
+                    }
                 }
-                todo = std::move(parents);
             }
-        };
 
-        for (const auto &level : levels | std::views::drop(1))
-            handle_level(level);
+            _to_children = backlinks ? id_mapping::invert(*backlinks, keys) : id_mapping();
+        }
 
-        return init;
+        return *_to_children;
     }
 
-    op_mapping build_map(const link_vector &links) {
-        auto transition = [](operation op) { return op; };
-        auto init = links.front()->parents_to_children();
-        return build_map(std::move(init), mk_link_mappings(links), transition);
+    op_ids conversion_step::children(op_id_t id) {
+        auto ids = to_children()[id];
+        return op_ids(ids.begin(), ids.end());
     }
 
-    op_mapping build_map(std::vector< loc_to_op_t > links, location_info_t &li) {
-        auto transition = [&](operation op) { return li.prev(op); };
-
-        std::reverse(links.begin(), links.end());
+    op_ids conversion_step::parents(op_id_t id) {
+        auto backlinks = _location_info.backlinks(_child.id);
+        if (!backlinks || id >= backlinks->size()) {
+            return {};
+        }
 
-        // initialize
-        op_mapping init;
-        for (auto [_, op] : links.front()) {
-            init[op.front()] = { op };
+        if (auto parent = (*backlinks)[id]; parent != location_info_t::no_parent) {
+            return { parent };
         }
-        return build_map(std::move(init), links, transition);
+        return {};
     }
 
-    op_mapping build_map(handle_t parent, handle_t child, location_info_t &li) {
-        return build_map({gather_loc_to_op(li, parent.mod), gather_loc_to_op(li, child.mod)}, li);
+    operations conversion_step::children(operation op) {
+        return resolve(_child, children(location_info_t::self(op)));
     }
 
-    /* conversion_step::link_interface API */
+    operations conversion_step::children(operations ops) {
+        operations out;
+        for (auto op : ops)
+            append_range(out, children(op));
+        return out;
+    }
 
-    operations conversion_step::children(operation) { VAST_UNIMPLEMENTED; }
-    operations conversion_step::children(operations) { VAST_UNIMPLEMENTED; }
+    operations conversion_step::parents(operation op) {
+        return resolve(_parent, parents(location_info_t::self(op)));
+    }
 
-    operations conversion_step::parents(operation) { VAST_UNIMPLEMENTED;  }
-    operations conversion_step::parents(operations) { VAST_UNIMPLEMENTED; }
+    operations conversion_step::parents(operations ops) {
+        operations out;
+        for (auto op : ops)
+            append_range(out, parents(op));
+        return out;
+    }
 
     op_mapping conversion_step::parents_to_children() {
-        return reverse_mapping(children_to_parents());
+        return mapping(_parent, [&](operation op) { return children(op); });
     }
 
     op_mapping conversion_step::children_to_parents() {
-        return build_map(parent(), child(), _location_info);
+        return mapping(_child, [&](operation op) { return parents(op); });
     }
 
     handle_t conversion_step::parent() const { return _parent; }
@@ -147,15 +188,47 @@ namespace vast::tw {
     /* fat_link */
 
     fat_link::fat_link(link_vector links)
-        : _links(std::move(links)),
-          _to_children(build_map(_links)),
-          _to_parents(reverse_mapping(_to_children))
-      {}
+        : _links(std::move(links))
+    {
+        VAST_ASSERT(!_links.empty());
+    }
 
     /* fat_link::link_interface API */
 
+    op_ids fat_link::children(op_id_t id) {
+        if (auto memo = _to_children.lookup(id))
+            return std::move(*memo);
+
+        op_ids frontier = { id };
+        for (auto &link : _links) {
+            op_ids next;
+            for (auto current : frontier)
+                append_range(next, link->children(current));
+            frontier = std::move(next);
+        }
+
+        _to_children.store(id, frontier);
+        return frontier;
+    }
+
+    op_ids fat_link::parents(op_id_t id) {
+        if (auto memo = _to_parents.lookup(id))
+            return std::move(*memo);
+
+        op_ids frontier = { id };
+        for (auto &link : _links | std::views::reverse) {
+            op_ids next;
+            for (auto current : frontier)
+                append_range(next, link->parents(current));
+            frontier = std::move(next);
+        }
+
+        _to_parents.store(id, frontier);
+        return frontier;
+    }
+
     operations fat_link::children(operation op) {
-        return _to_children[op];
+        return resolve(child(), children(location_info_t::self(op)));
     }
 
     operations fat_link::children(operations ops) {
@@ -166,7 +239,7 @@ namespace vast::tw {
     }
 
     operations fat_link::parents(operation op) {
-        return _to_parents[op];
+        return resolve(parent(), parents(location_info_t::self(op)));
     }
 
     operations fat_link::parents(operations ops) {
@@ -176,8 +249,13 @@ namespace vast::tw {
         return out;
     }
 
-    op_mapping fat_link::parents_to_children() { return _to_children; }
-    op_mapping fat_link::children_to_parents() { return _to_parents; }
+    op_mapping fat_link::parents_to_children() {
+        return mapping(parent(), [&](operation op) { return children(op); });
+    }
+
+    op_mapping fat_link::children_to_parents() {
+        return mapping(child(), [&](operation op) { return parents(op); });
+    }
 
     handle_t fat_link::parent() const { return _links.front()->parent(); }
     handle_t fat_link::child() const { return _links.back()->child(); }
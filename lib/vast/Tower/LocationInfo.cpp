@@ -2,47 +2,158 @@
 
 #include "vast/Tower/LocationInfo.hpp"
 
-#include <algorithm>
-#include <numeric>
+VAST_RELAX_WARNINGS
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/Location.h>
+VAST_UNRELAX_WARNINGS
 
 namespace vast::tw {
 
-    std::string location_info_t::fingerprint(const conversion_path_t &path) {
-        return std::accumulate(path.begin(), path.end(), std::string{});
+    namespace {
+
+        // Tags opaque locations that carry operation ids.
+        struct op_id_tag {};
+
+        mlir::TypeID op_id_type() { return mlir::TypeID::get< op_id_tag >(); }
+
+        std::optional< location_info_t::op_id_t > get_id(loc_t loc) {
+            if (auto opaque = mlir::dyn_cast< mlir::OpaqueLoc >(loc)) {
+                if (opaque.getUnderlyingTypeID() == op_id_type()) {
+                    return opaque.getUnderlyingLocation();
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Passes may wrap the inherited location (e.g., into a fused location
+        // of several replaced operations), in which case the first id wins.
+        location_info_t::op_id_t find_id(loc_t loc) {
+            auto id = location_info_t::no_parent;
+            loc->walk([&] (loc_t nested) {
+                if (auto nested_id = get_id(nested)) {
+                    id = *nested_id;
+                    return walk_result::interrupt();
+                }
+                return walk_result::advance();
+            });
+            return id;
+        }
+
+    } // namespace
+
+    auto location_info_t::self(operation op) -> op_id_t {
+        auto id = get_id(op->getLoc());
+        VAST_CHECK(id, "{0} with loc: {1}", *op, op->getLoc());
+        return *id;
+    }
+
+    auto location_info_t::level(handle_id_t id) const -> const level_t * {
+        auto it = levels.find(id);
+        return it != levels.end() ? &it->second : nullptr;
+    }
+
+    auto location_info_t::prev(handle_id_t level, operation op) const -> op_id_t {
+        auto parents = backlinks(level);
+        if (!parents) {
+            return no_parent;
+        }
+
+        auto id = self(op);
+        return id < parents->size() ? (*parents)[id] : no_parent;
     }
 
-    loc_t location_info_t::mk_unique_loc(const conversion_path_t &path, operation op) {
-        auto mctx = op->getContext();
-        auto raw_id =
-            fingerprint(path) + std::to_string(reinterpret_cast< std::uintptr_t >(op));
-        return mlir::FileLineColLoc::get(mctx, raw_id, 0, 0);
+    auto location_info_t::backlinks(handle_id_t id) const -> const op_ids * {
+        auto lvl = level(id);
+        return lvl && lvl->parent ? &lvl->parents : nullptr;
     }
 
-    loc_t location_info_t::mk_linked_loc(loc_t self, loc_t prev) {
-        auto mctx = self->getContext();
-        return mlir::FusedLoc::get({ self, prev }, {}, mctx);
+    bool location_info_t::are_tied(
+        operation parent, handle_id_t child_level, operation child
+    ) const {
+        return self(parent) == prev(child_level, child);
     }
 
-    loc_t location_info_t::get_as_child(const conversion_path_t &path, operation op) {
-        return mk_linked_loc(self(op), mk_unique_loc(path, op));
+    loc_t location_info_t::source(handle_id_t id, operation op) const {
+        if (auto lvl = level(id)) {
+            if (auto self_id = self(op); self_id < lvl->sources.size()) {
+                return lvl->sources[self_id];
+            }
+        }
+        return mlir::UnknownLoc::get(op->getContext());
+    }
+
+    loc_t location_info_t::id_loc(mcontext_t *mctx, op_id_t id) {
+        if (id >= id_locs.size()) {
+            id_locs.resize(id + 1);
+        }
+
+        auto &loc = id_locs[id];
+        if (!loc) {
+            loc = mlir::OpaqueLoc::get(id, op_id_type(), mlir::UnknownLoc::get(mctx));
+        }
+        return loc_t(loc);
     }
 
-    loc_t location_info_t::get_root(operation op) {
-        return mk_linked_loc(op->getLoc(), mk_unique_loc({}, op));
+    auto location_info_t::mk_root(operation root) -> locs_t {
+        locs_t sources;
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            sources.push_back(op->getLoc());
+            op->setLoc(id_loc(op->getContext(), sources.size() - 1));
+        });
+        return sources;
     }
 
-    bool location_info_t::are_tied(operation parent, operation child) {
-        return self(parent) == prev(child);
+    auto location_info_t::transform_locations(handle_id_t parent, operation root)
+        -> level_locations
+    {
+        auto lvl = level(parent);
+        VAST_CHECK(lvl, "Locations of the parent level are not recorded.");
+        const auto &parent_sources = lvl->sources;
+
+        auto parent_source = [&] (op_id_t id) -> std::optional< loc_t > {
+            if (id < parent_sources.size()) {
+                return parent_sources[id];
+            }
+            return std::nullopt;
+        };
+
+        // Locations made by passes may contain ids (e.g., a fused location of
+        // replaced operations), these are replaced by sources of the parents.
+        mlir::AttrTypeReplacer replacer;
+        replacer.addReplacement([&] (mlir::OpaqueLoc loc) -> std::optional< mlir_attr > {
+            if (auto id = get_id(loc)) {
+                loc_t source = parent_source(*id).value_or(loc.getFallbackLocation());
+                return mlir::LocationAttr(source);
+            }
+            return std::nullopt;
+        });
+
+        level_locations out;
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            auto loc = op->getLoc();
+            // Operations untouched by the pass keep the location of their id.
+            if (auto id = get_id(loc)) {
+                out.parents.push_back(*id);
+                out.sources.push_back(parent_source(*id).value_or(loc));
+            } else {
+                out.parents.push_back(find_id(loc));
+                auto source = replacer.replace(mlir::LocationAttr(loc));
+                out.sources.push_back(mlir::cast< mlir::LocationAttr >(source));
+            }
+
+            op->setLoc(id_loc(op->getContext(), out.parents.size() - 1));
+        });
+
+        return out;
     }
 
-    void mk_root(location_info_t &li, operation root) {
-        auto set_loc = [&](operation op) { op->setLoc(li.get_root(op)); };
-        root->walk(set_loc);
+    void location_info_t::tie_root(handle_id_t level, locs_t sources) {
+        levels[level] = { std::nullopt, {}, std::move(sources) };
     }
 
-    void transform_locations(location_info_t &li, const conversion_path_t &path, operation root) {
-        auto set_loc = [&](operation op) { op->setLoc(li.get_as_child(path, op)); };
-        root->walk(set_loc);
+    void location_info_t::tie(handle_id_t parent, handle_id_t level, level_locations locs) {
+        levels[level] = { parent, std::move(locs.parents), std::move(locs.sources) };
     }
 
 } // namespace vast::tw
@@ -21,6 +21,19 @@ namespace vast::tw {
         return out;
     }
 
+    pass_key_t pass_key(pass_ptr pass) {
+        // `mlir::Pass` does not expose its options, they are only available
+        // through the textual form.
+        return { pass->getTypeID(), to_string(pass) };
+    }
+
+    const pass_key_t &pass_keys_t::operator()(pass_ptr pass) {
+        if (auto it = keys.find(pass); it != keys.end()) {
+            return it->second;
+        }
+        return keys.try_emplace(pass, pass_key(pass)).first->second;
+    }
+
     void copy_passes(mlir::PassManager &pm, const conversion_passes_t &passes) {
         // Sadly I didn't find any better public API to clone passes between `mlir::PassManager`
         // instances. Pass does have a `clonePass` method but it is `protected` and same holds
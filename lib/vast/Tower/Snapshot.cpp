@@ -0,0 +1,191 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Tower/Snapshot.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SetVector.h>
+#include <mlir/IR/OperationSupport.h>
+#include <mlir/Transforms/RegionUtils.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::tw {
+
+    fingerprint_t fingerprint(operation root) {
+        std::vector< loc_t > locations;
+        return fingerprint(root, locations);
+    }
+
+    fingerprint_t fingerprint(operation root, std::vector< loc_t > &locations) {
+        // Values and blocks are numbered in order of their first appearance,
+        // so structurally equal operations get the same numbering.
+        llvm::DenseMap< mlir_value, unsigned > values;
+        llvm::DenseMap< block_ptr, unsigned > blocks;
+
+        auto value_id = [&] (mlir_value value) {
+            return values.try_emplace(value, values.size()).first->second;
+        };
+
+        auto block_id = [&] (block_ptr block) {
+            return blocks.try_emplace(block, blocks.size()).first->second;
+        };
+
+        fingerprint_t hash = llvm::hash_value(root->getNumRegions());
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            locations.push_back(op->getLoc());
+            hash = llvm::hash_combine(
+                hash, op->getName(), op->getRawDictionaryAttrs(), op->hashProperties(),
+                op->getNumRegions(), op->getNumSuccessors()
+            );
+
+            for (auto type : op->getResultTypes()) {
+                hash = llvm::hash_combine(hash, type);
+            }
+
+            for (auto operand : op->getOperands()) {
+                hash = llvm::hash_combine(hash, value_id(operand));
+            }
+
+            for (auto result : op->getResults()) {
+                value_id(result);
+            }
+
+            for (auto succ : op->getSuccessors()) {
+                hash = llvm::hash_combine(hash, block_id(succ));
+            }
+
+            for (auto &region : op->getRegions()) {
+                hash = llvm::hash_combine(hash, region.getBlocks().size());
+                for (auto &block : region) {
+                    hash = llvm::hash_combine(hash, block_id(&block), block.getNumArguments());
+                    for (auto arg : block.getArguments()) {
+                        hash = llvm::hash_combine(hash, arg.getType(), value_id(arg));
+                    }
+                }
+            }
+        });
+
+        return hash;
+    }
+
+    std::size_t estimate_size(operation root) {
+        std::size_t bytes = 0;
+        root->walk([&] (operation op) {
+            bytes += sizeof(mlir::Operation)
+                + op->getNumOperands() * sizeof(mlir::OpOperand)
+                + op->getNumResults() * 2 * sizeof(mlir_value)
+                + op->getNumRegions() * sizeof(mlir::Region);
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    bytes += sizeof(mlir::Block) + block.getNumArguments() * 2 * sizeof(mlir_value);
+                }
+            }
+        });
+        return bytes;
+    }
+
+    namespace {
+
+        // Only operations that do not communicate with their siblings through
+        // values can be detached from the module and shared.
+        bool is_shareable(operation op) {
+            if (op->getNumOperands() != 0) {
+                return false;
+            }
+
+            for (auto result : op->getResults()) {
+                if (!result.use_empty()) {
+                    return false;
+                }
+            }
+
+            llvm::SetVector< mlir_value > above;
+            mlir::getUsedValuesDefinedAbove(op->getRegions(), above);
+            return above.empty();
+        }
+
+        void restore_locations(operation root, const std::vector< loc_t > &locations) {
+            auto it = locations.begin();
+            root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+                VAST_ASSERT(it != locations.end());
+                op->setLoc(*it++);
+            });
+            VAST_ASSERT(it == locations.end());
+        }
+
+    } // namespace
+
+    shared_body_ptr module_snapshot::find(fingerprint_t fp, operation op) const {
+        auto it = bodies.find(fp);
+        if (it == bodies.end()) {
+            return nullptr;
+        }
+
+        // Guard against hash collisions.
+        for (const auto &body : it->second) {
+            if (mlir::OperationEquivalence::isEquivalentTo(
+                body->op.get(), op, mlir::OperationEquivalence::IgnoreLocations
+            )) {
+                return body;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void module_snapshot::index(fingerprint_t fp, shared_body_ptr body) {
+        auto &candidates = bodies[fp];
+        if (!llvm::is_contained(candidates, body)) {
+            candidates.push_back(std::move(body));
+        }
+    }
+
+    std::optional< module_snapshot > module_snapshot::take(
+        mlir_module mod, const module_snapshot *prev
+    ) {
+        auto &ops = mod.getBody()->getOperations();
+        if (!llvm::all_of(ops, [] (auto &op) { return is_shareable(&op); })) {
+            return std::nullopt;
+        }
+
+        module_snapshot snapshot;
+        snapshot.skeleton = mlir::cast< mlir_module >(mod->cloneWithoutRegions());
+        snapshot.entries.reserve(ops.size());
+
+        for (auto &op : ops) {
+            std::vector< loc_t > locations;
+            auto fp = fingerprint(&op, locations);
+
+            shared_body_ptr body = prev ? prev->find(fp, &op) : nullptr;
+            if (!body) {
+                body = snapshot.find(fp, &op);
+            }
+
+            if (!body) {
+                body = std::make_shared< const shared_body >(op.clone());
+                snapshot.size_in_bytes += estimate_size(body->op.get());
+                ++snapshot.owned;
+            }
+
+            snapshot.index(fp, body);
+            snapshot.entries.push_back({ std::move(body), std::move(locations) });
+            snapshot.size_in_bytes += snapshot.entries.back().locations.size() * sizeof(loc_t);
+        }
+
+        return snapshot;
+    }
+
+    owning_mlir_module_ref module_snapshot::materialize() const {
+        auto mod = mlir::cast< mlir_module >(skeleton.get()->cloneWithoutRegions());
+        auto &body = mod.getBodyRegion().emplaceBlock();
+
+        for (const auto &entry : entries) {
+            auto op = entry.body->op.get()->clone();
+            restore_locations(op, entry.locations);
+            body.push_back(op);
+        }
+
+        return mod;
+    }
+
+} // namespace vast::tw
@@ -0,0 +1,205 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Tower/Storage.hpp"
+
+#include "vast/Tower/LocationInfo.hpp"
+
+#include <utility>
+
+namespace vast::tw {
+
+    module_ref::module_ref(const module_storage *storage, handle_id_t id)
+        : storage(storage), id(id)
+    {
+        if (storage) {
+            storage->pin(id);
+        }
+    }
+
+    module_ref::module_ref(const module_ref &other) : module_ref(other.storage, other.id) {}
+
+    module_ref::module_ref(module_ref &&other) noexcept
+        : storage(std::exchange(other.storage, nullptr)), id(other.id)
+    {}
+
+    module_ref &module_ref::operator=(module_ref other) noexcept {
+        std::swap(storage, other.storage);
+        std::swap(id, other.id);
+        return *this;
+    }
+
+    module_ref::~module_ref() {
+        if (storage) {
+            storage->unpin(id);
+        }
+    }
+
+    mlir_module module_ref::get() const {
+        VAST_CHECK(storage, "Dereferencing an empty module reference!");
+        return storage->module(id);
+    }
+
+    operation module_ref::lookup(std::uint64_t op_id) const {
+        VAST_CHECK(storage, "Dereferencing an empty module reference!");
+        return storage->lookup(id, op_id);
+    }
+
+    handle_t module_storage::snapshot(const pass_key_t &pass, mlir_module mod, handle_t from) {
+        auto prev = snapshots.find(from.id);
+        auto snapshot = module_snapshot::take(
+            mod, prev != snapshots.end() ? &prev->second : nullptr
+        );
+
+        // Module that cannot be split is stored as a full clone.
+        auto handle = snapshot
+            ? store_snapshot(std::move(snapshot.value()))
+            : store_module(mlir::cast< mlir_module >(mod->clone()));
+
+        trie.store(from.id, pass, handle.id);
+        evict();
+        return handle;
+    }
+
+    mlir_module module_storage::module(module_key_t module_key) const {
+        touch(module_key);
+
+        if (auto it = modules.find(module_key); it != modules.end()) {
+            return it->second.get();
+        }
+
+        if (auto it = materialized.find(module_key); it != materialized.end()) {
+            auto &position = it->second.position;
+            recently_materialized.splice(
+                recently_materialized.begin(), recently_materialized, position
+            );
+            return it->second.mod.get();
+        }
+
+        auto it = snapshots.find(module_key);
+        VAST_CHECK(it != snapshots.end(), "Required module not found in the storage!");
+
+        auto mod   = it->second.materialize();
+        auto bytes = estimate_size(mod->getOperation());
+        auto raw   = mod.get();
+
+        recently_materialized.push_front(module_key);
+        materialized.try_emplace(
+            module_key, materialized_t{ std::move(mod), recently_materialized.begin(), bytes }
+        );
+        materialized_bytes += bytes;
+
+        // The new module is the most recently used one, so it is kept.
+        drop_materialized(materialized_limit);
+        return raw;
+    }
+
+    void module_storage::drop_materialized(std::size_t keep) const {
+        while (materialized.size() > keep) {
+            auto module_key = recently_materialized.back();
+            recently_materialized.pop_back();
+
+            auto it = materialized.find(module_key);
+            materialized_bytes -= it->second.bytes;
+            materialized.erase(it);
+            op_index.erase(module_key);
+        }
+    }
+
+    operation module_storage::lookup(module_key_t module_key, std::uint64_t op_id) const {
+        auto &ops = op_index[module_key];
+        if (ops.empty()) {
+            module(module_key)->walk([&](operation op) {
+                auto id = location_info_t::self(op);
+                if (id >= ops.size()) {
+                    ops.resize(id + 1, nullptr);
+                }
+                ops[id] = op;
+            });
+        }
+
+        return op_id < ops.size() ? ops[op_id] : nullptr;
+    }
+
+    void module_storage::remove(handle_t handle) {
+        VAST_CHECK(!trie.is_root(handle.id), "Root module cannot be removed from the storage.");
+
+        for (auto module_key : trie.remove(handle.id)) {
+            modules.erase(module_key);
+            snapshots.erase(module_key);
+            op_index.erase(module_key);
+
+            if (auto it = materialized.find(module_key); it != materialized.end()) {
+                materialized_bytes -= it->second.bytes;
+                recently_materialized.erase(it->second.position);
+                materialized.erase(it);
+            }
+
+            if (auto it = usage.find(module_key); it != usage.end()) {
+                used_bytes -= it->second.bytes;
+                recently_used.erase(it->second.position);
+                usage.erase(it);
+            }
+        }
+    }
+
+    void module_storage::account(module_key_t module_key, std::size_t bytes) const {
+        auto [it, inserted] = usage.try_emplace(module_key);
+        if (inserted) {
+            recently_used.push_front(module_key);
+            it->second.position = recently_used.begin();
+        }
+
+        it->second.bytes += bytes;
+        used_bytes += bytes;
+    }
+
+    void module_storage::touch(module_key_t module_key) const {
+        if (auto it = usage.find(module_key); it != usage.end()) {
+            recently_used.splice(recently_used.begin(), recently_used, it->second.position);
+        }
+    }
+
+    void module_storage::pin(module_key_t module_key) const { ++pins[module_key]; }
+
+    void module_storage::unpin(module_key_t module_key) const {
+        auto it = pins.find(module_key);
+        VAST_ASSERT(it != pins.end());
+        if (--it->second == 0) {
+            pins.erase(it);
+        }
+    }
+
+    void module_storage::evict() {
+        drop_materialized(materialized_limit);
+
+        if (memory_limit == 0) {
+            return;
+        }
+
+        // Materialized modules can be rebuilt from their snapshots, so they
+        // are dropped before any stored module.
+        while (memory_usage() > memory_limit && !materialized.empty()) {
+            drop_materialized(materialized.size() - 1);
+        }
+
+        auto is_evictable = [&] (module_key_t module_key) {
+            return trie.is_leaf(module_key)
+                && !trie.is_root(module_key)
+                && !pins.count(module_key);
+        };
+
+        while (memory_usage() > memory_limit) {
+            // Modules with derived modules are kept, as the derived ones share
+            // bodies with them and are reachable only through them. Modules
+            // referenced by handles (e.g., by links) are kept as well.
+            auto least_recent = recently_used | std::views::reverse;
+            auto victim = std::ranges::find_if(least_recent, is_evictable);
+            if (victim == least_recent.end()) {
+                return;
+            }
+
+            remove(get(*victim));
+        }
+    }
+
+} // namespace vast::tw
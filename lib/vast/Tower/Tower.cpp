@@ -10,42 +10,34 @@ namespace vast::tw {
     {
         location_info_t &li;
         module_storage &storage;
-
-        // Start empty and after each callback add to it.
-        conversion_passes_t path   = {};
-        // TODO: Remove.
-        conversion_path_t str_path = {};
+        pass_keys_t keys;
 
         std::vector< handle_t > handles;
         link_vector steps;
 
-        explicit link_builder(location_info_t &li, module_storage &storage, handle_t root)
-            : li(li), storage(storage), handles{ root } {}
+        explicit link_builder(
+            location_info_t &li, module_storage &storage, pass_keys_t keys, handle_t root
+        )
+            : li(li), storage(storage), keys(std::move(keys)), handles{ root } {}
 
         void runAfterPass(pass_ptr pass, operation op) override {
-            auto current = op;
-            while (current && !mlir::isa< mlir_module >(current)) {
-                current = op->getParentOp();
-            }
-            auto mod = mlir::dyn_cast< mlir_module >(current);
-            VAST_CHECK(mod, "Pass inside tower was not run on module!");
-
-            // Update locations so each operation now has a unique loc that also
-            // encodes backlink.
-            path.emplace_back(pass);
-
-            // Location transformation depends on the command line argument
-            // of passes. If it is empty, don't perform location transformation.
-            if (!pass->getArgument().empty()) {
-                str_path.emplace_back(pass->getArgument().str());
-                transform_locations(li, str_path, op);
+            // Passes nested in an adaptor run on parts of the module, possibly
+            // in parallel. The module is snapshotted once the adaptor, which
+            // runs on the module, finishes.
+            auto mod = mlir::dyn_cast< mlir_module >(op);
+            if (!mod) {
+                return;
             }
 
-            // Clone the module to make it persistent
-            owning_mlir_module_ref persistent = mlir::dyn_cast< mlir_module >(mod->clone());
-
+            // Update locations so each operation now has a unique id, backlinks
+            // to the previous level are kept by the location info.
             auto from = handles.back();
-            handles.emplace_back(storage.store(path, std::move(persistent)));
+            auto locs = li.transform_locations(from.id, mod);
+
+            // Snapshot the module to make it persistent, operations untouched
+            // by the pass are shared with the previous level.
+            handles.emplace_back(storage.snapshot(keys(pass), mod, from));
+            li.tie(from.id, handles.back().id, std::move(locs));
             steps.emplace_back(std::make_unique< conversion_step >(from, handles.back(), li));
         }
 
@@ -68,8 +60,10 @@ namespace vast::tw {
 
     } // namespace
 
-    link_vector tower::mk_full_path(handle_t root, location_info_t &li, mlir::PassManager &pm) {
-        auto bld = std::make_unique< link_builder >(li, storage, top());
+    link_vector tower::mk_full_path(
+        handle_t root, location_info_t &li, mlir::PassManager &pm, pass_keys_t keys
+    ) {
+        auto bld = std::make_unique< link_builder >(li, storage, std::move(keys), root);
 
         // We need to access some of the data after passes are ran.
         auto raw_bld = bld.get();
@@ -89,11 +83,17 @@ namespace vast::tw {
         for (auto &p : requested_pm.getPasses()) {
             requested_passes.push_back(&p);
         }
-        auto [handles, suffix] = storage.get_maximum_prefix_path(requested_passes, root);
+
+        // Passes of the requested pipeline are keyed once for both the lookup
+        // and the newly stored levels.
+        pass_keys_t keys;
+        auto [handles, suffix] = storage.get_maximum_prefix_path(requested_passes, root, keys);
 
         // This path is completely new.
         if (handles.empty()) {
-            return std::make_unique< fat_link >(mk_full_path(root, li, requested_pm));
+            return std::make_unique< fat_link >(
+                mk_full_path(root, li, requested_pm, std::move(keys))
+            );
         }
 
         auto as_steps = construct_steps(handles, li);
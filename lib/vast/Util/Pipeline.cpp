@@ -14,11 +14,30 @@ namespace vast {
         }
 
         seen.insert(id);
+        pass_steps[id] = step_scope;
+        scheduled.push_back(pass.get());
         VAST_PIPELINE_DEBUG("scheduling pass: {0}", pass->getArgument());
 
         base::addPass(std::move(pass));
     }
 
+    void pipeline_t::addFunctionPass(owning_pass_ptr pass) {
+        auto id = pass->getTypeID();
+        if (seen.count(id)) {
+            return;
+        }
+
+        seen.insert(id);
+        pass_steps[id] = step_scope;
+        scheduled.push_back(pass.get());
+        VAST_PIPELINE_DEBUG("scheduling function pass: {0}", pass->getArgument());
+
+        // Functions are isolated from above, an op-agnostic pass manager
+        // schedules its passes on each of them.
+        auto &pm = this->nest< core::module >().nestAny();
+        pm.addPass(std::move(pass));
+    }
+
     gap::generator< pipeline_step_ptr > pipeline_step::dependencies() const {
         for (const auto &dep : deps) {
             co_yield dep();
@@ -54,6 +73,11 @@ namespace vast {
         return schedule_result::advance;
     }
 
+    schedule_result function_pass_pipeline_step::schedule_on(pipeline_t &ppl) {
+        ppl.addFunctionPass(take_pass());
+        return schedule_result::advance;
+    }
+
     string_ref pass_pipeline_step::name() const {
         return pass()->getName();
     }
@@ -70,13 +94,17 @@ namespace vast {
 
     schedule_result compound_pipeline_step::schedule_on(pipeline_t &ppl) {
         VAST_PIPELINE_DEBUG("scheduling compound step: {0}", pipeline_name);
+        ppl.enter_step(pipeline_name);
+        auto result = schedule_result::advance;
         for (const auto &step : steps) {
             if (ppl.schedule(step()) == schedule_result::stop) {
-                return schedule_result::stop;
+                result = schedule_result::stop;
+                break;
             }
         }
+        ppl.exit_step();
 
-        return schedule_result::advance;
+        return result;
     }
 
     string_ref compound_pipeline_step::name() const {
@@ -0,0 +1,178 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Profiler.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+VAST_UNRELAX_WARNINGS
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+namespace vast::util {
+
+    namespace {
+
+        std::size_t peak_rss() {
+#if defined(__unix__) || defined(__APPLE__)
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0) {
+                return 0;
+            }
+    #if defined(__APPLE__)
+            // reported in bytes on macOS
+            return static_cast< std::size_t >(usage.ru_maxrss) / 1024;
+    #else
+            return static_cast< std::size_t >(usage.ru_maxrss);
+    #endif
+#else
+            return 0;
+#endif
+        }
+
+        std::int64_t delta(std::size_t before, std::size_t after) {
+            return static_cast< std::int64_t >(after) - static_cast< std::int64_t >(before);
+        }
+
+    } // namespace
+
+    profile_sample profile_sample::take(operation root) {
+        profile_sample sample;
+
+        if (root) {
+            // A single walker visits each distinct attribute and type once,
+            // together with their nested elements, across all operations.
+            mlir::AttrTypeWalker walker;
+            walker.addWalk([&] (mlir::Attribute) { ++sample.attributes; });
+            walker.addWalk([&] (mlir_type) { ++sample.types; });
+
+            root->walk([&] (operation op) {
+                ++sample.ops;
+
+                walker.walk(op->getAttrDictionary());
+                walker.walk(mlir::Attribute(op->getLoc()));
+
+                for (auto type : op->getResultTypes()) {
+                    walker.walk(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArguments()) {
+                            walker.walk(arg.getType());
+                        }
+                    }
+                }
+            });
+        }
+
+        sample.peak_rss = peak_rss();
+        // Taken last, so the time spent sampling is not accounted.
+        sample.time = clock::now();
+        return sample;
+    }
+
+    llvm::json::Value profile_record::to_json() const {
+        using ms = std::chrono::duration< double, std::milli >;
+
+        return llvm::json::Object{
+            { "name", name },
+            { "wall_ms", ms(after.time - before.time).count() },
+            { "ops_before", static_cast< std::int64_t >(before.ops) },
+            { "ops_after", static_cast< std::int64_t >(after.ops) },
+            { "attributes_growth", delta(before.attributes, after.attributes) },
+            { "types_growth", delta(before.types, after.types) },
+            { "peak_rss_delta_kb", delta(before.peak_rss, after.peak_rss) }
+        };
+    }
+
+    void pipeline_profile::record_phase(profile_record rec) {
+        std::lock_guard< std::mutex > lock(mutex);
+        phases.push_back(std::move(rec));
+    }
+
+    void pipeline_profile::record_pass(
+        profile_record rec, const std::vector< std::string > &scope
+    ) {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        for (const auto &step : scope) {
+            auto [it, inserted] = step_index.try_emplace(step, steps.size());
+            if (inserted) {
+                steps.push_back({ step, rec.before, rec.after });
+            } else {
+                steps[it->second].after = rec.after;
+            }
+        }
+
+        passes.push_back(std::move(rec));
+    }
+
+    llvm::json::Value pipeline_profile::to_json() const {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        auto to_array = [] (const auto &records) {
+            llvm::json::Array out;
+            for (const auto &rec : records) {
+                out.push_back(rec.to_json());
+            }
+            return out;
+        };
+
+        return llvm::json::Object{
+            { "phases", to_array(phases) },
+            { "passes", to_array(passes) },
+            { "steps", to_array(steps) }
+        };
+    }
+
+    void pipeline_profile::write(string_ref path) const {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_Text);
+        VAST_CHECK(!ec, "Cannot open file to store pipeline profile, error code: {0}", ec.message());
+        os << llvm::formatv("{0:2}", to_json()) << '\n';
+    }
+
+    void with_profile::runBeforePass(pass_ptr pass, operation op) {
+        // Pass adaptors are not scheduled by the pipeline, their nested passes
+        // are recorded instead.
+        if (!pass_steps.count(pass->getTypeID())) {
+            return;
+        }
+
+        auto sample = profile_sample::take(op);
+        std::lock_guard< std::mutex > lock(mutex);
+        running[{ pass, op }] = sample;
+    }
+
+    void with_profile::runAfterPass(pass_ptr pass, operation op) {
+        auto steps = pass_steps.find(pass->getTypeID());
+        if (steps == pass_steps.end()) {
+            return;
+        }
+
+        auto end   = profile_sample::clock::now();
+        auto after = profile_sample::take(op);
+        after.time = end;
+
+        profile_sample before;
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+            auto it = running.find({ pass, op });
+            VAST_ASSERT(it != running.end());
+            before = it->second;
+            running.erase(it);
+        }
+
+        profile.record_pass({ pass->getArgument().str(), before, after }, steps->second);
+    }
+
+    void with_profile::runAfterPassFailed(pass_ptr pass, operation op) {
+        runAfterPass(pass, op);
+    }
+
+} // namespace vast::util
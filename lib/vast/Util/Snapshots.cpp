@@ -1,25 +1,186 @@
-
 // Copyright (c) 2024, Trail of Bits, Inc.
 
 #include "vast/Util/Snapshots.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/FileSystem.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::util {
 
+    std::optional< snapshot_format > parse_snapshot_format(string_ref format) {
+        if (format == "text") {
+            return snapshot_format::text;
+        }
+
+        if (format == "bytecode") {
+            return snapshot_format::bytecode;
+        }
+
+        if (format == "zstd") {
+            return snapshot_format::zstd;
+        }
+
+        return std::nullopt;
+    }
+
+    namespace {
+
+        string_ref file_suffix(snapshot_format format) {
+            switch (format) {
+                case snapshot_format::text: return "";
+                case snapshot_format::bytecode: return ".mlirbc";
+                case snapshot_format::zstd: return ".zst";
+            }
+
+            VAST_UNREACHABLE("unknown snapshot format");
+        }
+
+        auto open_output(string_ref path) {
+            std::error_code error_code;
+            auto os = std::make_unique< llvm::raw_fd_ostream >(path, error_code);
+            VAST_CHECK(!error_code, "Cannot open file to store snapshot, error code: {0}", error_code.message());
+            return os;
+        }
+
+    } // namespace
+
+    void snapshot_writer::write_now(snapshot_format format, operation op, string_ref path) {
+        switch (format) {
+            case snapshot_format::text: {
+                (*open_output(path)) << *op;
+                return;
+            }
+            case snapshot_format::bytecode: {
+                mlir::BytecodeWriterConfig config("VAST");
+                auto os = open_output(path);
+                VAST_CHECK(
+                    mlir::succeeded(mlir::writeBytecodeToFile(op, *os, config)),
+                    "Cannot write bytecode snapshot to {0}", path
+                );
+                return;
+            }
+            case snapshot_format::zstd: {
+                VAST_CHECK(
+                    llvm::compression::zstd::isAvailable(),
+                    "Compressed snapshots require LLVM built with zstd support"
+                );
+
+                std::string text;
+                llvm::raw_string_ostream ss(text);
+                ss << *op;
+
+                llvm::SmallVector< std::uint8_t, 0 > compressed;
+                llvm::compression::zstd::compress(
+                    llvm::arrayRefFromStringRef(ss.str()), compressed
+                );
+
+                (*open_output(path)) << llvm::toStringRef(compressed);
+                return;
+            }
+        }
+    }
+
+    snapshot_writer::snapshot_writer(snapshot_format format, std::size_t capacity)
+        : format(format), capacity(std::max< std::size_t >(capacity, 1))
+    {
+        worker = std::thread([this] { run(); });
+    }
+
+    snapshot_writer::~snapshot_writer() {
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+            done = true;
+        }
+
+        not_empty.notify_one();
+        worker.join();
+    }
+
+    void snapshot_writer::write(owning_op_ref op, std::string path) {
+        {
+            std::unique_lock< std::mutex > lock(mutex);
+            // Back-pressure, the pipeline waits rather than piling up clones.
+            not_full.wait(lock, [&] { return queue.size() < capacity; });
+            queue.push_back({ std::move(op), std::move(path) });
+        }
+
+        not_empty.notify_one();
+    }
+
+    void snapshot_writer::run() {
+        while (true) {
+            job next;
+            {
+                std::unique_lock< std::mutex > lock(mutex);
+                not_empty.wait(lock, [&] { return done || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+
+                next = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            not_full.notify_one();
+            write_now(format, next.op.get(), next.path);
+        }
+    }
+
     void with_snapshots::runAfterPass(pass_ptr pass, operation op) {
-        if (!should_snapshot(pass)) {
+        // Nested passes run on a part of the module, possibly in parallel
+        // with its siblings.
+        if (auto parent = op->getParentOp(); parent && parent->getParentOp()) {
+            if (should_snapshot(pass)) {
+                std::lock_guard< std::mutex > lock(mutex);
+                pending.insert(pass);
+            }
             return;
         }
 
-        auto os = make_output_stream(pass);
-        (*os) << *op;
+        llvm::SmallVector< pass_ptr > passes;
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+            passes.append(pending.begin(), pending.end());
+            pending.clear();
+        }
+
+        if (should_snapshot(pass)) {
+            passes.push_back(pass);
+        }
+
+        for (auto snapshotted : passes) {
+            snapshot(snapshotted, op);
+        }
+    }
+
+    void with_snapshots::snapshot(pass_ptr pass, operation op) {
+        auto path = make_output_path(pass);
+
+        // Without multithreading, the context is not guarded against
+        // concurrent uniquing, which printing may trigger.
+        if (!op->getContext()->isMultithreadingEnabled()) {
+            return snapshot_writer::write_now(format, op, path);
+        }
+
+        if (!writer) {
+            writer = std::make_unique< snapshot_writer >(format);
+        }
+
+        writer->write(snapshot_writer::owning_op_ref(op->clone()), std::move(path));
+    }
+
+    std::string with_snapshots::make_output_path(pass_ptr pass) const {
+        return file_prefix + "." + pass->getArgument().str() + file_suffix(format).str();
     }
 
     auto with_snapshots::make_output_stream(pass_ptr pass)
         -> output_stream_ptr
     {
-        std::string output_file_name = file_prefix + "." + pass->getArgument().str();
         std::error_code error_code;
-        auto os = std::make_shared< llvm::raw_fd_ostream >(output_file_name, error_code);
+        auto os = std::make_shared< llvm::raw_fd_ostream >(make_output_path(pass), error_code);
         VAST_CHECK(!error_code, "Cannot open file to store snapshot, error code: {0}", error_code.message());
         return os;
     }
@@ -1,10 +1,12 @@
 #include "vast/server/io.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <system_error>
 
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -81,6 +83,72 @@ namespace vast::server {
         return static_cast< size_t >(res);
     }
 
+    size_t sock_adapter::writev_some(std::span< const std::span< const char > > srcs) {
+        constexpr size_t max_iov = 16;
+        iovec iov[max_iov];
+
+        size_t count = std::min(srcs.size(), max_iov);
+        for (size_t i = 0; i < count; ++i) {
+            iov[i].iov_base = const_cast< char * >(srcs[i].data());
+            iov[i].iov_len  = srcs[i].size_bytes();
+        }
+
+        auto res = ::writev(pimpl->clientd, iov, static_cast< int >(count));
+        if (res == -1) {
+            throw connection_closed{};
+        }
+        return static_cast< size_t >(res);
+    }
+
+    void buffered_reader::fill(size_t size) {
+        if (head == tail) {
+            head = tail = 0;
+        }
+
+        while (tail - head < size) {
+            if (buffer.size() - head < size) {
+                std::copy(buffer.begin() + head, buffer.begin() + tail, buffer.begin());
+                tail -= head;
+                head  = 0;
+
+                if (buffer.size() < size) {
+                    buffer.resize(std::max(size, 2 * buffer.size()));
+                }
+            }
+
+            tail += adapter.read_some(std::span(buffer).subspan(tail));
+        }
+    }
+
+    std::string_view buffered_reader::read_until(char delim, size_t max_size) {
+        // Offset from `head` up to which the data was searched.
+        size_t searched = 0;
+        while (true) {
+            auto first = buffer.begin() + head;
+            auto last  = buffer.begin() + tail;
+            auto found = std::find(first + searched, last, delim);
+            if (found != last) {
+                std::string_view data(&*first, static_cast< size_t >(found - first) + 1);
+                head += data.size();
+                return data;
+            }
+
+            searched = tail - head;
+            if (searched >= max_size) {
+                throw protocol_error("Message header too large");
+            }
+
+            fill(searched + 1);
+        }
+    }
+
+    std::span< const char > buffered_reader::read(size_t size) {
+        fill(size);
+        std::span< const char > data(buffer.data() + head, size);
+        head += size;
+        return data;
+    }
+
     static descriptor bind_and_accept(
         descriptor &serverd, addr &sockaddr_server, size_t socklen_server,
         sockaddr *sockaddr_client, socklen_t *socklen_client
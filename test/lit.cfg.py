@@ -3,7 +3,9 @@
 import os
 import platform
 import re
+import shutil
 import subprocess
+import sys
 import tempfile
 
 import lit.formats
@@ -31,6 +33,7 @@ config.test_exec_root = os.path.join(config.vast_obj_root, 'test')
 
 config.substitutions.append(('%PATH%', config.environment['PATH']))
 config.substitutions.append(('%shlibext', config.llvm_shlib_ext))
+config.substitutions.append(('%python', '"%s"' % sys.executable))
 
 llvm_config.with_system_environment(
     ['HOME', 'INCLUDE', 'LIB', 'TMP', 'TEMP'])
@@ -144,3 +147,17 @@ miamcu_test = subprocess.run([vast_front, "-vast-emit-mlir=hl", "-x", "c", "-",
                              capture_output=True)
 if miamcu_test.returncode == 0:
     config.available_features.add("miamcu")
+
+# Compressed snapshots need LLVM built with zstd and the zstd tool to read
+# them back.
+if shutil.which("zstd"):
+    with tempfile.TemporaryDirectory() as tmp:
+        source = os.path.join(tmp, "probe.c")
+        with open(source, "w") as f:
+            f.write("int main() {}\n")
+        zstd_test = subprocess.run([vast_front, "-vast-emit-mlir=llvm",
+                                    "-vast-snapshot-at=vast-hl-to-ll-func",
+                                    "-vast-snapshot-format=zstd", source, "-o", "/dev/null"],
+                                   cwd=tmp, capture_output=True)
+        if zstd_test.returncode == 0:
+            config.available_features.add("zstd")
@@ -0,0 +1,179 @@
+# Copyright (c) 2024-present, Trail of Bits, Inc.
+
+# JSON-RPC client of the `vast-hl-to-parser` server for lit tests.
+#
+# Usage: server-client.py <scenario> -- <command...>
+#
+# Runs the command with `{socket}` replaced by a fresh Unix socket path,
+# connects to the server it starts and plays the scenario, printing what the
+# server answers. The server asks for a model of each unmodeled function
+# first and waits for the answers, which keeps it running while a scenario
+# talks to it.
+
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def frame(msg, header='Content-Length'):
+    body = json.dumps(msg).encode()
+    return f'{header}: {len(body)}\r\n\r\n'.encode() + body
+
+
+def request(id, name):
+    return {
+        'jsonrpc': '2.0', 'id': id,
+        'method': 'get_function_model', 'params': {'functionName': name}
+    }
+
+
+class client:
+    def __init__(self, path, server):
+        # The socket appears once the server binds it.
+        deadline = time.monotonic() + 60
+        while True:
+            self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                self.sock.connect(path)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                self.sock.close()
+                if time.monotonic() > deadline or server.poll() is not None:
+                    sys.exit('server did not start')
+                time.sleep(0.05)
+        self.buffer = b''
+
+    def send(self, data):
+        self.sock.sendall(data)
+
+    def fill(self, size):
+        while len(self.buffer) < size:
+            chunk = self.sock.recv(65536)
+            if not chunk:
+                return False
+            self.buffer += chunk
+        return True
+
+    # Next message or None once the server closes the connection.
+    def receive(self):
+        while b'\r\n\r\n' not in self.buffer:
+            if not self.fill(len(self.buffer) + 1):
+                return None
+        header, self.buffer = self.buffer.split(b'\r\n\r\n', 1)
+        size = None
+        for line in header.decode().split('\r\n'):
+            name, value = line.split(':', 1)
+            if name.lower() == 'content-length':
+                size = int(value)
+        if not self.fill(size):
+            return None
+        body, self.buffer = self.buffer[:size], self.buffer[size:]
+        return json.loads(body)
+
+    def close(self):
+        self.sock.shutdown(socket.SHUT_WR)
+        while self.receive() is not None:
+            pass
+        print('closed')
+
+
+def show(msg):
+    if 'error' in msg:
+        print(f"response {msg['id']}: error {msg['error']['code']} {msg['error']['message']}")
+    else:
+        print(f"response {msg['id']}: result {json.dumps(msg['result'], sort_keys=True)}")
+
+
+def wait_for_input(conn):
+    msg = conn.receive()
+    params = msg['params']
+    print(f"{msg['method']}: {params['functionName']} {params['numberOfArguments']}")
+    return msg['id']
+
+
+# Functions the client does not know are left to the defaults.
+def answer_input(conn, id):
+    conn.send(frame({
+        'jsonrpc': '2.0', 'id': id, 'error': {'code': 0, 'message': 'Unknown function'}
+    }))
+
+
+def framing(conn):
+    input_id = wait_for_input(conn)
+
+    # Header split across reads of the server.
+    data = frame(request(1, 'unknown'))
+    conn.send(data[:10])
+    time.sleep(0.1)
+    conn.send(data[10:])
+    show(conn.receive())
+
+    # Header names are case-insensitive, other headers are skipped.
+    conn.send(frame(request(2, 'unknown'), header='content-length'))
+    show(conn.receive())
+    conn.send(
+        b'content-type: application/json\r\n' + frame(request(3, 'unknown'), header='CONTENT-LENGTH')
+    )
+    show(conn.receive())
+
+    answer_input(conn, input_id)
+    conn.close()
+
+
+def oversized(conn):
+    wait_for_input(conn)
+
+    # The server gives up on the connection, the pending model request is
+    # answered by an error.
+    conn.send(b'Content-Length: ' + b'1' * 8192)
+    show(conn.receive())
+    conn.close()
+
+
+def cancel(conn):
+    input_id = wait_for_input(conn)
+
+    # Large responses to the first requests fill the socket buffer, the
+    # request thread blocks on writing them until we start reading.
+    flood = 32
+    name = 'f' * 65536
+    data = b''.join(frame(request(id, name)) for id in range(1, flood + 1))
+    data += frame(request(100, 'unknown'))
+    data += frame({'jsonrpc': '2.0', 'method': '$/cancelRequest', 'params': {'id': 100}})
+    conn.send(data)
+    time.sleep(1)
+
+    for _ in range(flood):
+        msg = conn.receive()
+        assert msg['error']['code'] == 0, msg
+    print(f'flood: {flood} responses')
+    show(conn.receive())
+
+    # Cancelling an answered request does nothing.
+    conn.send(frame({'jsonrpc': '2.0', 'method': '$/cancelRequest', 'params': {'id': 100}}))
+    conn.send(frame(request(101, 'unknown')))
+    show(conn.receive())
+
+    answer_input(conn, input_id)
+    conn.close()
+
+
+def main():
+    scenario = globals()[sys.argv[1]]
+    assert sys.argv[2] == '--'
+
+    with tempfile.TemporaryDirectory() as tmp:
+        # Short path, socket paths are limited to about a hundred bytes.
+        path = os.path.join(tmp, 'sock')
+        command = [arg.replace('{socket}', path) for arg in sys.argv[3:]]
+        server = subprocess.Popen(command)
+        scenario(client(path, server))
+        print(f'exit code: {server.wait()}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,25 @@
+// RUN: %vast-front -vast-show-locs -vast-loc-attrs -vast-emit-mlir=hl %s -o - | %vast-opt -vast-hl-to-lazy-regions -o %t.mlir
+// RUN: %python %S/Inputs/server-client.py framing -- %vast-detect-parsers -vast-hl-to-parser=socket={socket} %t.mlir -o /dev/null | %file-check %s -check-prefix=FRAMING
+// RUN: %python %S/Inputs/server-client.py oversized -- %vast-detect-parsers -vast-hl-to-parser=socket={socket} %t.mlir -o /dev/null | %file-check %s -check-prefix=OVERSIZED
+// RUN: %python %S/Inputs/server-client.py cancel -- %vast-detect-parsers -vast-hl-to-parser=socket={socket} %t.mlir -o /dev/null | %file-check %s -check-prefix=CANCEL
+
+// FRAMING: input: unmodeled 1
+// FRAMING-NEXT: response 1: error 0 No model for function unknown available
+// FRAMING-NEXT: response 2: error 0 No model for function unknown available
+// FRAMING-NEXT: response 3: error 0 No model for function unknown available
+// FRAMING-NEXT: closed
+// FRAMING-NEXT: exit code: 0
+
+// OVERSIZED: input: unmodeled 1
+// OVERSIZED-NEXT: response None: error -32700 Message header too large
+// OVERSIZED-NEXT: closed
+// OVERSIZED-NEXT: exit code: 0
+
+// CANCEL: input: unmodeled 1
+// CANCEL-NEXT: flood: 32 responses
+// CANCEL-NEXT: response 100: error -32800 Request cancelled
+// CANCEL-NEXT: response 101: error 0 No model for function unknown available
+// CANCEL-NEXT: closed
+// CANCEL-NEXT: exit code: 0
+
+int unmodeled(int x) { return x; }
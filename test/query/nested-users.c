@@ -0,0 +1,29 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --symbol-users=v --scope=nested %t | \
+// RUN: %file-check %s -check-prefix=NESTED
+
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --symbol-users=callee %t | \
+// RUN: %file-check %s -check-prefix=CALLEE
+
+// Uses in regions nested in the scope of the variable are users.
+// NESTED: hl.var @v
+// NESTED-COUNT-5: hl.ref @v
+// NESTED-NOT: hl.ref @v
+int nested(int x) {
+    int v = x;
+    if (v) {
+        while (v) {
+            v = v - 1;
+        }
+    }
+    return v;
+}
+
+// CALLEE: hl.func @callee
+// CALLEE: hl.call @callee
+int callee(int);
+
+int caller(int a) { return callee(a); }
+
+int callee(int a) { return a; }
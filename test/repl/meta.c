@@ -0,0 +1,11 @@
+// RUN: printf "load %s\n meta add 7 foo\n meta get 7\n meta get 8\n exit" | %vast-repl | %file-check %s
+
+// Adding the identifier prints the symbol.
+// CHECK: hl.func @foo {{.*}}meta_identifier = #meta.id<7>
+// The index of identifiers sees the added one.
+// CHECK: hl.func @foo {{.*}}meta_identifier = #meta.id<7>
+// No operation has the other identifier.
+// CHECK-NOT: meta_identifier
+int foo(void) { return 0; }
+
+int bar(void) { return foo(); }
@@ -0,0 +1,16 @@
+// RUN: printf "load %s\n raise vast-hl-lower-typedefs a\n raise vast-hl-lower-elaborated-types b\n raise vast-hl-splice-trailing-scopes b\n show link a\n tower stats\n tower limit 1\n tower stats\n show link a\n exit" | %vast-repl | %file-check %s
+
+typedef int int_t;
+
+// CHECK: levels: 4
+// CHECK-NEXT: materialized: 1
+
+// Materialized modules and the level no longer used by any link are evicted,
+// the root and levels used by links stay.
+// CHECK: levels: 3
+// CHECK-NEXT: materialized: 0
+
+// Evicted materialized module is rebuilt from its snapshot.
+// CHECK: hl.func @main {{.*}}@int_t
+// CHECK-NEXT: => hl.func @main {{.*}}!hl.int
+int_t main(void) { return 0; }
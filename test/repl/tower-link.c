@@ -0,0 +1,16 @@
+// RUN: printf "load %s\n raise vast-hl-lower-typedefs,vast-hl-lower-elaborated-types two\n show link two\n exit" | %vast-repl | %file-check %s
+
+typedef struct pair { int first, second; } pair_t;
+
+// Children of operations are composed over both steps.
+// CHECK: hl.func @first {{.*}}@pair_t
+// CHECK-NEXT: => hl.func @first {{.*}}!hl.record<@pair>
+// CHECK: hl.return
+// CHECK-NEXT: => hl.return
+
+// Parents lead back to the operations of the first module.
+// CHECK: hl.func @first {{.*}}!hl.record<@pair>
+// CHECK-NEXT: <= hl.func @first {{.*}}@pair_t
+// CHECK: hl.return
+// CHECK-NEXT: <= hl.return
+int first(pair_t p) { return p.first; }
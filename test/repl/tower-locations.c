@@ -0,0 +1,11 @@
+// RUN: printf "load %s\n raise vast-hl-lower-typedefs locs\n show link locs\n exit" | %vast-repl | %file-check %s -check-prefix=LOCS
+// RUN: printf "load %s locs-as-meta-ids\n raise vast-hl-lower-typedefs ids\n show link ids\n exit" | %vast-repl | %file-check %s -check-prefix=META
+
+typedef int int_t;
+
+// LOCS: hl.func @main {{.*}} loc("{{.*}}tower-locations.c":[[# @LINE + 5]]:7)
+// LOCS-NEXT: => hl.func @main {{.*}} loc("{{.*}}tower-locations.c":[[# @LINE + 4]]:7)
+
+// META: hl.func @main {{.*}}#meta.id<[[ID:[0-9]+]]>
+// META-NEXT: => hl.func @main {{.*}}#meta.id<[[ID]]>
+int_t main(void) { return 0; }
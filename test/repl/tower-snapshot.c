@@ -0,0 +1,20 @@
+// RUN: printf "load %s\n raise vast-hl-lower-typedefs td\n tower stats\n show link td\n tower stats\n exit" | %vast-repl | %file-check %s
+
+// Levels derived by passes are stored as snapshots.
+// CHECK: levels: 2
+// CHECK-NEXT: materialized: 0
+
+typedef int int_t;
+
+// The module rebuilt from the snapshot has the structure and the locations
+// it had after the pass.
+// CHECK: hl.func @untouched {{.*}} loc("{{.*}}tower-snapshot.c":[[# @LINE + 2]]:5)
+// CHECK-NEXT: => hl.func @untouched {{.*}} loc("{{.*}}tower-snapshot.c":[[# @LINE + 1]]:5)
+int untouched(void) { return 0; }
+
+// CHECK: hl.func @changed {{.*}}@int_t{{.*}} loc("{{.*}}tower-snapshot.c":[[# @LINE + 2]]:7)
+// CHECK-NEXT: => hl.func @changed {{.*}}!hl.int{{.*}} loc("{{.*}}tower-snapshot.c":[[# @LINE + 1]]:7)
+int_t changed(void) { return 0; }
+
+// CHECK: levels: 2
+// CHECK-NEXT: materialized: 1
@@ -0,0 +1,17 @@
+// RUN: printf "load %s\n raise vast-hl-lower-typedefs a\n tower stats\n raise vast-hl-lower-typedefs b\n tower stats\n raise vast-hl-lower-typedefs,vast-hl-lower-elaborated-types c\n tower stats\n raise vast-hl-lower-elaborated-types d\n tower stats\n exit" | %vast-repl | %file-check %s
+
+// Root and the level after lowering typedefs.
+// CHECK: levels: 2
+// The same pipeline is found in the tower.
+// CHECK: levels: 2
+// Only the suffix of the pipeline is stored.
+// CHECK: levels: 3
+// A different pass from the root is a new branch.
+// CHECK: levels: 4
+
+typedef struct point { int x, y; } point_t;
+
+int main(void) {
+    point_t p = { 0, 0 };
+    return p.x;
+}
@@ -0,0 +1,7 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{"directory": "%t", "file": "%s", "arguments": ["clang", "-c", "%s"]}]' > %t/compile_commands.json
+// RUN: %vast-front -vast-compile-commands=%t/compile_commands.json -vast-emit-mlir=hl -vast-batch-jobs=2
+// RUN: cat %t/batch-a.mlir | %file-check %s
+
+// CHECK: hl.func @batch_fn
+int batch_fn(int a) { return a; }
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %vast-front -vast-module-cache-dir=%t/cache -vast-module-cache-remarks -vast-emit-mlir=std %s -o %t/std.mlir 2>&1 | %file-check %s -check-prefix=MISS
+// RUN: %vast-front -vast-module-cache-dir=%t/cache -vast-module-cache-remarks -vast-emit-mlir=std %s -o %t/std-cached.mlir 2>&1 | %file-check %s -check-prefix=HIT
+// RUN: diff %t/std.mlir %t/std-cached.mlir
+// RUN: %vast-front -vast-module-cache-dir=%t/cache -vast-module-cache-remarks -vast-emit-mlir=llvm %s -o %t/llvm-resumed.mlir 2>&1 | %file-check %s -check-prefix=RESUMED
+// RUN: %vast-front -vast-emit-mlir=llvm %s -o %t/llvm.mlir
+// RUN: diff %t/llvm.mlir %t/llvm-resumed.mlir
+// RUN: cat %t/llvm-resumed.mlir | %file-check %s
+
+// MISS: remark: module cache miss
+// HIT: remark: module cache hit after [[STD:[0-9]+]] of [[STD]] pipeline passes
+// RESUMED: remark: module cache hit after {{[1-9][0-9]*}} of {{[1-9][0-9]*}} pipeline passes
+
+// CHECK: llvm.func @cached_fn
+int cached_fn(int a) { return a + 1; }
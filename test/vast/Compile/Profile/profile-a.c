@@ -0,0 +1,31 @@
+// RUN: %vast-front -vast-emit-mlir=llvm -vast-profile-pipeline=%t.json %s -o %t.mlir
+// RUN: cat %t.json | %file-check %s
+
+// Keys of records are printed in the alphabetical order.
+
+// CHECK-LABEL: "passes": [
+// CHECK:         "name": "vast-hl-to-ll-func",
+// CHECK:         "wall_ms": {{[0-9]}}
+
+// CHECK-LABEL: "phases": [
+// CHECK:         "name": "clang-parse",
+// CHECK:         "wall_ms": {{[0-9]}}
+// CHECK:         "attributes_growth": {{[1-9]}}
+// CHECK-NEXT:    "name": "codegen",
+// CHECK-NEXT:    "ops_after": {{[1-9]}}
+// CHECK-NEXT:    "ops_before": 0,
+// CHECK:         "types_growth": {{[1-9]}}
+// CHECK-NEXT:    "wall_ms": {{[0-9]}}
+// CHECK:         "name": "codegen-finalize",
+// CHECK:         "wall_ms": {{[0-9]}}
+// CHECK:         "name": "frontend",
+// CHECK:         "wall_ms": {{[0-9]}}
+
+// CHECK-LABEL: "steps": [
+// CHECK:         "name": "to-llvm",
+
+static int deferred(int);
+
+int profiled(int a) { return deferred(a) + 1; }
+
+static int deferred(int a) { return a * 2; }
@@ -0,0 +1,8 @@
+// RUN: rm -rf %t && mkdir -p %t && cd %t
+// RUN: %vast-front -vast-emit-mlir=llvm -vast-snapshot-at=vast-hl-to-ll-func -vast-snapshot-format=bytecode %s -o %t/out.mlir
+// RUN: %vast-opt %t/snapshot-bytecode.vast-hl-to-ll-func.mlirbc | %file-check %s
+
+// CHECK: ll.func {{.*}}@add
+// CHECK: hl.add
+
+int add(int a, int b) { return a + b; }
@@ -0,0 +1,9 @@
+// REQUIRES: zstd
+// RUN: rm -rf %t && mkdir -p %t && cd %t
+// RUN: %vast-front -vast-emit-mlir=llvm -vast-snapshot-at=vast-hl-to-ll-func -vast-snapshot-format=zstd %s -o %t/out.mlir
+// RUN: zstd -dc %t/snapshot-zstd.vast-hl-to-ll-func.zst | %vast-opt | %file-check %s
+
+// CHECK: ll.func {{.*}}@add
+// CHECK: hl.add
+
+int add(int a, int b) { return a + b; }
@@ -0,0 +1,23 @@
+// RUN: %vast-front -vast-emit-mlir-after=vast-hl-lower-enum-decls %s -o %t.mlir
+// RUN: %file-check --input-file=%t.mlir %s -check-prefix=ENUM
+
+// Both enum passes share the symbol table cache, declarations erased by the
+// second one are removed from it while the shadowing enum is resolved.
+
+// ENUM-NOT: hl.enum
+enum E : char { E_a };
+
+// ENUM: hl.func @inner {{.*}} () -> !hl.long
+long inner(void) {
+    enum E : long { E_b = 1 };
+    // ENUM: hl.var @e : !hl.lvalue<!hl.long>
+    enum E e = E_b;
+    return e;
+}
+
+// ENUM: hl.func @outer {{.*}} () -> !hl.char
+enum E outer(void) {
+    // ENUM: hl.var @e : !hl.lvalue<!hl.char>
+    enum E e = E_a;
+    return e;
+}
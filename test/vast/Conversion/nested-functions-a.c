@@ -0,0 +1,19 @@
+// RUN: %vast-front -vast-emit-mlir-after=vast-lower-value-categories %s -o %t.mlir
+// RUN: %file-check --input-file=%t.mlir %s -check-prefix=VAL_CAT
+// RUN: %vast-front -vast-emit-mlir-after=vast-irs-to-llvm %s -o %t.mlir
+// RUN: %file-check --input-file=%t.mlir %s -check-prefix=LLVM
+
+// Function-level conversions run nested on functions, globals are converted
+// by their module-level counterparts.
+
+// VAL_CAT-NOT: hl.lvalue
+// VAL_CAT-NOT: hl.ref
+
+// LLVM: llvm.mlir.global {{.*}} @g
+int g = 1;
+
+// LLVM: llvm.func @first
+int first(int a) { return a + g; }
+
+// LLVM: llvm.func @second
+int second(int b) { return first(b) * 2; }
@@ -0,0 +1,68 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl -vast-canonicalize %s -o - | %file-check %s
+
+// CHECK-LABEL: hl.func @arith
+int arith(void) {
+    // CHECK: hl.const #core.integer<12> : !hl.int
+    // CHECK-NOT: hl.add
+    return 10 + 5 - 3;
+}
+
+// CHECK-LABEL: hl.func @signed_overflow
+int signed_overflow(void) {
+    // CHECK: hl.add
+    return 2147483647 + 1;
+}
+
+// CHECK-LABEL: hl.func @unsigned_wrap
+unsigned unsigned_wrap(void) {
+    // CHECK: hl.const #core.integer<1> : !hl.int< unsigned >
+    // CHECK-NOT: hl.add
+    return 4294967295u + 2u;
+}
+
+// CHECK-LABEL: hl.func @div_by_zero
+int div_by_zero(void) {
+    // CHECK: hl.sdiv
+    return 1 / 0;
+}
+
+// CHECK-LABEL: hl.func @shift
+int shift(void) {
+    // CHECK: hl.const #core.integer<16> : !hl.int
+    // CHECK-NOT: hl.bin.shl
+    return 1 << 4;
+}
+
+// CHECK-LABEL: hl.func @shift_too_far
+int shift_too_far(void) {
+    // CHECK: hl.bin.shl
+    return 1 << 40;
+}
+
+// CHECK-LABEL: hl.func @cmp
+int cmp(void) {
+    // CHECK: hl.const #core.integer<1> : !hl.int
+    // CHECK-NOT: hl.cmp
+    return 3 < 5;
+}
+
+// CHECK-LABEL: hl.func @narrowing
+int narrowing(void) {
+    // CHECK: hl.const #core.integer<44> : !hl.int
+    // CHECK-NOT: hl.cstyle_cast
+    return (char)300;
+}
+
+// CHECK-LABEL: hl.func @truncation
+int truncation(void) {
+    // CHECK: hl.const #core.integer<2> : !hl.int
+    // CHECK-NOT: hl.cstyle_cast
+    return (int)2.75;
+}
+
+// CHECK-LABEL: hl.func @float_arith
+double float_arith(void) {
+    // CHECK: hl.const #core.float<{{.*}}> : !hl.double
+    // CHECK-NOT: hl.fadd
+    return 1.5 + 2.25;
+}
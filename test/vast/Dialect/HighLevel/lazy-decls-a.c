@@ -0,0 +1,23 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-lazy-decls %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-lazy-decls %s -o - | %file-check %s -check-prefix=UNUSED
+
+// UNUSED-NOT: unused
+
+typedef int unused_t;
+struct unused_record { unused_t x; };
+void unused_fn(void);
+static int unused_helper(void) { return 0; }
+
+// Required declarations precede their users.
+// CHECK: hl.typedef @used_t
+// CHECK: hl.struct @used_record
+// CHECK: hl.func @helper
+// CHECK: hl.func @main
+typedef int used_t;
+struct used_record { used_t x; };
+static int helper(struct used_record *r) { return r->x; }
+
+int main(void) {
+    struct used_record r = { 0 };
+    return helper(&r);
+}
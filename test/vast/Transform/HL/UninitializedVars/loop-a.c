@@ -0,0 +1,21 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-uninitialized-vars -o /dev/null 2>&1 | %file-check %s
+
+int read_before_write(int n) {
+    int acc;
+    for (int i = 0; i < n; ++i) {
+        // CHECK: warning: variable 'acc' may be uninitialized when used here
+        acc += i;
+    }
+    return 0;
+}
+
+int written_before_read(int n) {
+    int last;
+    for (int i = 0; i < n; ++i) {
+        last = i;
+    }
+    int size = sizeof(last);
+    return n > 0 ? size : 0;
+}
+
+// CHECK-NOT: warning
@@ -0,0 +1,29 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-uninitialized-vars -o /dev/null 2>&1 | %file-check %s
+
+int on_all_paths(void) {
+    int x;
+    // CHECK: warning: variable 'x' is uninitialized when used here
+    return x;
+}
+
+int on_some_paths(int c) {
+    int y;
+    if (c)
+        y = 1;
+    // CHECK: warning: variable 'y' may be uninitialized when used here
+    return y;
+}
+
+int initialized(int c) {
+    int z = 0;
+    int w;
+    if (c)
+        w = 1;
+    else
+        w = 2;
+    int v;
+    int *p = &v;
+    return z + w + *p;
+}
+
+// CHECK-NOT: warning
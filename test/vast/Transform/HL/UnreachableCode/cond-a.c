@@ -0,0 +1,22 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-unreachable-code -o /dev/null 2>&1 | %file-check %s
+
+void sink(int);
+
+void constant_condition(void) {
+    if (0) {
+        // CHECK: warning: code will never be executed
+        sink(1);
+    }
+    sink(2);
+}
+
+int all_cases_return(int x) {
+    switch (x) {
+        case 0: return 1;
+        default: return 2;
+    }
+    // CHECK: warning: code will never be executed
+    return 3;
+}
+
+// CHECK-NOT: warning
@@ -0,0 +1,18 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-unreachable-code -o /dev/null 2>&1 | %file-check %s
+
+int after_return(int x) {
+    return x;
+    // CHECK: warning: code will never be executed
+    x = x + 1;
+    return x;
+}
+
+// CHECK-NOT: warning
+int after_loop(int x) {
+    while (1) {
+        if (x > 10)
+            break;
+        x++;
+    }
+    return x;
+}
@@ -0,0 +1,277 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "generators.hpp"
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+#include <iterator>
+
+namespace vast::bench {
+
+    namespace {
+
+        // Clang limits nesting of brackets to 256 by default.
+        constexpr std::size_t max_nesting_depth = 200;
+
+        struct source_builder
+        {
+            source_builder() : os(buffer) {}
+
+            source_file finish(std::string name) {
+                return { std::move(name), std::move(os.str()) };
+            }
+
+            std::string buffer;
+            llvm::raw_string_ostream os;
+        };
+
+        const char *scalar_types[] = {
+            "char", "short", "int", "long", "unsigned", "float", "double", "long long"
+        };
+
+    } // namespace
+
+    //
+    // N functions with M arithmetic and control flow statements each.
+    //
+    workload functions(std::size_t scale) {
+        const std::size_t count = 50 * scale;
+        const std::size_t statements = 20;
+
+        source_builder src;
+        auto &os = src.os;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            os << "int fn_" << i << "(int a, int b) {\n"
+               << "    int acc = a;\n";
+            for (std::size_t s = 0; s < statements; ++s) {
+                switch (s % 4) {
+                    case 0: os << "    acc = acc * " << s + 3 << " + b;\n"; break;
+                    case 1: os << "    if (acc > " << s * 7 << ") acc -= b;\n"; break;
+                    case 2: os << "    acc ^= (a << " << s % 8 << ");\n"; break;
+                    case 3: os << "    for (int i = 0; i < " << s << "; ++i) acc += i;\n"; break;
+                }
+            }
+            os << "    return acc;\n}\n\n";
+        }
+
+        os << "int main(void) {\n    int r = 0;\n";
+        for (std::size_t i = 0; i < count; ++i) {
+            os << "    r += fn_" << i << "(r, " << i << ");\n";
+        }
+        os << "    return r;\n}\n";
+
+        return { "functions", src.finish("functions.c"), {} };
+    }
+
+    //
+    // Deeply nested loops, conditionals and compound statements.
+    //
+    workload nesting(std::size_t scale) {
+        const std::size_t depth = std::min(16 * scale, max_nesting_depth);
+        const std::size_t bodies = 10 * scale;
+
+        source_builder src;
+        auto &os = src.os;
+
+        for (std::size_t f = 0; f < bodies; ++f) {
+            os << "int nested_" << f << "(int n) {\n    int acc = 0;\n";
+            for (std::size_t d = 0; d < depth; ++d) {
+                switch (d % 3) {
+                    case 0: os << "for (int i" << d << " = 0; i" << d << " < n; ++i" << d << ") {\n"; break;
+                    case 1: os << "if (acc % " << d + 2 << " != 0) {\n"; break;
+                    case 2: os << "while (acc < " << d * 11 << ") { acc += 3;\n"; break;
+                }
+                os << "acc += " << d << ";\n";
+            }
+            for (std::size_t d = 0; d < depth; ++d) {
+                os << "}\n";
+            }
+            os << "    return acc;\n}\n\n";
+        }
+
+        return { "nesting", src.finish("nesting.c"), {} };
+    }
+
+    //
+    // Wide structures and unions, nested records and field accesses.
+    //
+    workload records(std::size_t scale) {
+        const std::size_t count = 10 * scale;
+        const std::size_t fields = 64;
+
+        source_builder src;
+        auto &os = src.os;
+
+        auto emit_fields = [&] (std::size_t record) {
+            for (std::size_t i = 0; i < fields; ++i) {
+                auto type = scalar_types[(record + i) % std::size(scalar_types)];
+                os << "    " << type << " f" << i;
+                if (i % 16 == 15) {
+                    os << "[" << i << "]";
+                }
+                os << ";\n";
+            }
+        };
+
+        for (std::size_t r = 0; r < count; ++r) {
+            os << "struct wide_" << r << " {\n";
+            emit_fields(r);
+            os << "    struct inner_" << r << " { int x; double y; } inner;\n";
+            if (r > 0) {
+                os << "    struct wide_" << r - 1 << " *prev;\n";
+            }
+            os << "};\n\n";
+
+            os << "union variant_" << r << " {\n";
+            emit_fields(r + 1);
+            os << "    struct wide_" << r << " whole;\n";
+            os << "};\n\n";
+
+            os << "typedef struct wide_" << r << " wide_" << r << "_t;\n\n";
+
+            os << "double sum_" << r << "(wide_" << r << "_t *w, union variant_" << r << " *v) {\n"
+               << "    double acc = w->inner.y + v->whole.inner.x;\n";
+            // Scalar fields only, arrays are at indices `16k + 15`.
+            for (std::size_t i = 0; i < fields; i += 4) {
+                os << "    acc += w->f" << i << ";\n";
+            }
+            os << "    return acc;\n}\n\n";
+        }
+
+        return { "records", src.finish("records.c"), {} };
+    }
+
+    //
+    // Large constant tables and arrays of initialized structures.
+    //
+    workload initializers(std::size_t scale) {
+        const std::size_t elements = 2000 * scale;
+
+        source_builder src;
+        auto &os = src.os;
+
+        os << "static const int table[" << elements << "] = {\n";
+        for (std::size_t i = 0; i < elements; ++i) {
+            os << "    " << (i * 2654435761u) % 100000 << ",\n";
+        }
+        os << "};\n\n";
+
+        os << "struct entry { const char *name; int id; double weight; int tags[4]; };\n\n";
+        os << "static struct entry entries[] = {\n";
+        for (std::size_t i = 0; i < elements / 4; ++i) {
+            os << "    { \"entry_" << i << "\", " << i << ", " << i << ".5, { "
+               << i % 3 << ", " << i % 5 << ", " << i % 7 << ", " << i % 11 << " } },\n";
+        }
+        os << "};\n\n";
+
+        os << "int lookup(int i) { return table[i % " << elements << "] + entries[i % "
+           << elements / 4 << "].id; }\n";
+
+        return { "initializers", src.finish("initializers.c"), {} };
+    }
+
+    //
+    // A unit including many headers full of declarations, only a few of
+    // which are used.
+    //
+    workload headers(std::size_t scale) {
+        const std::size_t count = 20 * scale;
+        const std::size_t decls = 25;
+
+        workload out{ "headers", {}, {} };
+
+        for (std::size_t h = 0; h < count; ++h) {
+            source_builder hdr;
+            auto &os = hdr.os;
+
+            auto guard = "BENCH_HEADER_" + std::to_string(h) + "_H";
+            os << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+            for (std::size_t d = 0; d < decls; ++d) {
+                auto id = std::to_string(h) + "_" + std::to_string(d);
+                auto type = scalar_types[(h + d) % std::size(scalar_types)];
+                os << "typedef " << type << " h_type_" << id << ";\n"
+                   << "struct h_record_" << id << " { h_type_" << id << " value; int count; };\n"
+                   << "h_type_" << id << " h_decl_" << id << "(struct h_record_" << id << " *);\n"
+                   << "static inline int h_inline_" << id << "(int x) { return x * "
+                   << d + 1 << "; }\n"
+                   << "#define H_MACRO_" << id << "(x) ((x) + " << d << ")\n\n";
+            }
+            os << "#endif\n";
+
+            out.headers.push_back(hdr.finish("header_" + std::to_string(h) + ".h"));
+        }
+
+        source_builder src;
+        auto &os = src.os;
+        for (const auto &header : out.headers) {
+            os << "#include \"" << header.name << "\"\n";
+        }
+
+        os << "\nint main(void) {\n    int r = 0;\n";
+        for (std::size_t h = 0; h < count; ++h) {
+            os << "    r += H_MACRO_" << h << "_0(h_inline_" << h << "_1(r));\n";
+        }
+        os << "    return r;\n}\n";
+
+        out.main = src.finish("headers.c");
+        return out;
+    }
+
+    //
+    // Switch-heavy state machine over a large enumeration.
+    //
+    workload state_machine(std::size_t scale) {
+        const std::size_t states = 100 * scale;
+
+        source_builder src;
+        auto &os = src.os;
+
+        os << "enum state {\n";
+        for (std::size_t s = 0; s < states; ++s) {
+            os << "    STATE_" << s << ",\n";
+        }
+        os << "    STATE_COUNT\n};\n\n";
+
+        os << "enum state step(enum state current, int input) {\n"
+           << "    switch (current) {\n";
+        for (std::size_t s = 0; s < states; ++s) {
+            os << "        case STATE_" << s << ":\n"
+               << "            switch (input & 3) {\n"
+               << "                case 0: return STATE_" << (s + 1) % states << ";\n"
+               << "                case 1: return STATE_" << (s * 7 + 3) % states << ";\n"
+               << "                case 2: if (input > " << s << ") return STATE_" << s / 2 << ";\n"
+               << "                        break;\n"
+               << "                default: break;\n"
+               << "            }\n"
+               << "            break;\n";
+        }
+        os << "        default: break;\n    }\n    return current;\n}\n\n";
+
+        os << "int run(const int *inputs, int n) {\n"
+           << "    enum state s = STATE_0;\n"
+           << "    for (int i = 0; i < n; ++i)\n"
+           << "        s = step(s, inputs[i]);\n"
+           << "    return s;\n}\n";
+
+        return { "state-machine", src.finish("state_machine.c"), {} };
+    }
+
+    const std::vector< generator_info > &generators() {
+        static const std::vector< generator_info > all = {
+            { "functions", "many functions with arithmetic and loops", functions },
+            { "nesting", "deeply nested control flow", nesting },
+            { "records", "wide structures and unions", records },
+            { "initializers", "large initializer lists", initializers },
+            { "headers", "header-heavy translation unit", headers },
+            { "state-machine", "switch-heavy state machine", state_machine },
+        };
+        return all;
+    }
+
+} // namespace vast::bench
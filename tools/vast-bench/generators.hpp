@@ -0,0 +1,46 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace vast::bench {
+
+    struct source_file
+    {
+        std::string name;
+        std::string content;
+    };
+
+    //
+    // Synthetic translation unit. Headers are placed next to the main file.
+    //
+    struct workload
+    {
+        std::string name;
+        source_file main;
+        std::vector< source_file > headers;
+    };
+
+    using generator_t = workload (*)(std::size_t scale);
+
+    struct generator_info
+    {
+        const char *name;
+        const char *description;
+        generator_t generate;
+    };
+
+    // Workloads grow linearly with `scale`.
+    workload functions(std::size_t scale);
+    workload nesting(std::size_t scale);
+    workload records(std::size_t scale);
+    workload initializers(std::size_t scale);
+    workload headers(std::size_t scale);
+    workload state_machine(std::size_t scale);
+
+    const std::vector< generator_info > &generators();
+
+} // namespace vast::bench
@@ -0,0 +1,530 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/ManagedStatic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "generators.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cl
+{
+    namespace cl = llvm::cl;
+
+    // clang-format off
+    cl::OptionCategory generic("Vast Benchmark Options");
+
+    struct vast_bench_options {
+        cl::list< std::string > workloads{ "workloads",
+            cl::desc("Workloads to run, all by default"),
+            cl::CommaSeparated,
+            cl::cat(generic)
+        };
+        cl::opt< unsigned > scale{ "scale",
+            cl::desc("Size multiplier of generated workloads"),
+            cl::init(1),
+            cl::cat(generic)
+        };
+        cl::opt< unsigned > repeat{ "repeat",
+            cl::desc("Number of runs per workload, the fastest run is reported"),
+            cl::init(3),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > target{ "target",
+            cl::desc("Target dialect of the pipeline"),
+            cl::value_desc("dialect"),
+            cl::init("llvm"),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > vast_front{ "vast-front",
+            cl::desc("Path to vast-front, defaults to the one next to vast-bench"),
+            cl::value_desc("path"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > work_dir{ "work-dir",
+            cl::desc("Directory for generated sources and profiles"),
+            cl::value_desc("directory"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > output{ "output",
+            cl::desc("Store results as JSON, usable as a baseline of later runs"),
+            cl::value_desc("filename"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > baseline{ "baseline",
+            cl::desc("Compare results with a stored baseline"),
+            cl::value_desc("filename"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< double > tolerance{ "tolerance",
+            cl::desc("Allowed slowdown against the baseline in percent"),
+            cl::init(10.0),
+            cl::cat(generic)
+        };
+        cl::opt< bool > list{ "list",
+            cl::desc("List available workloads"),
+            cl::init(false),
+            cl::cat(generic)
+        };
+    };
+    // clang-format on
+
+    static llvm::ManagedStatic< vast_bench_options > options;
+
+    void register_options() { *options; }
+} // namespace vast::cl
+
+namespace vast::bench
+{
+    // Measurements below this threshold are dominated by noise and are not
+    // compared with the baseline.
+    constexpr double min_compared_ms = 5.0;
+
+    struct stage_result
+    {
+        std::string name;
+        double wall_ms = 0;
+        std::int64_t ops = 0;
+
+        double ops_per_sec() const {
+            return wall_ms > 0 ? static_cast< double >(ops) * 1000.0 / wall_ms : 0.0;
+        }
+    };
+
+    struct workload_result
+    {
+        std::string name;
+        double wall_ms = 0;
+        double cpu_ms  = 0;
+        std::uint64_t peak_rss_kb = 0;
+        std::vector< stage_result > stages;
+
+        llvm::json::Value to_json() const {
+            llvm::json::Array out;
+            for (const auto &stage : stages) {
+                out.push_back(llvm::json::Object{
+                    { "name", stage.name },
+                    { "wall_ms", stage.wall_ms },
+                    { "ops", stage.ops },
+                    { "ops_per_sec", stage.ops_per_sec() }
+                });
+            }
+
+            return llvm::json::Object{
+                { "name", name },
+                { "wall_ms", wall_ms },
+                { "cpu_ms", cpu_ms },
+                { "peak_rss_kb", static_cast< std::int64_t >(peak_rss_kb) },
+                { "stages", std::move(out) }
+            };
+        }
+    };
+
+    // Stage name to wall time of a baseline workload.
+    using baseline_t = std::map< std::string, std::map< std::string, double > >;
+
+    std::string join(string_ref dir, string_ref file) {
+        llvm::SmallString< 256 > out(dir);
+        llvm::sys::path::append(out, file);
+        return out.str().str();
+    }
+
+    bool write_file(const std::string &path, string_ref content) {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_Text);
+        if (ec) {
+            llvm::errs() << "error: cannot write '" << path << "': " << ec.message() << "\n";
+            return false;
+        }
+        os << content;
+        return true;
+    }
+
+    std::optional< llvm::json::Value > read_json(const std::string &path) {
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        if (!buffer) {
+            llvm::errs() << "error: cannot read '" << path << "'\n";
+            return std::nullopt;
+        }
+
+        auto json = llvm::json::parse(buffer.get()->getBuffer());
+        if (!json) {
+            llvm::errs() << "error: malformed JSON in '" << path << "': "
+                         << llvm::toString(json.takeError()) << "\n";
+            return std::nullopt;
+        }
+
+        return std::move(json.get());
+    }
+
+    // Wall time of a record, negative and non-finite durations are rejected.
+    std::optional< double > read_wall_ms(const llvm::json::Object &rec, string_ref what) {
+        auto wall = rec.getNumber("wall_ms");
+        if (!wall) {
+            return std::nullopt;
+        }
+
+        if (*wall < 0 || !std::isfinite(*wall)) {
+            llvm::errs() << llvm::formatv("warning: ignoring invalid duration of '{0}': {1} ms\n", what, *wall);
+            return std::nullopt;
+        }
+
+        return wall;
+    }
+
+    std::string vast_front_path(const char *argv0) {
+        if (!cl::options->vast_front.empty()) {
+            return cl::options->vast_front;
+        }
+
+        auto self = llvm::sys::fs::getMainExecutable(argv0, (void *) (intptr_t) vast_front_path);
+        return join(llvm::sys::path::parent_path(self), "vast-front");
+    }
+
+    //
+    // Codegen is recorded as a phase of the pipeline profile, pipeline steps
+    // are recorded with the ops they were given.
+    //
+    std::vector< stage_result > read_stages(const llvm::json::Value &profile) {
+        std::vector< stage_result > out;
+
+        auto obj = profile.getAsObject();
+        if (!obj) {
+            return out;
+        }
+
+        auto read = [&] (const llvm::json::Array *records, string_ref ops_key, auto &&filter) {
+            if (!records) {
+                return;
+            }
+
+            for (const auto &value : *records) {
+                auto rec = value.getAsObject();
+                if (!rec) {
+                    continue;
+                }
+
+                auto name = rec->getString("name");
+                if (!name || !filter(*name)) {
+                    continue;
+                }
+
+                auto wall = read_wall_ms(*rec, *name);
+                if (!wall) {
+                    continue;
+                }
+
+                out.push_back({ name->str(), *wall, rec->getInteger(ops_key).value_or(0) });
+            }
+        };
+
+        read(obj->getArray("phases"), "ops_after", [] (string_ref name) {
+            return name == "codegen" || name == "codegen-finalize";
+        });
+
+        read(obj->getArray("steps"), "ops_before", [] (string_ref) { return true; });
+
+        return out;
+    }
+
+    std::optional< workload_result > run_once(
+        const workload &work, const std::string &vast_front, const std::string &dir
+    ) {
+        auto source  = join(dir, work.main.name);
+        auto output  = join(dir, work.name + ".mlir");
+        auto profile = join(dir, work.name + ".profile.json");
+
+        std::string emit    = "-vast-emit-mlir=" + cl::options->target;
+        std::string profile_arg = "-vast-profile-pipeline=" + profile;
+
+        llvm::SmallVector< string_ref > args = {
+            vast_front, emit, profile_arg, "-I", dir, source, "-o", output
+        };
+
+        std::string error;
+        bool failed_to_execute = false;
+        std::optional< llvm::sys::ProcessStatistics > stats;
+
+        // Process statistics only provide CPU time, wall time is measured
+        // around the whole execution.
+        auto start  = std::chrono::steady_clock::now();
+        auto status = llvm::sys::ExecuteAndWait(
+            vast_front, args, std::nullopt, {}, 0, 0, &error, &failed_to_execute, &stats
+        );
+        auto wall = std::chrono::steady_clock::now() - start;
+
+        if (failed_to_execute || status != 0) {
+            llvm::errs() << "error: vast-front failed on workload '" << work.name << "'";
+            if (!error.empty()) {
+                llvm::errs() << ": " << error;
+            }
+            llvm::errs() << "\n";
+            return std::nullopt;
+        }
+
+        auto json = read_json(profile);
+        if (!json) {
+            return std::nullopt;
+        }
+
+        workload_result result;
+        result.name   = work.name;
+        result.stages = read_stages(*json);
+        result.wall_ms = std::chrono::duration< double, std::milli >(wall).count();
+
+        if (stats) {
+            result.cpu_ms      = static_cast< double >(stats->TotalTime.count()) / 1000.0;
+            result.peak_rss_kb = stats->PeakMemory;
+        }
+
+        return result;
+    }
+
+    std::optional< workload_result > run(
+        const workload &work, const std::string &vast_front, const std::string &dir
+    ) {
+        if (!write_file(join(dir, work.main.name), work.main.content)) {
+            return std::nullopt;
+        }
+
+        for (const auto &header : work.headers) {
+            if (!write_file(join(dir, header.name), header.content)) {
+                return std::nullopt;
+            }
+        }
+
+        std::optional< workload_result > best;
+        for (unsigned i = 0; i < std::max(1u, cl::options->repeat.getValue()); ++i) {
+            auto result = run_once(work, vast_front, dir);
+            if (!result) {
+                return std::nullopt;
+            }
+
+            if (!best || result->wall_ms < best->wall_ms) {
+                best = std::move(result);
+            }
+        }
+
+        return best;
+    }
+
+    void report(const workload_result &result) {
+        llvm::outs() << llvm::formatv(
+            "{0}: {1:F1} ms, cpu {2:F1} ms, peak {3} KB\n",
+            result.name, result.wall_ms, result.cpu_ms, result.peak_rss_kb
+        );
+
+        for (const auto &stage : result.stages) {
+            llvm::outs() << llvm::formatv(
+                "  {0,-40} {1,10:F2} ms {2,12} ops {3,14:F0} ops/s\n",
+                stage.name, stage.wall_ms, stage.ops, stage.ops_per_sec()
+            );
+        }
+    }
+
+    baseline_t read_baseline(const llvm::json::Value &json) {
+        baseline_t out;
+
+        auto results = json.getAsObject() ? json.getAsObject()->getArray("workloads") : nullptr;
+        if (!results) {
+            return out;
+        }
+
+        for (const auto &value : *results) {
+            auto work = value.getAsObject();
+            if (!work) {
+                continue;
+            }
+
+            auto name = work->getString("name");
+            if (!name) {
+                continue;
+            }
+
+            auto &stages = out[name->str()];
+            if (auto wall = read_wall_ms(*work, *name)) {
+                stages["total"] = *wall;
+            }
+
+            if (auto arr = work->getArray("stages")) {
+                for (const auto &stage : *arr) {
+                    if (auto obj = stage.getAsObject()) {
+                        if (auto stage_name = obj->getString("name")) {
+                            auto what = (*name + " / " + *stage_name).str();
+                            if (auto wall = read_wall_ms(*obj, what)) {
+                                stages[stage_name->str()] = *wall;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return out;
+    }
+
+    // Returns the number of regressions against the baseline.
+    std::size_t compare(const std::vector< workload_result > &results, const baseline_t &baseline) {
+        std::size_t regressions = 0;
+        auto limit = 1.0 + cl::options->tolerance / 100.0;
+
+        auto check = [&] (string_ref work, string_ref stage, double current, double base) {
+            if (base < min_compared_ms && current < min_compared_ms) {
+                return;
+            }
+
+            auto ratio = base > 0 ? current / base : 0.0;
+            if (ratio > limit) {
+                ++regressions;
+                llvm::outs() << llvm::formatv(
+                    "regression: {0} / {1}: {2:F2} ms -> {3:F2} ms ({4:F1}%)\n",
+                    work, stage, base, current, (ratio - 1.0) * 100.0
+                );
+            }
+        };
+
+        for (const auto &result : results) {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end()) {
+                continue;
+            }
+
+            const auto &stages = it->second;
+            if (auto total = stages.find("total"); total != stages.end()) {
+                check(result.name, "total", result.wall_ms, total->second);
+            }
+
+            for (const auto &stage : result.stages) {
+                if (auto base = stages.find(stage.name); base != stages.end()) {
+                    check(result.name, stage.name, stage.wall_ms, base->second);
+                }
+            }
+        }
+
+        return regressions;
+    }
+
+    std::vector< const generator_info * > selected_generators() {
+        std::vector< const generator_info * > out;
+        for (const auto &gen : generators()) {
+            if (cl::options->workloads.empty() || llvm::is_contained(cl::options->workloads, gen.name)) {
+                out.push_back(&gen);
+            }
+        }
+        return out;
+    }
+
+    int run_benchmarks(const char *argv0) {
+        if (cl::options->list) {
+            for (const auto &gen : generators()) {
+                llvm::outs() << llvm::formatv("{0,-16} {1}\n", gen.name, gen.description);
+            }
+            return 0;
+        }
+
+        std::string dir = cl::options->work_dir;
+        if (dir.empty()) {
+            llvm::SmallString< 256 > tmp;
+            if (auto ec = llvm::sys::fs::createUniqueDirectory("vast-bench", tmp)) {
+                llvm::errs() << "error: cannot create work directory: " << ec.message() << "\n";
+                return 1;
+            }
+            dir = tmp.str().str();
+        } else if (auto ec = llvm::sys::fs::create_directories(dir)) {
+            llvm::errs() << "error: cannot create '" << dir << "': " << ec.message() << "\n";
+            return 1;
+        }
+
+        auto vast_front = vast_front_path(argv0);
+
+        std::vector< workload_result > results;
+        for (auto gen : selected_generators()) {
+            auto result = run(gen->generate(cl::options->scale), vast_front, dir);
+            if (!result) {
+                return 1;
+            }
+
+            report(*result);
+            results.push_back(std::move(*result));
+        }
+
+        if (!cl::options->output.empty()) {
+            llvm::json::Array workloads;
+            for (const auto &result : results) {
+                workloads.push_back(result.to_json());
+            }
+
+            llvm::json::Object out{
+                { "scale", static_cast< std::int64_t >(cl::options->scale) },
+                { "target", cl::options->target },
+                { "workloads", std::move(workloads) }
+            };
+
+            std::string buffer;
+            llvm::raw_string_ostream os(buffer);
+            os << llvm::formatv("{0:2}", llvm::json::Value(std::move(out))) << '\n';
+            if (!write_file(cl::options->output, os.str())) {
+                return 1;
+            }
+        }
+
+        if (!cl::options->baseline.empty()) {
+            if (!llvm::sys::fs::exists(cl::options->baseline)) {
+                llvm::outs() << "no baseline at '" << cl::options->baseline
+                             << "', skipping comparison\n";
+                return 0;
+            }
+
+            auto json = read_json(cl::options->baseline);
+            if (!json) {
+                return 1;
+            }
+
+            if (auto regressions = compare(results, read_baseline(*json))) {
+                llvm::outs() << regressions << " regression(s) against the baseline\n";
+                return 1;
+            }
+
+            llvm::outs() << "no regressions against the baseline\n";
+        }
+
+        return 0;
+    }
+
+} // namespace vast::bench
+
+int main(int argc, char **argv) {
+    llvm::InitLLVM init(argc, argv);
+
+    llvm::cl::HideUnrelatedOptions({ &vast::cl::generic });
+    vast::cl::register_options();
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST benchmark driver\n");
+
+    return vast::bench::run_benchmarks(argv[0]);
+}
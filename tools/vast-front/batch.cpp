@@ -0,0 +1,355 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Batch mode of vast-front compiles all translation units of a compilation
+// database within a single process. Units are distributed over a pool of
+// workers. Each worker owns an MLIR context with loaded dialects and a cache of
+// pass pipelines, both reused for every unit the worker compiles.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/Stack.h>
+#include <clang/Driver/Driver.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <llvm/Support/BuryPointer.h>
+#include <llvm/Support/CrashRecoveryContext.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/thread.h>
+#include <llvm/Support/xxhash.h>
+VAST_UNRELAX_WARNINGS
+
+#include <atomic>
+#include <mutex>
+#include <numeric>
+
+#include "vast/Frontend/Action.hpp"
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/Diagnostics.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/Pipelines.hpp"
+
+#include "vast/Config/config.h"
+
+namespace vast::cc {
+
+    frontend_action_ptr create_frontend_action(
+        compiler_instance &ci, const vast_args &vargs,
+        mcontext_t &mctx, pipeline_cache *pipelines
+    );
+
+    namespace {
+
+        using compile_command  = clang::tooling::CompileCommand;
+        using compile_commands = std::vector< compile_command >;
+
+        std::string get_resource_dir() {
+            if (!default_resource_dir.empty()) {
+                return std::string(default_resource_dir);
+            }
+
+            return clang::driver::Driver::GetResourcesPath(CLANG_BINARY_PATH, "");
+        }
+
+        std::string absolute_source_path(const compile_command &cmd) {
+            llvm::SmallString< 256 > path(cmd.Filename);
+            llvm::sys::fs::make_absolute(cmd.Directory, path);
+            return path.str().str();
+        }
+
+        string_ref get_output_suffix(const vast_args &vargs, const frontend_options &opts) {
+            if (opt::emit_only_mlir(vargs)) {
+                return "mlir";
+            }
+
+            if (vargs.has_option(opt::emit_llvm)) {
+                return "ll";
+            }
+
+            if (vargs.has_option(opt::emit_asm)) {
+                return "s";
+            }
+
+            switch (opts.ProgramAction) {
+                case clang::frontend::EmitAssembly: return "s";
+                case clang::frontend::EmitLLVM: return "ll";
+                default: return "o";
+            }
+        }
+
+        std::string get_output_path(
+            const compile_command &cmd, const vast_args &vargs, const frontend_options &opts
+        ) {
+            auto source = absolute_source_path(cmd);
+            auto stem   = llvm::sys::path::stem(source);
+            auto suffix = get_output_suffix(vargs, opts);
+
+            llvm::SmallString< 256 > path;
+            if (auto dir = vargs.get_option(opt::batch_output_dir)) {
+                // Sources of the same name from different directories would
+                // clash in a flat output directory, hence we disambiguate them
+                // by a hash of the full source path.
+                path = dir.value();
+                llvm::sys::path::append(path, llvm::formatv(
+                    "{0}.{1:x-}.{2}", stem, llvm::xxh3_64bits(source), suffix
+                ).str());
+            } else {
+                path = cmd.Directory;
+                llvm::sys::path::append(path, llvm::formatv("{0}.{1}", stem, suffix).str());
+            }
+
+            llvm::sys::fs::make_absolute(path);
+            return path.str().str();
+        }
+
+        unsigned get_number_of_jobs(const vast_args &vargs) {
+            if (auto jobs = vargs.get_option(opt::batch_jobs)) {
+                unsigned value = 0;
+                if (!jobs->getAsInteger(10, value) && value > 0) {
+                    return value;
+                }
+
+                llvm::errs() << "warning: invalid number of batch jobs '" << jobs.value()
+                             << "', using the default\n";
+            }
+
+            return llvm::hardware_concurrency().compute_thread_count();
+        }
+
+        //
+        // Starts with the largest translation units, so a single big unit
+        // scheduled last does not keep the rest of the pool idle.
+        //
+        std::vector< std::size_t > schedule_order(const compile_commands &commands) {
+            std::vector< std::uint64_t > sizes(commands.size(), 0);
+            for (std::size_t i = 0; i < commands.size(); ++i) {
+                llvm::sys::fs::file_size(absolute_source_path(commands[i]), sizes[i]);
+            }
+
+            std::vector< std::size_t > order(commands.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::ranges::stable_sort(order, std::greater{}, [&] (auto idx) { return sizes[idx]; });
+            return order;
+        }
+
+        //
+        // Worker compiles translation units one by one on its own thread. MLIR
+        // context and pipelines survive between units, diagnostics and outputs
+        // are private to each unit.
+        //
+        struct batch_worker
+        {
+            batch_worker(const vast_args &vargs, const std::string &resource_dir)
+                : vargs(vargs), resource_dir(resource_dir)
+            {
+                reset();
+            }
+
+            bool compile(const compile_command &cmd, llvm::raw_ostream &os);
+
+          private:
+            void reset() {
+                pipelines = pipeline_cache{};
+                mctx = mk_mcontext();
+                // Parallelism comes from compiling several units at once,
+                // passes of a single unit run on the worker thread.
+                mctx->disableMultithreading();
+            }
+
+            std::vector< const char * > make_driver_args(const compile_command &cmd) const;
+
+            const vast_args &vargs;
+            const std::string &resource_dir;
+
+            std::unique_ptr< mcontext_t > mctx;
+            pipeline_cache pipelines;
+        };
+
+        std::vector< const char * > batch_worker::make_driver_args(const compile_command &cmd) const {
+            std::vector< const char * > args;
+            bool has_resource_dir = false;
+
+            for (const auto &arg : cmd.CommandLine) {
+                // vast options are taken from the batch command line
+                if (string_ref(arg).starts_with(vast_option_prefix)) {
+                    continue;
+                }
+
+                has_resource_dir |= string_ref(arg).starts_with("-resource-dir");
+                args.push_back(arg.c_str());
+            }
+
+            if (!has_resource_dir) {
+                args.push_back("-resource-dir");
+                args.push_back(resource_dir.c_str());
+            }
+
+            return args;
+        }
+
+        bool batch_worker::compile(const compile_command &cmd, llvm::raw_ostream &os) {
+            auto args = make_driver_args(cmd);
+
+            diagnostics_options diag_opts(args);
+            clang::TextDiagnosticPrinter printer(os, diag_opts.get());
+            auto diags = compiler_instance::createDiagnostics(
+                diag_opts.get(), &printer, /* ShouldOwnClient */ false
+            );
+
+            // Each unit resolves relative paths against its own directory,
+            // without touching the working directory of the process.
+            llvm_cnt_ptr< llvm::vfs::FileSystem > vfs(
+                llvm::vfs::createPhysicalFileSystem().release()
+            );
+
+            if (auto ec = vfs->setCurrentWorkingDirectory(cmd.Directory)) {
+                os << "error: cannot enter directory '" << cmd.Directory << "': "
+                   << ec.message() << '\n';
+                return false;
+            }
+
+            clang::CreateInvocationOptions invocation_opts;
+            invocation_opts.Diags = diags;
+            invocation_opts.VFS   = vfs;
+            invocation_opts.ProbePrecompiled = false;
+
+            auto invocation = clang::createInvocation(args, std::move(invocation_opts));
+            if (!invocation) {
+                os << "error: unable to create compiler invocation for '" << cmd.Filename << "'\n";
+                return false;
+            }
+
+            auto &frontend_opts = invocation->getFrontendOpts();
+            frontend_opts.OutputFile = get_output_path(cmd, vargs, frontend_opts);
+
+            auto ci = std::make_unique< compiler_instance >();
+            ci->setInvocation(std::move(invocation));
+            ci->createDiagnostics(&printer, /* ShouldOwnClient */ false);
+            ci->createFileManager(vfs);
+
+            auto action = create_frontend_action(*ci, vargs, *mctx, &pipelines);
+            if (!action) {
+                return false;
+            }
+
+            bool success = false;
+            llvm::CrashRecoveryContext crc;
+            auto finished = crc.RunSafely([&] {
+                try {
+                    success = ci->ExecuteAction(*action);
+                } catch (std::exception &e) {
+                    os << "error: " << e.what() << '\n';
+                    // `~clang::CompilerInstance` would fire an assert otherwise,
+                    // see `cc1` for the same cleanup.
+                    ci->setSema(nullptr);
+                    ci->setASTConsumer(nullptr);
+                    ci->clearOutputFiles(true);
+                }
+            });
+
+            if (!finished) {
+                os << "error: vast-front crashed while compiling '" << cmd.Filename << "'\n";
+                // Neither the instance nor the context can be trusted after
+                // a crash, leak them and start from scratch.
+                llvm::BuryPointer(std::move(action));
+                llvm::BuryPointer(std::move(ci));
+                llvm::BuryPointer(std::move(mctx));
+                reset();
+                return false;
+            }
+
+            printer.finish();
+            return success;
+        }
+
+    } // namespace
+
+    int batch(const vast_args &vargs) {
+        auto path = vargs.get_option(opt::compile_commands);
+        if (!path) {
+            llvm::errs() << "error: expected path to a compilation database\n";
+            return 1;
+        }
+
+        std::string error;
+        auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+            path.value(), error, clang::tooling::JSONCommandLineSyntax::AutoDetect
+        );
+
+        if (!db) {
+            llvm::errs() << "error: " << error << '\n';
+            return 1;
+        }
+
+        auto commands = db->getAllCompileCommands();
+        auto order    = schedule_order(commands);
+
+        llvm::InitializeAllTargets();
+        llvm::InitializeAllTargetMCs();
+        llvm::InitializeAllAsmPrinters();
+        llvm::InitializeAllAsmParsers();
+
+        // Isolates crashes of a single translation unit from the rest of the batch.
+        llvm::CrashRecoveryContext::Enable();
+
+        auto resource_dir = get_resource_dir();
+
+        std::atomic< std::size_t > next   = 0;
+        std::atomic< std::size_t > failed = 0;
+        std::mutex output_mutex;
+
+        auto work = [&] {
+            batch_worker worker(vargs, resource_dir);
+
+            for (auto i = next++; i < order.size(); i = next++) {
+                const auto &cmd = commands[order[i]];
+
+                std::string diagnostics;
+                llvm::raw_string_ostream os(diagnostics);
+                bool success = worker.compile(cmd, os);
+
+                if (!success) {
+                    ++failed;
+                }
+
+                if (!diagnostics.empty()) {
+                    std::lock_guard< std::mutex > lock(output_mutex);
+                    llvm::errs() << diagnostics;
+                }
+            }
+        };
+
+        auto jobs = std::max< std::size_t >(
+            1, std::min< std::size_t >(get_number_of_jobs(vargs), commands.size())
+        );
+
+        std::vector< llvm::thread > workers;
+        workers.reserve(jobs);
+        for (std::size_t i = 0; i < jobs; ++i) {
+            // Clang needs large stacks for deeply nested sources.
+            workers.emplace_back(static_cast< unsigned >(clang::DesiredStackSize), work);
+        }
+
+        for (auto &worker : workers) {
+            worker.join();
+        }
+
+        if (failed) {
+            llvm::errs() << "error: " << failed.load() << " of " << commands.size()
+                         << " translation units failed to compile\n";
+            return 1;
+        }
+
+        return 0;
+    }
+
+} // namespace vast::cc
@@ -17,21 +17,23 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cc
 {
-    frontend_action_ptr create_frontend_action(const vast_args &vargs, mcontext_t &mctx) {
+    frontend_action_ptr create_frontend_action(
+        const vast_args &vargs, mcontext_t &mctx, pipeline_cache *pipelines
+    ) {
         if (opt::emit_only_mlir(vargs)) {
-            return std::make_unique< vast::cc::emit_mlir_action >(vargs, mctx);
+            return std::make_unique< vast::cc::emit_mlir_action >(vargs, mctx, pipelines);
         }
 
         if (vargs.has_option(opt::emit_llvm)) {
-            return std::make_unique< vast::cc::emit_llvm_action >(vargs, mctx);
+            return std::make_unique< vast::cc::emit_llvm_action >(vargs, mctx, pipelines);
         }
 
         if (vargs.has_option(opt::emit_asm)) {
-            return std::make_unique< vast::cc::emit_assembly_action >(vargs, mctx);
+            return std::make_unique< vast::cc::emit_assembly_action >(vargs, mctx, pipelines);
         }
 
         if (vargs.has_option(opt::emit_obj)) {
-            return std::make_unique< vast::cc::emit_obj_action >(vargs, mctx);
+            return std::make_unique< vast::cc::emit_obj_action >(vargs, mctx, pipelines);
         }
 
         return nullptr;
@@ -39,9 +41,9 @@ namespace vast::cc
 
     frontend_action_ptr create_frontend_action(
         compiler_instance &ci, const vast_args &vargs,
-        mcontext_t &mctx
+        mcontext_t &mctx, pipeline_cache *pipelines
     ) {
-        if (auto action = create_frontend_action(vargs, mctx)) {
+        if (auto action = create_frontend_action(vargs, mctx, pipelines)) {
             return action;
         }
 
@@ -51,9 +53,9 @@ namespace vast::cc
 
         switch (act) {
             case ASTDump:  return std::make_unique< clang::ASTDumpAction >();
-            case EmitAssembly: return std::make_unique< vast::cc::emit_assembly_action >(vargs, mctx);
-            case EmitLLVM: return std::make_unique< vast::cc::emit_llvm_action >(vargs, mctx);
-            case EmitObj: return std::make_unique< vast::cc::emit_obj_action >(vargs, mctx);
+            case EmitAssembly: return std::make_unique< vast::cc::emit_assembly_action >(vargs, mctx, pipelines);
+            case EmitLLVM: return std::make_unique< vast::cc::emit_llvm_action >(vargs, mctx, pipelines);
+            case EmitObj: return std::make_unique< vast::cc::emit_obj_action >(vargs, mctx, pipelines);
             default: VAST_UNIMPLEMENTED_MSG("unsupported frontend action");
         }
 
@@ -94,7 +96,7 @@ namespace vast::cc
         // TODO: This is probably an internal leakage for this use case.
         auto mctx = mk_mcontext();
         // Create and execute the frontend action.
-        auto action = create_frontend_action(*ci, vargs, *mctx);
+        auto action = create_frontend_action(*ci, vargs, *mctx, nullptr);
         if (!action)
             return false;
 
@@ -22,6 +22,9 @@ VAST_UNRELAX_WARNINGS
 // main frontend method. Lives inside cc1_main.cpp
 namespace vast::cc {
     extern int cc1(const vast_args & vargs, argv_t argv, arg_t tool, void *main_addr);
+
+    // batch compilation of a compilation database. Lives inside batch.cpp
+    extern int batch(const vast_args &vargs);
 } // namespace vast::cc
 
 VAST_RELAX_WARNINGS
@@ -138,6 +141,13 @@ int main(int argc, char **argv) try {
 
     // FIXME: deal with CL mode
 
+    // Check if vast-front is in the batch mode
+    if (auto [vargs, ccargs] = vast::cc::filter_args(cmd_args);
+        vargs.has_option(vast::cc::opt::compile_commands)
+    ) {
+        return vast::cc::batch(vargs);
+    }
+
     // Check if vast-front is in the frontend mode
     auto first_arg = llvm::find_if(llvm::drop_begin(cmd_args), [] (auto a) { return a != nullptr; });
     if (first_arg != cmd_args.end()) {
@@ -13,6 +13,7 @@ VAST_RELAX_WARNINGS
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "mlir/Parser/Parser.h"
 
+#include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -26,6 +27,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Dialect/HighLevel/TypeUseIndex.hpp"
 
 #include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
 #include "vast/Dialect/Core/Interfaces/SymbolTableInterface.hpp"
@@ -156,11 +158,34 @@ namespace vast::query
     logical_result do_show_users(auto scope) {
         auto &name = cl::options->show_symbol_users;
 
-        auto show_users = [scope] (operation decl) {
-            for (auto use : core::symbol_table::get_symbol_uses(decl, scope)) {
-                auto user = use.getUser();
-                user->print(llvm::outs());
-                llvm::outs() << show_location(*user) << "\n";
+        // Index all references once, the scope may declare many symbols
+        // with the queried name.
+        core::symbol_use_index index(scope);
+
+        // Type declarations are referred to by types rather than by symbol
+        // references.
+        hl::type_use_index types(scope);
+
+        auto show_user = [&] (operation user) {
+            user->print(llvm::outs());
+            llvm::outs() << show_location(*user) << "\n";
+        };
+
+        auto type_users = [&] (operation decl) -> llvm::ArrayRef< operation > {
+            return llvm::TypeSwitch< operation, llvm::ArrayRef< operation > >(decl)
+                .Case< hl::TypeDefOp, hl::TypeDeclOp, core::aggregate_interface >(
+                    [&] (auto op) { return types.users(op); }
+                )
+                .Default([] (operation) { return llvm::ArrayRef< operation >(); });
+        };
+
+        auto show_users = [&] (operation decl) {
+            for (auto use : index.get_symbol_uses(decl, scope)) {
+                show_user(use.getUser());
+            }
+
+            for (auto user : type_users(decl)) {
+                show_user(user);
             }
         };
 
@@ -40,7 +40,9 @@ namespace vast::repl::codegen {
         llvm::sys::RunInterruptHandlers();
     }
 
-    owning_mlir_module_ref emit_module(const std::filesystem::path &source, mcontext_t &mctx ) {
+    owning_mlir_module_ref emit_module(
+        const std::filesystem::path &source, mcontext_t &mctx, const cc::vast_args &vargs
+    ) {
         // TODO setup args from repl state
         std::vector< const char * > ccargs = { source.c_str() };
         vast::cc::buffered_diagnostics diags(ccargs);
@@ -68,9 +70,6 @@ namespace vast::repl::codegen {
             return {};
         }
 
-        // TODO setup args from repl state
-        cc::vast_args vargs = {};
-
         comp->LoadRequestedPlugins();
 
         // If there were errors in processing arguments, don't do anything else.
@@ -2,7 +2,10 @@
 
 #include "vast/repl/command.hpp"
 
+#include "vast/Analysis/Dataflow/Reachability.hpp"
+#include "vast/Analysis/Dataflow/UninitializedVariables.hpp"
 #include "vast/Conversion/Passes.hpp"
+#include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
 #include "vast/Tower/Tower.hpp"
 #include "vast/repl/common.hpp"
 #include <optional>
@@ -11,22 +14,40 @@ namespace vast::repl {
     namespace cmd {
 
         // TODO: Really naive way to visualize.
-        void render_link(const tw::link_ptr &ptr) {
+        void render_link(const tw::link_ptr &ptr, const tw::location_info_t &li) {
+            // Operations carry only tower ids, their locations are kept by the
+            // location info.
             auto flag = mlir::OpPrintingFlags().skipRegions();
 
-            auto render_op = [&](operation op) -> llvm::raw_fd_ostream & {
+            auto render_op = [&](tw::handle_t level, operation op) -> llvm::raw_fd_ostream & {
                 op->print(llvm::outs(), flag);
+                llvm::outs() << " " << li.source(level.id, op);
                 return llvm::outs();
             };
 
-            auto render = [&](operation op) {
-                render_op(op) << "\n";
-                for (auto c : ptr->children(op)) {
-                    llvm::outs() << "\t => ";
-                    render_op(c) << "\n";
+            auto render = [&](
+                tw::handle_t level, operation op, std::string_view arrow,
+                tw::handle_t related_level, auto related
+            ) {
+                render_op(level, op) << "\n";
+                for (auto r : related) {
+                    llvm::outs() << "\t " << arrow << " ";
+                    render_op(related_level, r) << "\n";
                 }
             };
-            ptr->parent().mod->walk< mlir::WalkOrder::PreOrder >(render);
+
+            auto parent = ptr->parent();
+            auto child  = ptr->child();
+
+            parent.mod->walk< mlir::WalkOrder::PreOrder >([&](operation op) {
+                render(parent, op, "=>", child, ptr->children(op));
+            });
+
+            llvm::outs() << "\n";
+
+            child.mod->walk< mlir::WalkOrder::PreOrder >([&](operation op) {
+                render(child, op, "<=", parent, ptr->parents(op));
+            });
         }
 
         void check_source(const state_t &state) {
@@ -52,7 +73,20 @@ namespace vast::repl {
 
         auto check_and_emit_module(state_t &state) {
             check_source(state);
-            return codegen::emit_module(state.source.value(), state.ctx);
+
+            cc::vast_args vargs;
+            if (state.locs_as_meta_ids) {
+                vargs.push_back("-vast-locs-as-meta-ids");
+            }
+
+            return codegen::emit_module(state.source.value(), state.ctx, vargs);
+        }
+
+        void check_and_raise_tower(state_t &state) {
+            if (!state.tower) {
+                auto root = check_and_emit_module(state);
+                state.raise_tower(std::move(root));
+            }
         }
 
         //
@@ -70,6 +104,7 @@ namespace vast::repl {
         //
         void load::run(state_t &state) const {
             state.source = get_param< source_param >(params).path;
+            state.locs_as_meta_ids = get_param< meta_ids_param >(params).set;
         };
 
         //
@@ -93,10 +128,7 @@ namespace vast::repl {
         }
 
         void show_symbols(state_t &state) {
-            if (!state.tower) {
-                auto root = check_and_emit_module(state);
-                state.raise_tower(std::move(root));
-            }
+            check_and_raise_tower(state);
 
             VAST_UNIMPLEMENTED;
             // util::symbols(state.current_module(), [&] (auto symbol) {
@@ -119,7 +151,7 @@ namespace vast::repl {
             if (it == state.links.end()) {
                 return throw_error("Link with name: {0} not found!", name);
             }
-            return render_link(it->second);
+            return render_link(it->second, state.location_info);
         }
 
         void show::run(state_t &state) const {
@@ -145,11 +177,31 @@ namespace vast::repl {
         // analyze command
         //
         void analyze_reachable_code(state_t &state) {
-            llvm::outs() << "run reachable code analysis\n";
+            check_and_raise_tower(state);
+
+            auto unreachable = dataflow::unreachable_code(state.current_module());
+            if (unreachable.empty()) {
+                llvm::outs() << "no unreachable code\n";
+            }
+
+            for (auto op : unreachable) {
+                llvm::outs() << op->getLoc() << ": code will never be executed\n";
+            }
         }
 
         void analyze_uninitialized_variables(state_t &state) {
-            llvm::outs() << "run uninitialized variables analysis\n";
+            check_and_raise_tower(state);
+
+            auto uses = dataflow::uninitialized_uses(state.current_module());
+            if (uses.empty()) {
+                llvm::outs() << "no uninitialized variables\n";
+            }
+
+            for (auto [use, var, on_all_paths] : uses) {
+                llvm::outs() << use->getLoc() << ": variable '" << var.getSymName() << "' "
+                             << (on_all_paths ? "is" : "may be")
+                             << " uninitialized when used here\n";
+            }
         }
 
         void analyze::run(state_t &state) const {
@@ -164,29 +216,28 @@ namespace vast::repl {
         // meta command
         //
         void meta::add(state_t &state) const {
-            using ::vast::meta::add_identifier;
-
-            VAST_UNIMPLEMENTED;
-            // auto name_param = get_param< symbol_param >(params);
-            // util::symbols(state.current_module(), [&] (auto symbol) {
-            //     if (util::symbol_name(symbol) == name_param.value) {
-            //         auto id = get_param< identifier_param >(params);
-            //         add_identifier(symbol, id.value);
-            //         llvm::outs() << symbol << "\n";
-            //     }
-            // });
+            auto id   = get_param< identifier_param >(params);
+            auto name = get_param< symbol_param >(params);
+
+            // Identifiers are added through the index to keep it up to date.
+            auto &ids = state.current_meta_ids();
+            core::symbols< core::symbol >(state.current_module(), [&] (core::symbol symbol) {
+                if (symbol.getSymbolName() == name.value) {
+                    ids.add_identifier(symbol, id.value);
+                    llvm::outs() << *symbol.getOperation() << "\n";
+                }
+            });
         }
 
         void meta::get(state_t &state) const {
-            using ::vast::meta::get_with_identifier;
             auto id = get_param< identifier_param >(params);
-            for (auto op : get_with_identifier(state.current_module(), id.value)) {
+            for (auto op : state.current_meta_ids().with_identifier(id.value)) {
                 llvm::outs() << *op << "\n";
             }
         }
 
         void meta::run(state_t &state) const {
-            check_and_emit_module(state);
+            check_and_raise_tower(state);
 
             auto action = get_param< action_param >(params);
             switch (action) {
@@ -203,10 +254,7 @@ namespace vast::repl {
         // raise command
         //
         void raise::run(state_t &state) const {
-            if (!state.tower) {
-                auto root = check_and_emit_module(state);
-                state.raise_tower(std::move(root));
-            }
+            check_and_raise_tower(state);
 
             std::string pipeline = get_param< pipeline_param >(params).value;
             auto link_name       = get_param< link_name_param >(params).value;
@@ -222,7 +270,34 @@ namespace vast::repl {
                 }
             }
             auto link = state.tower->apply(top, state.location_info, pm);
-            state.links.emplace(link_name, std::move(link));
+            // Levels of a replaced link can be evicted from the tower.
+            state.links.insert_or_assign(link_name, std::move(link));
+        }
+
+        //
+        // tower command
+        //
+        void tower_stats(state_t &state) {
+            check_and_raise_tower(state);
+
+            const auto &stored = state.tower->stored();
+            llvm::outs() << "levels: " << stored.levels() << "\n"
+                         << "materialized: " << stored.materialized_levels() << "\n"
+                         << "memory: " << stored.memory_usage() << " bytes\n";
+        }
+
+        void tower_limit(state_t &state, std::uint64_t bytes) {
+            check_and_raise_tower(state);
+            state.tower->set_memory_limit(bytes);
+        }
+
+        void tower::run(state_t &state) const {
+            switch (get_param< action_param >(params)) {
+                case tower_action::stats:
+                    return tower_stats(state);
+                case tower_action::limit:
+                    return tower_limit(state, get_param< bytes_param >(params).value);
+            }
         }
 
         //
@@ -8,10 +8,21 @@ VAST_UNRELAX_WARNINGS
 namespace vast::repl {
 
     void state_t::raise_tower(owning_mlir_module_ref mod) {
+        meta_ids.reset();
         tower.emplace(ctx, location_info, std::move(mod));
     }
 
     mlir_module state_t::current_module() {
         return tower->top().mod;
     }
+
+    meta::identifier_index &state_t::current_meta_ids() {
+        // Modules of the tower stay alive, the index is rebuilt only when
+        // a new module is on its top.
+        operation mod = current_module();
+        if (!meta_ids || meta_ids->root() != mod) {
+            meta_ids.emplace(mod);
+        }
+        return *meta_ids;
+    }
 } // namespace vast::repl::codegen